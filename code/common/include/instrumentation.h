@@ -0,0 +1,244 @@
+// instrumentation.h - Allocation, copy and move accounting shared by the examples
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ------------------------------------------------------------------------------
+// Answers "what did this region cost?" for the copy/move examples:
+//
+//     instrumentation::CostTable table;
+//     {
+//         instrumentation::AllocationScope scope("copy construct", table);
+//         DynamicBuffer copy = original;
+//     }
+//     table.print();
+//
+// Two sources feed a scope:
+//   - heap allocations, counted by replacement global operator new/delete
+//     in code/common/src/instrumentation_hooks.cpp. CMakeLists.txt links
+//     that file into the programs listed in INSTRUMENTATION_HOOK_TARGETS;
+//     elsewhere the allocation columns stay zero.
+//   - copies and moves of types that report them, either by hand from their
+//     special members (typeCounters("DynamicBuffer").copied(bytes)) or, for
+//     Rule of Zero types, through a Counted<T> member.
+//
+// The counters are process-wide, so work other threads do while a scope is
+// open lands in that scope too.
+//
+// Counting only happens while at least one AllocationScope is alive, so
+// instrumented types cost a relaxed load and a branch everywhere else
+// (benchmarks included).
+// ------------------------------------------------------------------------------
+namespace instrumentation {
+    inline std::atomic<int> activeScopes{0};
+
+    inline bool counting() noexcept {
+        return activeScopes.load(std::memory_order_relaxed) > 0;
+    }
+
+    struct HeapCounters {
+        std::atomic<std::uint64_t> allocations{0};
+        std::atomic<std::uint64_t> allocatedBytes{0};
+        std::atomic<std::uint64_t> deallocations{0};
+    };
+
+    inline HeapCounters heap;
+
+    // Copy/move counts of one type. Obtain with typeCounters(name); the
+    // object lives for the rest of the program.
+    struct TypeCounters {
+        const char* name = nullptr;
+        std::atomic<std::uint64_t> copies{0};
+        std::atomic<std::uint64_t> copiedBytes{0}; // bytes duplicated by those copies
+        std::atomic<std::uint64_t> moves{0};
+        std::atomic<std::uint64_t> movedBytes{0};  // bytes handed over without copying
+
+        void copied(std::size_t bytes) noexcept {
+            if (counting()) {
+                copies.fetch_add(1, std::memory_order_relaxed);
+                copiedBytes.fetch_add(bytes, std::memory_order_relaxed);
+            }
+        }
+
+        void moved(std::size_t bytes) noexcept {
+            if (counting()) {
+                moves.fetch_add(1, std::memory_order_relaxed);
+                movedBytes.fetch_add(bytes, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    // A fixed array rather than a container, so registering a type inside a
+    // scope does not show up as an allocation of that scope.
+    inline constexpr std::size_t kMaxTypes = 64;
+    inline std::mutex registryMutex;
+    inline TypeCounters registry[kMaxTypes];
+    inline std::size_t registered = 0;
+
+    // Same name, same counters: every BasicDynamicBuffer<Allocator> can
+    // report as "DynamicBuffer". Call sites keep the reference in a static.
+    // Never throws, because noexcept copies and moves register their type on
+    // first use: past kMaxTypes names, the extra types share the last slot,
+    // which keeps the totals right and only merges their counts.
+    inline TypeCounters& typeCounters(const char* name) noexcept {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (std::size_t i = 0; i < registered; ++i) {
+            if (std::strcmp(registry[i].name, name) == 0) {
+                return registry[i];
+            }
+        }
+        if (registered == kMaxTypes) {
+            return registry[kMaxTypes - 1];
+        }
+        registry[registered].name = name;
+        return registry[registered++];
+    }
+
+    // Drop-in member for Rule of Zero types: the compiler-generated copy and
+    // move of the owner call these, so the owner keeps declaring none of its
+    // own. Owner::kTypeName names the row. Byte counts are unknown here; the
+    // allocation columns show what the members' copies really cost.
+    template <typename Owner>
+    class Counted {
+    private:
+        static TypeCounters& counters() {
+            static TypeCounters& forOwner = typeCounters(Owner::kTypeName);
+            return forOwner;
+        }
+
+    public:
+        Counted() = default;
+        ~Counted() = default;
+
+        Counted(const Counted&) noexcept {
+            counters().copied(0);
+        }
+
+        Counted(Counted&&) noexcept {
+            counters().moved(0);
+        }
+
+        Counted& operator=(const Counted&) noexcept {
+            counters().copied(0);
+            return *this;
+        }
+
+        Counted& operator=(Counted&&) noexcept {
+            counters().moved(0);
+            return *this;
+        }
+    };
+
+    struct Cost {
+        std::uint64_t allocations = 0;
+        std::uint64_t allocatedBytes = 0;
+        std::uint64_t deallocations = 0;
+        std::uint64_t copies = 0;
+        std::uint64_t copiedBytes = 0;
+        std::uint64_t moves = 0;
+        std::uint64_t movedBytes = 0;
+
+        Cost operator-(const Cost& before) const {
+            return Cost{allocations - before.allocations, allocatedBytes - before.allocatedBytes,
+                        deallocations - before.deallocations, copies - before.copies,
+                        copiedBytes - before.copiedBytes, moves - before.moves, movedBytes - before.movedBytes};
+        }
+    };
+
+    // Totals so far, over all threads and all registered types.
+    inline Cost snapshot() {
+        Cost cost;
+        cost.allocations = heap.allocations.load(std::memory_order_relaxed);
+        cost.allocatedBytes = heap.allocatedBytes.load(std::memory_order_relaxed);
+        cost.deallocations = heap.deallocations.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (std::size_t i = 0; i < registered; ++i) {
+            cost.copies += registry[i].copies.load(std::memory_order_relaxed);
+            cost.copiedBytes += registry[i].copiedBytes.load(std::memory_order_relaxed);
+            cost.moves += registry[i].moves.load(std::memory_order_relaxed);
+            cost.movedBytes += registry[i].movedBytes.load(std::memory_order_relaxed);
+        }
+        return cost;
+    }
+
+    // One row per scenario, printed together once the demo output is done.
+    class CostTable {
+    private:
+        std::vector<std::pair<std::string, Cost>> rows;
+
+    public:
+        void add(std::string label, const Cost& cost) {
+            rows.emplace_back(std::move(label), cost);
+        }
+
+        void print(std::ostream& out = std::cout) const {
+            std::size_t width = 8;
+            for (const auto& row : rows) {
+                width = std::max(width, row.first.size());
+            }
+            out << std::left << std::setw(static_cast<int>(width)) << "scenario" << std::right << std::setw(8) << "allocs"
+                << std::setw(10) << "bytes" << std::setw(8) << "frees" << std::setw(8) << "copies" << std::setw(10)
+                << "copied B" << std::setw(8) << "moves" << std::setw(10) << "moved B" << "\n";
+            for (const auto& [label, cost] : rows) {
+                out << std::left << std::setw(static_cast<int>(width)) << label << std::right << std::setw(8)
+                    << cost.allocations << std::setw(10) << cost.allocatedBytes << std::setw(8) << cost.deallocations
+                    << std::setw(8) << cost.copies << std::setw(10) << cost.copiedBytes << std::setw(8) << cost.moves
+                    << std::setw(10) << cost.movedBytes << "\n";
+            }
+        }
+    };
+
+    // Measures from construction to destruction and adds the result to a
+    // table, or prints it on one line when there is no table. Scopes may
+    // nest; each sees everything that happened during its own lifetime.
+    class AllocationScope {
+    private:
+        std::string label;
+        CostTable* table;
+        Cost start;
+
+    public:
+        explicit AllocationScope(std::string name, CostTable* into = nullptr)
+            : label(std::move(name))
+            , table(into) {
+            activeScopes.fetch_add(1, std::memory_order_relaxed);
+            start = snapshot(); // after the label's own allocation
+        }
+
+        AllocationScope(std::string name, CostTable& into)
+            : AllocationScope(std::move(name), &into) {}
+
+        AllocationScope(const AllocationScope&) = delete;
+        AllocationScope& operator=(const AllocationScope&) = delete;
+
+        Cost cost() const {
+            return snapshot() - start;
+        }
+
+        ~AllocationScope() {
+            const Cost spent = cost();
+            activeScopes.fetch_sub(1, std::memory_order_relaxed);
+            if (table != nullptr) {
+                table->add(std::move(label), spent);
+            } else {
+                std::cout << "[" << label << "] " << spent.allocations << " allocations, " << spent.allocatedBytes
+                          << " bytes, " << spent.copies << " copies (" << spent.copiedBytes << " B), " << spent.moves
+                          << " moves (" << spent.movedBytes << " B)\n";
+            }
+        }
+    };
+} // namespace instrumentation
+
+#endif // INSTRUMENTATION_H
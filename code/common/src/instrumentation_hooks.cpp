@@ -0,0 +1,101 @@
+// Replacement global operator new/delete that feed instrumentation::heap.
+//
+// They live in a source file of their own rather than in the header: when
+// inlined into callers, GCC paired their malloc/free with the callers' own
+// new/delete and warned about mismatched allocation functions. Here callers
+// only see the declarations in <new>.
+
+#include "instrumentation.h"
+
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h> // _aligned_malloc
+#endif
+
+namespace {
+    void recordAllocation(std::size_t n) noexcept {
+        if (instrumentation::counting()) {
+            instrumentation::heap.allocations.fetch_add(1, std::memory_order_relaxed);
+            instrumentation::heap.allocatedBytes.fetch_add(n, std::memory_order_relaxed);
+        }
+    }
+
+    void recordDeallocation(void* p) noexcept {
+        if (p != nullptr && instrumentation::counting()) {
+            instrumentation::heap.deallocations.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void* alignedAlloc(std::size_t n, std::size_t alignment) noexcept {
+#if defined(_WIN32)
+        return _aligned_malloc(n, alignment);
+#else
+        // aligned_alloc wants a multiple of the alignment.
+        return std::aligned_alloc(alignment, (n + alignment - 1) / alignment * alignment);
+#endif
+    }
+
+    void alignedFree(void* p) noexcept {
+#if defined(_WIN32)
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif
+    }
+} // namespace
+
+// Replacement global allocation functions. The standard routes the array and
+// nothrow forms through these, so they see every new/delete.
+void* operator new(std::size_t n) {
+    if (n == 0) {
+        n = 1;
+    }
+    for (;;) {
+        if (void* p = std::malloc(n)) {
+            recordAllocation(n);
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* operator new(std::size_t n, std::align_val_t alignment) {
+    if (n == 0) {
+        n = 1;
+    }
+    for (;;) {
+        if (void* p = alignedAlloc(n, static_cast<std::size_t>(alignment))) {
+            recordAllocation(n);
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* p) noexcept {
+    recordDeallocation(p);
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    recordDeallocation(p);
+    alignedFree(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    ::operator delete(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept {
+    ::operator delete(p, alignment);
+}
@@ -0,0 +1,158 @@
+// Reading a whole file: copying it chunk by chunk into a buffer versus
+// mapping it, and streaming it with background read-ahead.
+//
+// Usage: level-1_13-destructor_file_read [file_mib] [chunk_kib] [path]
+//
+// Without a path, a file_mib file is generated in the temp directory (and
+// removed afterwards). Every method checksums the bytes it sees; the run
+// fails if the checksums disagree.
+//   ifstream     std::ifstream::read into one chunk_kib buffer
+//   pread        pread(2) into one chunk_kib page-aligned IoBuffer
+//   mmap         MappedFile with Access::Sequential, no copy at all
+//   ChunkReader  chunk_kib chunks read one step ahead on a second thread
+//
+// The file is read once before timing, so all methods run against a warm
+// page cache: this measures copy and syscall overhead, not the disk.
+
+#include "chunk_reader.h"
+#include "io_buffer.h"
+#include "mapped_file.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // Touches every byte so the mapping is actually faulted in. A plain byte
+    // sum vectorizes, so it stays cheap next to the read itself.
+    std::uint64_t checksum(std::span<const char> bytes, std::uint64_t sum) {
+        for (char c : bytes) {
+            sum += static_cast<unsigned char>(c);
+        }
+        return sum;
+    }
+
+    template <typename Fn>
+    double gbPerSecond(std::size_t bytes, Fn fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return static_cast<double>(bytes) / elapsed.count() / 1e9;
+    }
+
+    std::uint64_t readIfstream(const std::string& path, std::size_t chunk) {
+        std::ifstream file(path, std::ios::binary);
+        IoBuffer buffer(chunk, IoInit::Uninitialized);
+        std::uint64_t sum = 0;
+        while (file.read(buffer.data(), static_cast<std::streamsize>(chunk)) || file.gcount() > 0) {
+            sum = checksum({buffer.data(), static_cast<std::size_t>(file.gcount())}, sum);
+        }
+        return sum;
+    }
+
+#if !defined(_WIN32)
+    std::uint64_t readPread(const std::string& path, std::size_t chunk) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return 0;
+        }
+        IoBuffer buffer(chunk, IoInit::Uninitialized, kPageAlignment);
+        std::uint64_t sum = 0;
+        off_t offset = 0;
+        ssize_t got;
+        while ((got = ::pread(fd, buffer.data(), chunk, offset)) > 0) {
+            sum = checksum({buffer.data(), static_cast<std::size_t>(got)}, sum);
+            offset += got;
+        }
+        ::close(fd);
+        return sum;
+    }
+#endif
+
+    std::uint64_t readMapped(const std::string& path) {
+        MappedFile file(path);
+        file.advise(MappedFile::Access::Sequential);
+        return checksum(file.span(), 0);
+    }
+
+    std::uint64_t readStreamed(const std::string& path, std::size_t chunk) {
+        ChunkReader reader(path, chunk, 1);
+        std::uint64_t sum = 0;
+        for (std::span<const char> piece : reader) {
+            sum = checksum(piece, sum);
+        }
+        return sum;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t mib = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 256;
+    const std::size_t chunk = (argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 256) * 1024;
+
+    if (mib == 0 || chunk == 0) {
+        std::fprintf(stderr, "file_mib and chunk_kib must be positive\n");
+        return 1;
+    }
+
+    std::string path;
+    bool generated = false;
+    if (argc > 3) {
+        path = argv[3];
+    } else {
+        path = (std::filesystem::temp_directory_path() / "file_read_bench.bin").string();
+        std::ofstream out(path, std::ios::binary);
+        IoBuffer block(1 << 20, IoInit::Uninitialized);
+        for (std::size_t i = 0; i < block.size(); ++i) {
+            block.data()[i] = static_cast<char>(i * 7 + i / 4096);
+        }
+        for (std::size_t i = 0; i < mib; ++i) {
+            block.data()[0] = static_cast<char>(i);
+            out.write(block.data(), static_cast<std::streamsize>(block.size()));
+        }
+        generated = true;
+    }
+
+    std::error_code ec;
+    const std::size_t bytes = static_cast<std::size_t>(std::filesystem::file_size(path, ec));
+    if (ec || bytes == 0) {
+        std::fprintf(stderr, "cannot read %s\n", path.c_str());
+        return 1;
+    }
+
+    const std::uint64_t expected = readIfstream(path, chunk); // also warms the page cache
+    int status = 0;
+    auto report = [&](const char* name, auto read) {
+        std::uint64_t sum = 0;
+        const double rate = gbPerSecond(bytes, [&] { sum = read(); });
+        std::printf("%-12s %10.2f\n", name, rate);
+        if (sum != expected) {
+            std::fprintf(stderr, "FAILED: %s checksum differs\n", name);
+            status = 1;
+        }
+    };
+
+    std::printf("%s: %.1f MiB, %zu KiB chunks\n\n", path.c_str(), static_cast<double>(bytes) / (1 << 20), chunk / 1024);
+    std::printf("%-12s %10s\n", "method", "GB/s");
+
+    report("ifstream", [&] { return readIfstream(path, chunk); });
+#if !defined(_WIN32)
+    report("pread", [&] { return readPread(path, chunk); });
+#endif
+    report("mmap", [&] { return readMapped(path); });
+    report("ChunkReader", [&] { return readStreamed(path, chunk); });
+
+    if (generated) {
+        std::filesystem::remove(path);
+    }
+    return status;
+}
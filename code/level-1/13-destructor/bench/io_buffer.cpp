@@ -0,0 +1,101 @@
+// Cost of zero-filling I/O buffers that are overwritten anyway, and of
+// growing a buffer chunk by chunk.
+//
+// Usage: level-1_13-destructor_io_buffer [buffer_mib] [rounds] [chunk_kib]
+//
+// Allocation: each round allocates a buffer_mib buffer and fills it once
+// (standing in for a read into it), then frees it.
+//   make_unique            std::make_unique<char[]>, zero-filled first
+//   for_overwrite          std::make_unique_for_overwrite<char[]>
+//   IoBuffer uninit/page   IoInit::Uninitialized, 4 KiB aligned
+//
+// Growth: appends chunk_kib chunks until the buffer holds buffer_mib.
+//   exact                  reserve(size + chunk) before every append
+//   geometric              resize(), which at least doubles the capacity
+
+#include "io_buffer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+namespace {
+    volatile char sink;
+
+    template <typename Fn>
+    double timeMs(int rounds, Fn fn) {
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r) {
+            fn();
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / rounds;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t mib = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 16;
+    const int rounds = argc > 2 ? std::atoi(argv[2]) : 10;
+    const std::size_t chunk = (argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 64) * 1024;
+
+    if (mib == 0 || rounds <= 0 || chunk == 0) {
+        std::fprintf(stderr, "buffer_mib, rounds and chunk_kib must be positive\n");
+        return 1;
+    }
+    const std::size_t bytes = mib << 20;
+
+    auto fill = [&](char* p) {
+        std::memset(p, 0xAB, bytes);
+        sink = p[bytes - 1];
+    };
+
+    std::printf("%zu MiB buffer, %d rounds, %zu KiB chunks\n\n", mib, rounds, chunk / 1024);
+    std::printf("%-24s %10s\n", "allocate + fill", "ms/round");
+
+    const double zeroed = timeMs(rounds, [&] {
+        auto buffer = std::make_unique<char[]>(bytes);
+        fill(buffer.get());
+    });
+    const double overwrite = timeMs(rounds, [&] {
+        auto buffer = std::make_unique_for_overwrite<char[]>(bytes);
+        fill(buffer.get());
+    });
+    const double uninit = timeMs(rounds, [&] {
+        IoBuffer buffer(bytes, IoInit::Uninitialized, kPageAlignment);
+        fill(buffer.data());
+    });
+    std::printf("%-24s %10.2f\n", "make_unique", zeroed);
+    std::printf("%-24s %10.2f\n", "for_overwrite", overwrite);
+    std::printf("%-24s %10.2f\n", "IoBuffer uninit/page", uninit);
+
+    std::printf("\n%-24s %10s\n", "append chunks", "ms/round");
+
+    int status = 0;
+    auto append = [&](bool geometric) {
+        IoBuffer buffer(0, IoInit::Uninitialized);
+        while (buffer.size() + chunk <= bytes) {
+            const std::size_t at = buffer.size();
+            if (!geometric) {
+                buffer.reserve(at + chunk);
+            }
+            buffer.resize(at + chunk, IoInit::Uninitialized);
+            std::memset(buffer.data() + at, static_cast<int>(at / chunk), chunk);
+        }
+        // Growth must keep the bytes already written.
+        if (buffer.size() >= 2 * chunk && buffer.data()[chunk] != 1) {
+            status = 1;
+        }
+        sink = buffer.data()[buffer.size() - 1];
+    };
+    const double exact = timeMs(rounds, [&] { append(false); });
+    const double geometric = timeMs(rounds, [&] { append(true); });
+    std::printf("%-24s %10.2f\n", "exact", exact);
+    std::printf("%-24s %10.2f\n", "geometric", geometric);
+
+    if (status != 0) {
+        std::fprintf(stderr, "FAILED: growing lost data\n");
+    }
+    return status;
+}
@@ -0,0 +1,74 @@
+// async_reader.h - Reads many whole files at once through io_uring or a thread pool
+#ifndef ASYNC_READER_H
+#define ASYNC_READER_H
+
+#include "io_buffer.h"
+
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <system_error>
+
+struct ReadResult {
+    std::string path;
+    IoBuffer data;         // the whole file
+    std::error_code error; // set if the open or a read failed; data is then empty
+};
+
+enum class ReadBackend {
+    IoUring,    // Linux 5.6+: one io_uring, opens and reads batched into few syscalls
+    ThreadPool, // anywhere: blocking open + pread on queueDepth worker threads
+};
+
+// Queues reads of whole (regular) files and completes them in the background,
+// at most queueDepth at a time. Reading thousands of small files one after
+// the other pays a syscall round trip and, on a cold cache, a full device
+// latency per file; keeping many in flight overlaps them.
+//
+//     AsyncReader reader(128);
+//     for (const std::string& path : paths) {
+//         reader.read(path, [](ReadResult r) { ... });
+//     }
+//     reader.wait();
+//
+// The io_uring backend is used when asked for and the kernel allows it
+// (io_uring_setup can be missing or blocked by a seccomp filter); otherwise
+// the reader quietly falls back to the thread pool. backend() says which one
+// is running.
+//
+// Callbacks run on a background thread, one at a time per thread; they must
+// not throw and must not call wait(). The destructor waits for every queued
+// read: the kernel may still be writing into those buffers, so freeing them
+// earlier is not an option.
+class AsyncReader {
+public:
+    using Callback = std::function<void(ReadResult)>;
+
+    class Engine; // one per backend, see async_reader.cpp
+
+private:
+    std::unique_ptr<Engine> engine;
+
+public:
+    explicit AsyncReader(std::size_t queueDepth = 64, ReadBackend preferred = ReadBackend::IoUring);
+    ~AsyncReader();
+
+    AsyncReader(const AsyncReader&) = delete;
+    AsyncReader& operator=(const AsyncReader&) = delete;
+
+    // Queues a read; `done` gets the result once the whole file is in memory.
+    void read(std::string path, Callback done);
+
+    // Same, with the result delivered through a future.
+    std::future<ReadResult> read(std::string path);
+
+    // Blocks until every read queued so far has called back.
+    void wait();
+
+    ReadBackend backend() const;
+    std::size_t queueDepth() const;
+};
+
+#endif // ASYNC_READER_H
@@ -0,0 +1,104 @@
+// chunk_reader.h - Streams a file in fixed-size chunks with background read-ahead
+#ifndef CHUNK_READER_H
+#define CHUNK_READER_H
+
+#include "io_buffer.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A background thread reads up to `readAhead` chunks ahead of the consumer
+// into a small ring of page-aligned IoBuffers, so the disk (or page cache
+// copy) overlaps with whatever the consumer does with the previous chunk.
+//
+//     ChunkReader reader("big.bin", 1 << 20);
+//     for (std::span<const char> chunk : reader) { ... }
+//
+// Every chunk is chunkSize bytes except possibly the last one. A chunk stays
+// valid until the consumer asks for the next one. Only one thread may consume.
+//
+// The constructor throws std::runtime_error if the file cannot be opened; a
+// read error later on is rethrown from next(). The reader thread points back
+// at this object, so ChunkReader can be neither copied nor moved (returning
+// one from a function still works through guaranteed copy elision).
+class ChunkReader {
+private:
+    std::ifstream file;
+    const std::size_t chunkSize;
+    std::vector<IoBuffer> ring;              // readAhead + 1 slots
+    std::vector<std::size_t> ringFill;       // bytes in each slot
+
+    std::mutex m;
+    std::condition_variable changed;
+    std::uint64_t produced = 0; // chunks read so far
+    std::uint64_t released = 0; // chunks the consumer is done with
+    std::uint64_t current = 0;  // next chunk next() hands out
+    bool finished = false;      // reader hit end of file (or an error)
+    bool stopping = false;
+    std::exception_ptr error;
+
+    std::thread reader;
+
+    void readLoop();
+
+public:
+    class iterator {
+    private:
+        ChunkReader* owner = nullptr;
+        std::span<const char> chunk;
+
+    public:
+        using value_type = std::span<const char>;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(ChunkReader* reader)
+            : owner(reader)
+            , chunk(reader->next()) {}
+
+        std::span<const char> operator*() const {
+            return chunk;
+        }
+
+        iterator& operator++() {
+            chunk = owner->next();
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
+        }
+
+        // Compares equal to end() once the file is exhausted.
+        bool operator==(const iterator& other) const {
+            return chunk.empty() == other.chunk.empty() && (chunk.empty() || owner == other.owner);
+        }
+    };
+
+    ChunkReader(const std::string& path, std::size_t chunkSize, std::size_t readAhead = 2);
+    ~ChunkReader();
+
+    ChunkReader(const ChunkReader&) = delete;
+    ChunkReader& operator=(const ChunkReader&) = delete;
+
+    // The next chunk, or an empty span at end of file.
+    std::span<const char> next();
+
+    iterator begin() {
+        return iterator(this);
+    }
+
+    iterator end() {
+        return iterator();
+    }
+};
+
+#endif // CHUNK_READER_H
@@ -0,0 +1,94 @@
+// io_buffer.h - Aligned, growable byte buffer for file I/O
+#ifndef IO_BUFFER_H
+#define IO_BUFFER_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+// Alignments worth asking for: a cache line (SIMD loads, no false sharing)
+// and a page (O_DIRECT and DMA-style I/O).
+inline constexpr std::size_t kCacheLineAlignment = 64;
+inline constexpr std::size_t kPageAlignment = 4096;
+
+enum class IoInit {
+    Zeroed,        // what std::make_unique<char[]>(n) does
+    Uninitialized, // what std::make_unique_for_overwrite<char[]>(n) does
+};
+
+// The block is owned by a std::unique_ptr whose deleter remembers the
+// alignment it was allocated with, so there is no hand-written destructor.
+// The moves are written out only because size() and capacity() live next
+// to the pointer: a moved-from buffer must be empty, not report the old
+// size with a null data(). Copies stay deleted.
+//
+// Multi-megabyte I/O buffers are usually overwritten by the next read, so
+// zero-filling them first only burns memory bandwidth: construct them with
+// IoInit::Uninitialized. resize() grows the capacity geometrically so
+// appending chunk by chunk copies each byte O(1) times on average. Aligned
+// operator new has no realloc, so growing always moves to a new block.
+class IoBuffer {
+private:
+    struct AlignedDelete {
+        std::size_t alignment;
+
+        void operator()(char* p) const noexcept {
+            ::operator delete[](p, std::align_val_t(alignment));
+        }
+    };
+
+    std::unique_ptr<char[], AlignedDelete> storage;
+    std::size_t length = 0;
+    std::size_t allocated = 0;
+
+    void regrow(std::size_t capacity);
+
+public:
+    // alignment must be a power of two, otherwise std::invalid_argument.
+    explicit IoBuffer(std::size_t size = 0, IoInit init = IoInit::Zeroed, std::size_t alignment = kCacheLineAlignment);
+
+    // Leaves other empty, with its alignment.
+    IoBuffer(IoBuffer&& other) noexcept
+        : storage(std::move(other.storage))
+        , length(std::exchange(other.length, 0))
+        , allocated(std::exchange(other.allocated, 0)) {}
+
+    IoBuffer& operator=(IoBuffer&& other) noexcept {
+        if (this != &other) {
+            storage = std::move(other.storage);
+            length = std::exchange(other.length, 0);
+            allocated = std::exchange(other.allocated, 0);
+        }
+        return *this;
+    }
+
+    // Makes room for at least `capacity` bytes without changing size().
+    void reserve(std::size_t capacity);
+
+    // Changes size(), at least doubling the capacity when it runs out. New
+    // bytes are zeroed unless init says otherwise.
+    void resize(std::size_t n, IoInit init = IoInit::Zeroed);
+
+    char* data() {
+        return storage.get();
+    }
+
+    const char* data() const {
+        return storage.get();
+    }
+
+    std::size_t size() const {
+        return length;
+    }
+
+    std::size_t capacity() const {
+        return allocated;
+    }
+
+    std::size_t alignment() const {
+        return storage.get_deleter().alignment;
+    }
+};
+
+#endif // IO_BUFFER_H
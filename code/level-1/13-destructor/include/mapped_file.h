@@ -0,0 +1,65 @@
+// mapped_file.h - Read-only memory-mapped file with RAII unmapping
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include "io_buffer.h"
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+// Maps a whole file read-only. The destructor unmaps it (and closes nothing
+// else: the descriptor is closed right after mmap, the mapping keeps the file
+// alive). Pages are faulted in on first touch; advise() tells the kernel how
+// they will be touched so it can read ahead or drop them early.
+//
+// Copying a mapping would mean two owners of one munmap, so MappedFile is
+// move-only: Rule of Five with the copy operations deleted.
+//
+// Throws std::system_error if the file cannot be opened or mapped. An empty
+// file gives an empty span. Where mmap is not available (Windows builds of
+// this example) the file is read into an IoBuffer instead, with the same API.
+class MappedFile {
+private:
+    const char* base = nullptr;
+    std::size_t length = 0;
+#if defined(_WIN32)
+    IoBuffer contents;
+#endif
+
+    void unmap() noexcept;
+
+public:
+    enum class Access {
+        Normal,
+        Sequential, // aggressive read-ahead, pages may be dropped after use
+        Random,     // no read-ahead
+        WillNeed,   // start reading the whole range in now
+    };
+
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // madvise() for the whole file; a hint only, failures are ignored.
+    void advise(Access access) const;
+
+    std::span<const char> span() const {
+        return {base, length};
+    }
+
+    const char* data() const {
+        return base;
+    }
+
+    std::size_t size() const {
+        return length;
+    }
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,496 @@
+#include "async_reader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define ASYNC_READER_IO_URING 1
+#include <atomic>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// State every backend shares: the queue of reads not started yet and the
+// count of reads whose callback has not returned, which wait() watches.
+class AsyncReader::Engine {
+protected:
+    struct Request {
+        std::string path;
+        Callback done;
+    };
+
+    const std::size_t depth;
+    std::mutex m;
+    std::condition_variable queued;  // a request arrived, or stopping
+    std::condition_variable drained; // outstanding dropped to zero
+    std::deque<Request> queue;
+    std::size_t outstanding = 0; // queued or in flight
+    bool stopping = false;
+
+    void complete(Request& request, ReadResult result) {
+        request.done(std::move(result));
+        std::lock_guard<std::mutex> lock(m);
+        if (--outstanding == 0) {
+            drained.notify_all();
+        }
+    }
+
+    // Lets the background threads drain the queue and exit.
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stopping = true;
+        }
+        queued.notify_all();
+    }
+
+public:
+    explicit Engine(std::size_t queueDepth)
+        : depth(queueDepth) {}
+
+    virtual ~Engine() = default;
+
+    virtual ReadBackend backend() const = 0;
+
+    void submit(std::string path, Callback done) {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            queue.push_back(Request{std::move(path), std::move(done)});
+            ++outstanding;
+        }
+        queued.notify_one();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(m);
+        drained.wait(lock, [&] { return outstanding == 0; });
+    }
+
+    std::size_t queueDepth() const {
+        return depth;
+    }
+};
+
+namespace {
+    std::error_code lastError() {
+        return std::error_code(errno, std::generic_category());
+    }
+
+#if defined(_WIN32)
+    ReadResult readWholeFile(std::string path) {
+        ReadResult result{std::move(path), IoBuffer(), {}};
+        std::ifstream file(result.path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            result.error = std::make_error_code(std::errc::no_such_file_or_directory);
+            return result;
+        }
+        result.data = IoBuffer(static_cast<std::size_t>(file.tellg()), IoInit::Uninitialized);
+        file.seekg(0);
+        if (!file.read(result.data.data(), static_cast<std::streamsize>(result.data.size()))) {
+            result.data = IoBuffer();
+            result.error = std::make_error_code(std::errc::io_error);
+        }
+        return result;
+    }
+#else
+    ReadResult readWholeFile(std::string path) {
+        ReadResult result{std::move(path), IoBuffer(), {}};
+        const int fd = ::open(result.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            result.error = lastError();
+            return result;
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0) {
+            result.error = lastError();
+            ::close(fd);
+            return result;
+        }
+        result.data = IoBuffer(static_cast<std::size_t>(info.st_size), IoInit::Uninitialized);
+        std::size_t offset = 0;
+        while (offset < result.data.size()) {
+            const ssize_t got = ::pread(fd, result.data.data() + offset, result.data.size() - offset, static_cast<off_t>(offset));
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got < 0) {
+                result.error = lastError();
+                result.data = IoBuffer();
+                break;
+            }
+            if (got == 0) {
+                result.data.resize(offset); // the file shrank since fstat
+                break;
+            }
+            offset += static_cast<std::size_t>(got);
+        }
+        ::close(fd);
+        return result;
+    }
+#endif
+
+    // queueDepth workers, each running one blocking read at a time.
+    class ThreadPoolEngine final : public AsyncReader::Engine {
+    private:
+        std::vector<std::thread> workers;
+
+        void work() {
+            for (;;) {
+                Request request;
+                {
+                    std::unique_lock<std::mutex> lock(m);
+                    queued.wait(lock, [&] { return stopping || !queue.empty(); });
+                    if (queue.empty()) {
+                        return;
+                    }
+                    request = std::move(queue.front());
+                    queue.pop_front();
+                }
+                ReadResult result = readWholeFile(std::move(request.path));
+                complete(request, std::move(result));
+            }
+        }
+
+    public:
+        explicit ThreadPoolEngine(std::size_t queueDepth)
+            : Engine(queueDepth) {
+            try {
+                for (std::size_t i = 0; i < queueDepth; ++i) {
+                    workers.emplace_back(&ThreadPoolEngine::work, this);
+                }
+            } catch (...) {
+                // ~ThreadPoolEngine will not run: join the threads already started.
+                stop();
+                for (std::thread& worker : workers) {
+                    worker.join();
+                }
+                throw;
+            }
+        }
+
+        ~ThreadPoolEngine() override {
+            stop();
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+        }
+
+        ReadBackend backend() const override {
+            return ReadBackend::ThreadPool;
+        }
+    };
+
+#if defined(ASYNC_READER_IO_URING)
+
+    // One io_uring driven by one thread, talking to the kernel through the raw
+    // syscalls (no liburing). Each file goes through IORING_OP_OPENAT, an fstat
+    // for its size, then IORING_OP_READ until the buffer is full. Everything
+    // queued while the thread waits is submitted with the next io_uring_enter,
+    // so a burst of reads costs a handful of syscalls rather than four per file.
+    //
+    // Only the ring thread touches the rings, so the only synchronization with
+    // the kernel is the acquire/release on the ring head and tail indices.
+    class IoUringEngine final : public AsyncReader::Engine {
+    private:
+        struct Op {
+            Request request;
+            int fd = -1; // -1 while the open is in flight
+            IoBuffer data;
+            std::size_t offset = 0;
+        };
+
+        int ringFd = -1;
+        void* sqRing = MAP_FAILED;
+        void* cqRing = MAP_FAILED;
+        std::size_t sqRingBytes = 0;
+        std::size_t cqRingBytes = 0;
+        io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+        std::size_t sqeBytes = 0;
+
+        unsigned* sqTail = nullptr;
+        unsigned* sqMask = nullptr;
+        unsigned* sqArray = nullptr;
+        unsigned* cqHead = nullptr;
+        unsigned* cqTail = nullptr;
+        unsigned* cqMask = nullptr;
+        io_uring_cqe* cqes = nullptr;
+
+        unsigned unsubmitted = 0;  // SQEs queued since the last io_uring_enter
+        std::size_t inFlight = 0;  // files between open and callback
+        std::thread ringThread;
+
+        explicit IoUringEngine(std::size_t queueDepth)
+            : Engine(queueDepth) {}
+
+        // False if this kernel has no usable io_uring.
+        bool setUp() {
+            io_uring_params params {};
+            ringFd = static_cast<int>(::syscall(__NR_io_uring_setup, static_cast<unsigned>(depth), &params));
+            // IORING_OP_OPENAT and IORING_OP_READ arrived with the same release
+            // (5.6) as IORING_FEAT_RW_CUR_POS.
+            if (ringFd < 0 || (params.features & IORING_FEAT_RW_CUR_POS) == 0) {
+                return false;
+            }
+
+            sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (singleMap) {
+                sqRingBytes = cqRingBytes = std::max(sqRingBytes, cqRingBytes);
+            }
+            sqRing = ::mmap(nullptr, sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+            if (sqRing == MAP_FAILED) {
+                return false;
+            }
+            if (singleMap) {
+                cqRing = sqRing;
+            } else {
+                cqRing = ::mmap(nullptr, cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+                if (cqRing == MAP_FAILED) {
+                    return false;
+                }
+            }
+            sqeBytes = params.sq_entries * sizeof(io_uring_sqe);
+            void* sqeMap = ::mmap(nullptr, sqeBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+            if (sqeMap == MAP_FAILED) {
+                return false;
+            }
+            sqes = static_cast<io_uring_sqe*>(sqeMap);
+
+            char* sq = static_cast<char*>(sqRing);
+            sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            char* cq = static_cast<char*>(cqRing);
+            cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+            return true;
+        }
+
+        // At most one SQE per file in flight and inFlight <= depth <= sq_entries,
+        // so the submission queue never overflows.
+        void push(const io_uring_sqe& entry) {
+            const unsigned tail = *sqTail;
+            const unsigned index = tail & *sqMask;
+            sqes[index] = entry;
+            sqArray[index] = index;
+            std::atomic_ref<unsigned>(*sqTail).store(tail + 1, std::memory_order_release);
+            ++unsubmitted;
+        }
+
+        void startOpen(Op* op) {
+            io_uring_sqe entry {};
+            entry.opcode = IORING_OP_OPENAT;
+            entry.fd = AT_FDCWD;
+            entry.addr = reinterpret_cast<std::uintptr_t>(op->request.path.c_str());
+            entry.open_flags = O_RDONLY | O_CLOEXEC;
+            entry.user_data = reinterpret_cast<std::uintptr_t>(op);
+            push(entry);
+        }
+
+        void startRead(Op* op) {
+            io_uring_sqe entry {};
+            entry.opcode = IORING_OP_READ;
+            entry.fd = op->fd;
+            entry.addr = reinterpret_cast<std::uintptr_t>(op->data.data() + op->offset);
+            entry.len = static_cast<unsigned>(std::min<std::size_t>(op->data.size() - op->offset, 1u << 30));
+            entry.off = op->offset;
+            entry.user_data = reinterpret_cast<std::uintptr_t>(op);
+            push(entry);
+        }
+
+        void finish(Op* op, int error) {
+            std::unique_ptr<Op> owned(op);
+            if (op->fd >= 0) {
+                ::close(op->fd);
+            }
+            --inFlight;
+            ReadResult result{std::move(op->request.path), IoBuffer(), {}};
+            if (error != 0) {
+                result.error = std::error_code(error, std::generic_category());
+            } else {
+                result.data = std::move(op->data);
+            }
+            complete(op->request, std::move(result));
+        }
+
+        // Moves one file on to its next step; `res` is the CQE result.
+        void advance(Op* op, int res) {
+            if (op->fd < 0) {
+                if (res < 0) {
+                    return finish(op, -res);
+                }
+                op->fd = res;
+                struct stat info {};
+                if (::fstat(op->fd, &info) != 0) {
+                    return finish(op, errno);
+                }
+                op->data = IoBuffer(static_cast<std::size_t>(info.st_size), IoInit::Uninitialized);
+                if (op->data.size() == 0) {
+                    return finish(op, 0);
+                }
+                return startRead(op);
+            }
+
+            if (res == -EINTR || res == -EAGAIN) {
+                return startRead(op);
+            }
+            if (res < 0) {
+                return finish(op, -res);
+            }
+            if (res == 0) {
+                op->data.resize(op->offset); // the file shrank since fstat
+                return finish(op, 0);
+            }
+            op->offset += static_cast<std::size_t>(res);
+            if (op->offset < op->data.size()) {
+                return startRead(op);
+            }
+            finish(op, 0);
+        }
+
+        void submitAndWait() {
+            for (;;) {
+                const long submitted = ::syscall(__NR_io_uring_enter, ringFd, unsubmitted, 1u, IORING_ENTER_GETEVENTS, nullptr, 0);
+                if (submitted >= 0) {
+                    unsubmitted -= static_cast<unsigned>(submitted);
+                    return;
+                }
+                if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                    // Only a broken ring gets here; there is no one to report to.
+                    throw std::system_error(lastError(), "io_uring_enter");
+                }
+            }
+        }
+
+        void reap() {
+            unsigned head = *cqHead;
+            const unsigned tail = std::atomic_ref<unsigned>(*cqTail).load(std::memory_order_acquire);
+            while (head != tail) {
+                const io_uring_cqe& completion = cqes[head & *cqMask];
+                Op* op = reinterpret_cast<Op*>(completion.user_data);
+                const int res = completion.res;
+                ++head;
+                advance(op, res);
+            }
+            std::atomic_ref<unsigned>(*cqHead).store(head, std::memory_order_release);
+        }
+
+        void run() {
+            for (;;) {
+                {
+                    std::unique_lock<std::mutex> lock(m);
+                    queued.wait(lock, [&] { return inFlight > 0 || !queue.empty() || stopping; });
+                    if (inFlight == 0 && queue.empty()) {
+                        return;
+                    }
+                    while (!queue.empty() && inFlight < depth) {
+                        Op* op = new Op{std::move(queue.front()), -1, IoBuffer(), 0};
+                        queue.pop_front();
+                        ++inFlight;
+                        startOpen(op);
+                    }
+                }
+                submitAndWait();
+                reap();
+            }
+        }
+
+    public:
+        // nullptr when io_uring is not available; the caller falls back.
+        static std::unique_ptr<AsyncReader::Engine> create(std::size_t queueDepth) {
+            std::unique_ptr<IoUringEngine> engine(new IoUringEngine(queueDepth));
+            if (!engine->setUp()) {
+                return nullptr;
+            }
+            engine->ringThread = std::thread(&IoUringEngine::run, engine.get());
+            return engine;
+        }
+
+        ~IoUringEngine() override {
+            if (ringThread.joinable()) {
+                stop();
+                ringThread.join();
+            }
+            if (sqes != MAP_FAILED) {
+                ::munmap(sqes, sqeBytes);
+            }
+            if (cqRing != MAP_FAILED && cqRing != sqRing) {
+                ::munmap(cqRing, cqRingBytes);
+            }
+            if (sqRing != MAP_FAILED) {
+                ::munmap(sqRing, sqRingBytes);
+            }
+            if (ringFd >= 0) {
+                ::close(ringFd);
+            }
+        }
+
+        ReadBackend backend() const override {
+            return ReadBackend::IoUring;
+        }
+    };
+
+#endif // ASYNC_READER_IO_URING
+} // namespace
+
+AsyncReader::AsyncReader(std::size_t queueDepth, ReadBackend preferred) {
+    // io_uring_setup refuses more than 32768 entries; a thread per slot
+    // stops making sense long before that.
+    queueDepth = std::clamp<std::size_t>(queueDepth, 1, 4096);
+#if defined(ASYNC_READER_IO_URING)
+    if (preferred == ReadBackend::IoUring) {
+        engine = IoUringEngine::create(queueDepth);
+    }
+#else
+    (void)preferred;
+#endif
+    if (!engine) {
+        engine = std::make_unique<ThreadPoolEngine>(queueDepth);
+    }
+}
+
+AsyncReader::~AsyncReader() = default;
+
+void AsyncReader::read(std::string path, Callback done) {
+    engine->submit(std::move(path), std::move(done));
+}
+
+std::future<ReadResult> AsyncReader::read(std::string path) {
+    // std::function needs a copyable callable, hence the shared promise.
+    auto promise = std::make_shared<std::promise<ReadResult>>();
+    std::future<ReadResult> result = promise->get_future();
+    read(std::move(path), [promise](ReadResult r) { promise->set_value(std::move(r)); });
+    return result;
+}
+
+void AsyncReader::wait() {
+    engine->wait();
+}
+
+ReadBackend AsyncReader::backend() const {
+    return engine->backend();
+}
+
+std::size_t AsyncReader::queueDepth() const {
+    return engine->queueDepth();
+}
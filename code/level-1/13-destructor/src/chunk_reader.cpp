@@ -0,0 +1,93 @@
+#include "chunk_reader.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+ChunkReader::ChunkReader(const std::string& path, std::size_t chunkSize, std::size_t readAhead)
+    : file(path, std::ios::binary)
+    , chunkSize(std::max<std::size_t>(chunkSize, 1)) {
+    if (!file.is_open()) {
+        throw std::runtime_error("ChunkReader: cannot open " + path);
+    }
+    const std::size_t slots = std::max<std::size_t>(readAhead, 1) + 1;
+    ring.reserve(slots);
+    for (std::size_t i = 0; i < slots; ++i) {
+        ring.emplace_back(this->chunkSize, IoInit::Uninitialized, kPageAlignment);
+    }
+    ringFill.assign(slots, 0);
+    reader = std::thread(&ChunkReader::readLoop, this);
+}
+
+ChunkReader::~ChunkReader() {
+    {
+        std::lock_guard<std::mutex> lock(m);
+        stopping = true;
+    }
+    changed.notify_all();
+    reader.join();
+}
+
+void ChunkReader::readLoop() {
+    const std::uint64_t slots = ring.size();
+    for (std::uint64_t chunk = 0;; ++chunk) {
+        {
+            // Slot chunk % slots is free once the consumer has released the
+            // chunk that used it before.
+            std::unique_lock<std::mutex> lock(m);
+            changed.wait(lock, [&] { return stopping || chunk - released < slots; });
+            if (stopping) {
+                return;
+            }
+        }
+
+        // Filling the slot happens outside the lock: the consumer never
+        // looks at a slot past `produced`.
+        const std::size_t slot = static_cast<std::size_t>(chunk % slots);
+        std::size_t got = 0;
+        std::exception_ptr failure;
+        try {
+            file.read(ring[slot].data(), static_cast<std::streamsize>(chunkSize));
+            got = static_cast<std::size_t>(file.gcount());
+            if (file.bad()) {
+                throw std::runtime_error("ChunkReader: read failed");
+            }
+        } catch (...) {
+            failure = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m);
+            ringFill[slot] = got;
+            if (got != 0) {
+                ++produced;
+            }
+            if (failure || got < chunkSize) {
+                error = failure;
+                finished = true;
+            }
+        }
+        changed.notify_all();
+        if (failure || got < chunkSize) {
+            return;
+        }
+    }
+}
+
+std::span<const char> ChunkReader::next() {
+    std::unique_lock<std::mutex> lock(m);
+    // Everything before `current` has been handed out and is now done with.
+    released = current;
+    changed.notify_all();
+    changed.wait(lock, [&] { return produced > current || finished; });
+
+    if (produced > current) {
+        const std::size_t slot = static_cast<std::size_t>(current % ring.size());
+        ++current;
+        return {ring[slot].data(), ringFill[slot]};
+    }
+    if (error) {
+        std::rethrow_exception(std::exchange(error, nullptr));
+    }
+    return {};
+}
@@ -0,0 +1,46 @@
+#include "io_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    std::size_t checkedAlignment(std::size_t alignment) {
+        if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+            throw std::invalid_argument("IoBuffer: alignment must be a power of two");
+        }
+        return alignment;
+    }
+} // namespace
+
+IoBuffer::IoBuffer(std::size_t size, IoInit init, std::size_t alignment)
+    : storage(nullptr, AlignedDelete{checkedAlignment(alignment)}) {
+    resize(size, init);
+}
+
+void IoBuffer::regrow(std::size_t capacity) {
+    const std::size_t alignment = this->alignment();
+    std::unique_ptr<char[], AlignedDelete> fresh(
+        static_cast<char*>(::operator new[](capacity, std::align_val_t(alignment))), AlignedDelete{alignment});
+    if (length != 0) {
+        std::memcpy(fresh.get(), storage.get(), length);
+    }
+    storage = std::move(fresh);
+    allocated = capacity;
+}
+
+void IoBuffer::reserve(std::size_t capacity) {
+    if (capacity > allocated) {
+        regrow(capacity);
+    }
+}
+
+void IoBuffer::resize(std::size_t n, IoInit init) {
+    if (n > allocated) {
+        regrow(std::max(n, allocated * 2));
+    }
+    if (n > length && init == IoInit::Zeroed) {
+        std::memset(storage.get() + length, 0, n - length);
+    }
+    length = n;
+}
@@ -1,39 +1,112 @@
+#include "async_reader.h"
+#include "chunk_reader.h"
+#include "io_buffer.h"
+#include "mapped_file.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
 #include <iostream>
 #include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
 // Example : Basic Destructor (Manual Resource Management)
+// Owns two raw resources, an open FILE* and a heap buffer, and gives both
+// back by hand. A compiler-generated copy would close the file twice, so
+// copying is disabled.
 class FileHandler {
 private:
+    std::FILE* file;
     char* buffer;
+    size_t capacity;
     std::string filename;
 
 public:
     FileHandler(const std::string& name, size_t size)
         : filename(name) {
-        buffer = new char[size];
+        file = std::fopen(name.c_str(), "rb");
+        if (file == nullptr) {
+            throw std::runtime_error("FileHandler: cannot open " + name);
+        }
+        // If the constructor throws, the destructor never runs: undo by hand.
+        try {
+            buffer = new char[size];
+        } catch (...) {
+            std::fclose(file);
+            throw;
+        }
+        capacity = size;
         std::cout << "FileHandler created for: " << filename << "\n";
     }
 
-    // Destructor - cleans up dynamically allocated memory
+    FileHandler(const FileHandler&) = delete;
+    FileHandler& operator=(const FileHandler&) = delete;
+
+    // Reads the next chunk into the buffer; returns its size, 0 at end of file.
+    size_t read() {
+        return std::fread(buffer, 1, capacity, file);
+    }
+
+    const char* data() const {
+        return buffer;
+    }
+
+    // Destructor - closes the file and cleans up dynamically allocated memory
     ~FileHandler() {
+        std::fclose(file);
         delete[] buffer;
         std::cout << "FileHandler destroyed for: " << filename << "\n";
     }
 };
 
 // Example: Rule of Zero (Modern C++ - No Custom Destructor Needed)
+// The buffer is an IoBuffer: a std::unique_ptr with an aligned deleter,
+// plus its size and capacity. Pass IoInit::Uninitialized for buffers the first read overwrites.
+//
+// Three ways to read the file, all cleaned up by their own destructors:
+//   mapped()     the whole file as one span, via mmap (MappedFile)
+//   stream()     chunks of buffer-size bytes, read ahead on a background thread
+//   readAsync()  the whole file, batched with other reads on an AsyncReader
 class ModernFileHandler {
 private:
-    std::unique_ptr<char[]> buffer;
+    IoBuffer buffer;
     std::string filename;
+    std::optional<MappedFile> mapping; // created on the first mapped() call
 
 public:
-    ModernFileHandler(const std::string& name, size_t size)
-        : buffer(std::make_unique<char[]>(size))
+    ModernFileHandler(const std::string& name, size_t size, IoInit init = IoInit::Zeroed, size_t alignment = kCacheLineAlignment)
+        : buffer(size, init, alignment)
         , filename(name) {
         std::cout << "ModernFileHandler created for: " << filename << "\n";
     }
 
+    IoBuffer& data() {
+        return buffer;
+    }
+
+    std::span<const char> mapped(MappedFile::Access access = MappedFile::Access::Sequential) {
+        if (!mapping) {
+            mapping.emplace(filename);
+            mapping->advise(access);
+        }
+        return mapping->span();
+    }
+
+    ChunkReader stream(size_t readAhead = 2) const {
+        return ChunkReader(filename, buffer.size(), readAhead);
+    }
+
+    std::future<ReadResult> readAsync(AsyncReader& reader) const {
+        return reader.read(filename);
+    }
+
     // No custom destructor needed - smart pointer handles cleanup automatically!
     ~ModernFileHandler() {
         std::cout << "ModernFileHandler destroyed for: " << filename << "\n";
@@ -111,21 +184,97 @@ public:
 
 int Counter::count = 0;
 
+// Writes a small file for the examples into the temp directory.
+std::string writeDemoFile(const std::string& name, size_t lines) {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+    std::ofstream out(path, std::ios::binary);
+    for (size_t i = 0; i < lines; ++i) {
+        out << "line " << i << " of " << name << "\n";
+    }
+    return path.string();
+}
+
 int main() {
+    const std::string dataPath = writeDemoFile("data.txt", 100);
+    const std::string modernPath = writeDemoFile("modern_data.txt", 1000);
+
     std::cout << "=== Example: Manual Resource Management ===\n";
     {
-        FileHandler fh("data.txt", 1024);
+        FileHandler fh(dataPath, 1024);
+        size_t total = 0;
+        while (size_t got = fh.read()) {
+            total += got;
+        }
+        std::cout << "Read " << total << " bytes\n";
         // Destructor called automatically when fh goes out of scope
     }
     std::cout << "\n";
 
     std::cout << "=== Example: Rule of Zero (Smart Pointers) ===\n";
     {
-        ModernFileHandler mfh("modern_data.txt", 2048);
+        ModernFileHandler mfh(modernPath, 2048);
         // Smart pointer automatically cleans up
     }
     std::cout << "\n";
 
+    std::cout << "=== Example: Memory-Mapped and Streaming Reads ===\n";
+    {
+        ModernFileHandler mfh(modernPath, 4096, IoInit::Uninitialized);
+
+        std::span<const char> all = mfh.mapped();
+        std::string_view text(all.data(), all.size());
+        std::cout << "Mapped " << all.size() << " bytes, first line: " << text.substr(0, text.find('\n')) << "\n";
+
+        size_t chunks = 0;
+        size_t streamed = 0;
+        for (std::span<const char> chunk : mfh.stream()) {
+            ++chunks;
+            streamed += chunk.size();
+        }
+        std::cout << "Streamed " << streamed << " bytes in " << chunks << " chunks of up to 4096\n";
+        // ~ModernFileHandler -> ~MappedFile unmaps; the ChunkReader already joined its thread
+    }
+    std::cout << "\n";
+
+    std::cout << "=== Example: Batched Asynchronous Reads ===\n";
+    {
+        // Declared first so it is destroyed last: ~AsyncReader waits for any
+        // read still writing into a buffer.
+        AsyncReader reader(8);
+        std::cout << "Backend: " << (reader.backend() == ReadBackend::IoUring ? "io_uring" : "pread thread pool") << "\n";
+
+        ModernFileHandler mfh(modernPath, 4096, IoInit::Uninitialized);
+        std::future<ReadResult> whole = mfh.readAsync(reader);
+
+        std::atomic<size_t> bytes = 0;
+        std::atomic<size_t> failed = 0;
+        for (int i = 0; i < 16; ++i) {
+            reader.read(i % 4 == 3 ? "missing.txt" : dataPath, [&](ReadResult r) {
+                // Runs on the reader's thread, hence the atomics
+                if (r.error) {
+                    ++failed;
+                } else {
+                    bytes += r.data.size();
+                }
+            });
+        }
+        reader.wait();
+
+        std::cout << "Future: " << whole.get().data.size() << " bytes\n";
+        std::cout << "Callbacks: " << bytes << " bytes, " << failed << " missing files\n";
+    }
+    std::cout << "\n";
+
+    std::cout << "=== Example: Uninitialized, Page-Aligned, Growable Buffer ===\n";
+    {
+        ModernFileHandler big("big_data.bin", 4 << 20, IoInit::Uninitialized, kPageAlignment);
+        IoBuffer& io = big.data();
+        std::cout << "Page aligned: " << (reinterpret_cast<std::uintptr_t>(io.data()) % kPageAlignment == 0 ? "yes" : "no") << "\n";
+        io.resize(io.size() + 4096, IoInit::Uninitialized); // room for one more page
+        std::cout << "Size " << io.size() << ", capacity " << io.capacity() << " (doubled)\n";
+    }
+    std::cout << "\n";
+
     std::cout << "=== Example: Virtual Destructor (Polymorphism) ===\n";
     {
         Shape* shape1 = new Circle(5.0);
@@ -153,4 +302,7 @@ int main() {
 
         std::cout << "\nStack objects destroyed automatically:\n";
     }
+
+    std::filesystem::remove(dataPath);
+    std::filesystem::remove(modernPath);
 }
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "mapped_file.h"
+
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), "MappedFile: cannot open " + path);
+    }
+    length = static_cast<std::size_t>(file.tellg());
+    contents = IoBuffer(length, IoInit::Uninitialized);
+    file.seekg(0);
+    file.read(contents.data(), static_cast<std::streamsize>(length));
+    base = contents.data();
+}
+
+void MappedFile::unmap() noexcept {
+    contents = IoBuffer();
+    base = nullptr;
+    length = 0;
+}
+
+void MappedFile::advise(Access) const {}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : base(std::exchange(other.base, nullptr))
+    , length(std::exchange(other.length, 0))
+    , contents(std::move(other.contents)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        base = std::exchange(other.base, nullptr);
+        length = std::exchange(other.length, 0);
+        contents = std::move(other.contents);
+    }
+    return *this;
+}
+
+#else
+
+namespace {
+    [[noreturn]] void throwErrno(const std::string& what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+} // namespace
+
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throwErrno("MappedFile: cannot open " + path);
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        throwErrno("MappedFile: cannot stat " + path);
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    if (length != 0) {
+        void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            const int error = errno;
+            ::close(fd);
+            errno = error;
+            throwErrno("MappedFile: cannot map " + path);
+        }
+        base = static_cast<const char*>(mapping);
+    }
+    ::close(fd); // the mapping holds its own reference to the file
+}
+
+void MappedFile::unmap() noexcept {
+    if (base != nullptr) {
+        ::munmap(const_cast<char*>(base), length);
+        base = nullptr;
+        length = 0;
+    }
+}
+
+void MappedFile::advise(Access access) const {
+    if (base == nullptr) {
+        return;
+    }
+    int advice = MADV_NORMAL;
+    switch (access) {
+        case Access::Normal:
+            advice = MADV_NORMAL;
+            break;
+        case Access::Sequential:
+            advice = MADV_SEQUENTIAL;
+            break;
+        case Access::Random:
+            advice = MADV_RANDOM;
+            break;
+        case Access::WillNeed:
+            advice = MADV_WILLNEED;
+            break;
+    }
+    ::madvise(const_cast<char*>(base), length, advice);
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : base(std::exchange(other.base, nullptr))
+    , length(std::exchange(other.length, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        base = std::exchange(other.base, nullptr);
+        length = std::exchange(other.length, 0);
+    }
+    return *this;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    unmap();
+}
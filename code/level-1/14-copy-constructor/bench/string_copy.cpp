@@ -0,0 +1,173 @@
+// Construct / copy / destroy cost of DeepString with small-string optimization,
+// compared with std::string and with the original always-heap DeepString.
+//
+// Usage: level-1_14-copy-constructor_string_copy [iterations] [lengths]
+//
+// lengths is a comma-separated list, default "5,22,64". Each cell is the
+// average time of one operation in ns. Objects are built kBatch at a time
+// into preallocated storage and then destroyed, so each column times only
+// its own loop: construct from a C string, copy-construct, or run the
+// destructor.
+
+#include "deep_string.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    // The DeepString from before the small-string optimization, minus the
+    // tracing: every construction and every copy allocates.
+    class LegacyDeepString {
+        char* buffer;
+        size_t length;
+
+    public:
+        LegacyDeepString(const char* str) {
+            length = strlen(str);
+            buffer = new char[length + 1];
+            strcpy(buffer, str);
+        }
+
+        LegacyDeepString(const LegacyDeepString& other) {
+            length = other.length;
+            buffer = new char[length + 1];
+            strcpy(buffer, other.buffer);
+        }
+
+        LegacyDeepString& operator=(const LegacyDeepString&) = delete;
+
+        ~LegacyDeepString() {
+            delete[] buffer;
+        }
+
+        const char* c_str() const {
+            return buffer;
+        }
+    };
+
+    // Reads one byte of every object so the work can't be optimized away.
+    volatile char sink;
+
+    struct Timing {
+        double constructNs;
+        double copyNs;
+        double destroyNs;
+    };
+
+    constexpr long kBatch = 1024;
+
+    template <typename S>
+    Timing measure(const std::vector<std::string>& inputs, long iterations) {
+        using Clock = std::chrono::steady_clock;
+        using Ns = std::chrono::duration<double, std::nano>;
+        const std::size_t n = inputs.size();
+        char seen = 0;
+
+        std::vector<S> sources;
+        sources.reserve(n);
+        for (const auto& input : inputs) {
+            sources.emplace_back(input.c_str());
+        }
+
+        std::allocator<S> storage;
+        S* slots = storage.allocate(kBatch);
+        Ns construct{0};
+        Ns copy{0};
+        Ns destroy{0};
+        for (long done = 0; done < iterations; done += kBatch) {
+            const long count = std::min(kBatch, iterations - done);
+
+            auto start = Clock::now();
+            for (long i = 0; i < count; ++i) {
+                std::construct_at(slots + i, inputs[static_cast<std::size_t>(done + i) % n].c_str());
+            }
+            construct += Clock::now() - start;
+            for (long i = 0; i < count; ++i) {
+                seen ^= slots[i].c_str()[0];
+            }
+            start = Clock::now();
+            for (long i = 0; i < count; ++i) {
+                std::destroy_at(slots + i);
+            }
+            destroy += Clock::now() - start;
+
+            start = Clock::now();
+            for (long i = 0; i < count; ++i) {
+                std::construct_at(slots + i, sources[static_cast<std::size_t>(done + i) % n]);
+            }
+            copy += Clock::now() - start;
+            for (long i = 0; i < count; ++i) {
+                seen ^= slots[i].c_str()[0];
+                std::destroy_at(slots + i);
+            }
+        }
+        storage.deallocate(slots, kBatch);
+
+        sink = seen;
+        const double per = 1.0 / static_cast<double>(iterations);
+        return {construct.count() * per, copy.count() * per, destroy.count() * per};
+    }
+
+    std::vector<int> parseList(const char* text) {
+        std::vector<int> values;
+        while (*text != '\0') {
+            char* end = nullptr;
+            long value = std::strtol(text, &end, 10);
+            if (end == text) {
+                break;
+            }
+            values.push_back(static_cast<int>(value));
+            text = (*end == ',') ? end + 1 : end;
+        }
+        return values;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    const long iterations = argc > 1 ? std::atol(argv[1]) : 5'000'000;
+    const std::vector<int> lengths = parseList(argc > 2 ? argv[2] : "5,22,64");
+
+    if (iterations <= 0 || lengths.empty()) {
+        std::fprintf(stderr, "iterations must be positive and lengths non-empty\n");
+        return 1;
+    }
+    traceDeepString = false;
+
+    std::printf("%ld iterations, inline capacity %zu chars, sizeof(DeepString) = %zu\n\n",
+                iterations, DeepString::kInlineCapacity, sizeof(DeepString));
+    std::printf("%6s | %-14s %10s %10s %10s\n", "length", "type", "construct", "copy", "destroy");
+
+    int status = 0;
+    for (int length : lengths) {
+        // A few distinct inputs so the copies don't all hit one cache line.
+        std::vector<std::string> inputs;
+        for (char c = 'a'; c < 'a' + 8; ++c) {
+            inputs.emplace_back(static_cast<std::size_t>(length < 0 ? 0 : length), c);
+        }
+
+        // Correctness: a copy must match and stay independent of its source.
+        DeepString original(inputs[0].c_str());
+        DeepString copy = original;
+        copy.setChar(0, '!');
+        if (length > 0 && (original.c_str()[0] != 'a' || std::strlen(copy.c_str()) != inputs[0].size())) {
+            std::fprintf(stderr, "length %d: copy is not independent\n", length);
+            status = 1;
+        }
+
+        const Timing standard = measure<std::string>(inputs, iterations);
+        const Timing legacy = measure<LegacyDeepString>(inputs, iterations);
+        const Timing sso = measure<DeepString>(inputs, iterations);
+
+        std::printf("%6d | %-14s %10.1f %10.1f %10.1f\n", length, "std::string", standard.constructNs, standard.copyNs,
+                    standard.destroyNs);
+        std::printf("%6s | %-14s %10.1f %10.1f %10.1f\n", "", "legacy", legacy.constructNs, legacy.copyNs, legacy.destroyNs);
+        std::printf("%6s | %-14s %10.1f %10.1f %10.1f\n", "", "DeepString", sso.constructNs, sso.copyNs, sso.destroyNs);
+    }
+    return status;
+}
@@ -0,0 +1,258 @@
+// deep_string.h - Deep-copying string with small-string optimization
+#ifndef DEEP_STRING_H
+#define DEEP_STRING_H
+
+#include "instrumentation.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+
+// Prints every constructor / destructor call. Benchmarks turn it off.
+inline bool traceDeepString = true;
+
+enum class StringStorage {
+    Deep,        // every copy gets its own heap block (the default)
+    CopyOnWrite, // copies share one reference-counted block until written to
+};
+
+// DEEP COPY — Custom copy constructor
+// Each object gets its own independent allocation.
+//
+// Small-string optimization: strings of up to kInlineCapacity characters are
+// stored inside the object itself, so constructing or copying "hello" does
+// not allocate at all. Only longer strings go to the heap, and a deep copy of
+// those still allocates its own block. The length alone tells which
+// representation is active.
+//
+// Copy-on-write (opt-in, StringStorage::CopyOnWrite): a long string's block
+// starts with an atomic reference count. Copying the string only bumps the
+// count, so handing the same large text to many owners is O(1). The first
+// setChar() on a block that is still shared duplicates it; the other owners
+// keep seeing the old text. Copies of a copy-on-write string are
+// copy-on-write too. Short strings are inline either way.
+class DeepString {
+public:
+    static constexpr size_t kInlineCapacity = 23;
+
+private:
+    // Sits right in front of the characters of a copy-on-write block.
+    struct SharedHeader {
+        std::atomic<size_t> refs;
+    };
+
+    struct HeapRep {
+        char* chars;
+        bool shared; // chars is preceded by a SharedHeader
+    };
+
+    size_t length;
+    union {
+        HeapRep heap;                    // length > kInlineCapacity
+        char local[kInlineCapacity + 1]; // length <= kInlineCapacity
+    };
+
+    static SharedHeader* headerOf(char* chars) {
+        return std::launder(reinterpret_cast<SharedHeader*>(chars - sizeof(SharedHeader)));
+    }
+
+    static char* newBlock(size_t len, bool shared) {
+        if (!shared) {
+            return new char[len + 1];
+        }
+        char* raw = new char[sizeof(SharedHeader) + len + 1];
+        ::new (raw) SharedHeader{1};
+        return raw + sizeof(SharedHeader);
+    }
+
+    static void freeBlock(char* chars, bool shared) {
+        if (!shared) {
+            delete[] chars;
+            return;
+        }
+        SharedHeader* header = headerOf(chars);
+        // acq_rel: the last owner must see every write made before the
+        // other owners let go.
+        if (header->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            header->~SharedHeader();
+            delete[] (chars - sizeof(SharedHeader));
+        }
+    }
+
+    bool isShared() const {
+        return !isInline() && heap.shared;
+    }
+
+    bool isInline() const {
+        return length <= kInlineCapacity;
+    }
+
+    char* buffer() {
+        return isInline() ? local : heap.chars;
+    }
+
+    const char* buffer() const {
+        return isInline() ? local : heap.chars;
+    }
+
+    // Sets length and points buffer() at storage for length + 1 chars.
+    void allocate(size_t len, StringStorage storage) {
+        length = len;
+        if (!isInline()) {
+            heap.shared = storage == StringStorage::CopyOnWrite;
+            heap.chars = newBlock(length, heap.shared);
+        }
+    }
+
+    void release() {
+        if (!isInline()) {
+            freeBlock(heap.chars, heap.shared);
+        }
+    }
+
+    // Copy constructor body: shares a copy-on-write block, deep-copies
+    // everything else.
+    void copyFrom(const DeepString& other) {
+        if (other.isShared()) {
+            other.share();
+            length = other.length;
+            heap = other.heap;
+            counters().copied(0);
+            return;
+        }
+        allocate(other.length, StringStorage::Deep); // NEW allocation (if not inline) — independent copy
+        std::memcpy(buffer(), other.buffer(), length + 1);
+        counters().copied(length);
+    }
+
+    void share() const {
+        headerOf(heap.chars)->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Gives a shared block a private copy before the first write.
+    void makeUnique() {
+        if (headerOf(heap.chars)->refs.load(std::memory_order_acquire) == 1) {
+            return; // every other owner is gone
+        }
+        char* fresh = newBlock(length, true);
+        std::memcpy(fresh, heap.chars, length + 1);
+        freeBlock(heap.chars, true);
+        heap.chars = fresh;
+        counters().copied(length); // the copy that copy-on-write deferred
+    }
+
+    // Leaves a moved-from object as an empty inline string.
+    void stealFrom(DeepString& other) {
+        length = other.length;
+        if (other.isInline()) {
+            std::memcpy(local, other.local, length + 1);
+        }
+        else {
+            heap = other.heap;
+        }
+        other.length = 0;
+        other.local[0] = '\0';
+        counters().moved(length);
+    }
+
+    static instrumentation::TypeCounters& counters() {
+        static instrumentation::TypeCounters& all = instrumentation::typeCounters("DeepString");
+        return all;
+    }
+
+    void trace(const char* what) const {
+        if (traceDeepString) {
+            std::cout << "  [DeepString] " << what << " \"" << buffer() << "\"  @ " << (const void*)buffer()
+                      << (isInline() ? " (inline)" : isShared() ? " (copy-on-write)" : " (heap)") << "\n";
+        }
+    }
+
+public:
+    DeepString(const char* str, StringStorage storage = StringStorage::Deep) {
+        allocate(strlen(str), storage);
+        std::memcpy(buffer(), str, length + 1);
+        trace("Constructed ");
+    }
+
+    // Deep copy constructor
+    DeepString(const DeepString& other) {
+        copyFrom(other);
+        trace("Copy constructed");
+    }
+
+    // Move constructor: takes over the heap block, or copies the inline bytes
+    DeepString(DeepString&& other) noexcept {
+        stealFrom(other);
+        trace("Move constructed");
+    }
+
+    DeepString& operator=(const DeepString& other) {
+        if (this != &other) {
+            if (other.isShared()) {
+                other.share(); // before release(), in case both share the block
+                release();
+                length = other.length;
+                heap = other.heap;
+                counters().copied(0);
+            }
+            else {
+                // Allocate first so a throwing new leaves *this untouched.
+                char* fresh = other.isInline() ? nullptr : newBlock(other.length, false);
+                release();
+                length = other.length;
+                if (fresh != nullptr) {
+                    heap = HeapRep{fresh, false};
+                }
+                std::memcpy(buffer(), other.buffer(), length + 1);
+                counters().copied(length);
+            }
+            trace("Copy assigned");
+        }
+        return *this;
+    }
+
+    DeepString& operator=(DeepString&& other) noexcept {
+        if (this != &other) {
+            release();
+            stealFrom(other);
+            trace("Move assigned");
+        }
+        return *this;
+    }
+
+    void setChar(size_t i, char c) {
+        if (i < length) {
+            if (isShared()) {
+                makeUnique();
+            }
+            buffer()[i] = c;
+        }
+    }
+
+    const char* c_str() const {
+        return buffer();
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    // Number of strings sharing this one's characters (1 unless copy-on-write).
+    size_t useCount() const {
+        return isShared() ? headerOf(heap.chars)->refs.load(std::memory_order_relaxed) : 1;
+    }
+
+    void display(const std::string& label) const {
+        std::cout << "  " << label << ": \"" << buffer() << "\"  @ " << (const void*)buffer() << "\n";
+    }
+
+    ~DeepString() {
+        trace("Destroyed  ");
+        release();
+    }
+};
+
+#endif // DEEP_STRING_H
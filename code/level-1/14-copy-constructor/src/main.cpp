@@ -1,6 +1,11 @@
+#include "instrumentation.h"
+
+#include "deep_string.h"
+
 #include <cstring>
 #include <iostream>
 #include <string>
+#include <utility>
 
 // Default copy constructor is enough
 // No raw pointers; std::string handles its own memory.
@@ -75,43 +80,6 @@ void demo_shallow_copy_problem() {
     b.data = nullptr; // in real code YOU wouldn't do this; use deep copy instead
 }
 
-// DEEP COPY — Custom copy constructor
-// Each object gets its own independent allocation.
-class DeepString {
-    char* buffer;
-    size_t length;
-
-public:
-    DeepString(const char* str) {
-        length = strlen(str);
-        buffer = new char[length + 1];
-        strcpy(buffer, str);
-        std::cout << "  [DeepString] Constructed  \"" << buffer << "\"  @ " << (void*)buffer << "\n";
-    }
-
-    // Deep copy constructor
-    DeepString(const DeepString& other) {
-        length = other.length;
-        buffer = new char[length + 1]; // NEW allocation — independent copy
-        strcpy(buffer, other.buffer);
-        std::cout << "  [DeepString] Copy constructed \"" << buffer << "\"  @ " << (void*)buffer << "\n";
-    }
-
-    void setChar(size_t i, char c) {
-        if (i < length)
-            buffer[i] = c;
-    }
-
-    void display(const std::string& label) const {
-        std::cout << "  " << label << ": \"" << buffer << "\"  @ " << (void*)buffer << "\n";
-    }
-
-    ~DeepString() {
-        std::cout << "  [DeepString] Destroyed   \"" << buffer << "\"  @ " << (void*)buffer << "\n";
-        delete[] buffer;
-    }
-};
-
 void demo_deep_copy() {
     std::cout << "\n==============================\n";
     std::cout << " Deep Copy\n";
@@ -127,6 +95,44 @@ void demo_deep_copy() {
     copy.display("copy    ");     // "Hello"
 }
 
+void demo_small_string(instrumentation::CostTable& costs) {
+    std::cout << "\n==============================\n";
+    std::cout << " Small-String Optimization\n";
+    std::cout << "==============================\n";
+
+    {
+        // Short strings live inside the object: copying them never allocates.
+        instrumentation::AllocationScope scope("inline string: construct + copy", costs);
+        DeepString shortStr("hello");
+        DeepString shortCopy = shortStr;
+    }
+    {
+        // Longer ones go to the heap; a move hands the block over without copying.
+        instrumentation::AllocationScope scope("heap string: construct + move", costs);
+        DeepString longStr("a string too long for the inline buffer");
+        DeepString moved = std::move(longStr);
+        moved.display("moved   ");
+        longStr.display("longStr "); // empty after the move
+    }
+}
+
+void demo_copy_on_write(instrumentation::CostTable& costs) {
+    std::cout << "\n==============================\n";
+    std::cout << " Copy-on-Write\n";
+    std::cout << "==============================\n";
+    instrumentation::AllocationScope scope("copy-on-write: construct + copy + write", costs);
+
+    // Copies share one block until someone writes to it.
+    DeepString original("a large read-mostly configuration blob", StringStorage::CopyOnWrite);
+    DeepString copy = original; // no allocation, just a reference count bump
+    std::cout << "  sharing before write: " << original.useCount() << " owners\n";
+
+    copy.setChar(0, 'A'); // first write: copy gets its own block
+    original.display("original");
+    copy.display("copy    ");
+    std::cout << "  sharing after write: " << original.useCount() << " owner\n";
+}
+
 // ============================================================
 // DELETED COPY CONSTRUCTOR — prevent copying entirely
 // ============================================================
@@ -211,6 +217,14 @@ int main() {
     demo_default_copy();
     demo_shallow_copy_problem();
     demo_deep_copy();
+    instrumentation::CostTable costs;
+    demo_small_string(costs);
+    demo_copy_on_write(costs);
     demo_deleted_copy();
     demo_inheritance();
+
+    std::cout << "\n==============================\n";
+    std::cout << " Cost of the DeepString demos\n";
+    std::cout << "==============================\n";
+    costs.print();
 }
\ No newline at end of file
@@ -0,0 +1,126 @@
+// Stress and throughput test for Ledger.
+//
+// Usage: level-1_22-const_ledger_stress [accounts] [transfers_per_thread] [threads]
+//
+// Every thread performs random transfers (half one at a time, half through
+// transferBatch) while a checker thread keeps taking total() snapshots. The
+// program fails if money is ever created or destroyed, or if a balance goes
+// negative.
+
+#include "ledger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, char** argv) {
+    const std::size_t accounts = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000;
+    const long perThread = argc > 2 ? std::atol(argv[2]) : 1'000'000;
+    const unsigned threads = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3])) : std::max(1u, std::thread::hardware_concurrency());
+    const Cents initial = toCents(1000.00);
+    const std::size_t batchSize = 4096;
+
+    Ledger ledger;
+    for (std::size_t i = 0; i < accounts; ++i) {
+        ledger.open("account-" + std::to_string(i), initial);
+    }
+    const Cents expectedTotal = initial * static_cast<Cents>(accounts);
+
+    std::atomic<bool> running{true};
+    std::atomic<long> badSnapshots{0};
+    std::atomic<long> snapshots{0};
+    std::thread checker([&] {
+        while (running.load(std::memory_order_relaxed)) {
+            if (ledger.total() != expectedTotal) {
+                badSnapshots.fetch_add(1);
+            }
+            snapshots.fetch_add(1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    std::atomic<long> applied{0};
+    std::atomic<long> rejected{0};
+    std::atomic<long> submitted{0};
+
+    auto runPhase = [&](bool batched) {
+        std::vector<std::thread> workers;
+        submitted.store(0);
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                std::mt19937_64 rng(12345 + t + (batched ? 1000 : 0));
+                std::uniform_int_distribution<std::size_t> pick(0, accounts - 1);
+                std::uniform_int_distribution<Cents> amount(1, toCents(50.00));
+                long ok = 0;
+                long no = 0;
+
+                if (!batched) {
+                    for (long i = 0; i < perThread / 2; ++i) {
+                        if (ledger.transfer(pick(rng), pick(rng), amount(rng))) {
+                            ++ok;
+                        }
+                        else {
+                            ++no;
+                        }
+                    }
+                }
+                else {
+                    std::vector<Transfer> batch;
+                    for (long done = 0; done < perThread / 2; done += static_cast<long>(batch.size())) {
+                        batch.resize(std::min<std::size_t>(batchSize, static_cast<std::size_t>(perThread / 2 - done)));
+                        for (auto& tr : batch) {
+                            tr = Transfer{pick(rng), pick(rng), amount(rng)};
+                        }
+                        BatchResult r = ledger.transferBatch(batch);
+                        ok += static_cast<long>(r.applied);
+                        no += static_cast<long>(r.rejected);
+                    }
+                }
+                applied.fetch_add(ok);
+                rejected.fetch_add(no);
+                submitted.fetch_add(ok + no);
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        const double attempted = static_cast<double>(submitted.load());
+        std::printf("%-10s %8.2f M transfers/s\n", batched ? "batch" : "single", attempted / elapsed.count() / 1e6);
+    };
+
+    std::printf("%zu accounts, %u threads, %ld transfers per thread\n", accounts, threads, perThread);
+    runPhase(false);
+    runPhase(true);
+
+    running.store(false);
+    checker.join();
+
+    bool ok = true;
+    if (ledger.total() != expectedTotal) {
+        std::fprintf(stderr, "FAIL: total %lld, expected %lld\n", static_cast<long long>(ledger.total()), static_cast<long long>(expectedTotal));
+        ok = false;
+    }
+    for (std::size_t i = 0; i < accounts; ++i) {
+        if (ledger.balance(i) < 0) {
+            std::fprintf(stderr, "FAIL: account %zu is negative\n", i);
+            ok = false;
+            break;
+        }
+    }
+    if (badSnapshots.load() != 0) {
+        std::fprintf(stderr, "FAIL: %ld of %ld snapshots did not add up\n", badSnapshots.load(), snapshots.load());
+        ok = false;
+    }
+
+    std::printf("applied %ld, rejected %ld, %ld consistent snapshots -> %s\n", applied.load(), rejected.load(), snapshots.load(), ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+// ledger.h - Thread-safe set of accounts with deadlock-free transfers
+#ifndef LEDGER_H
+#define LEDGER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+// Money is kept in integer cents: doubles cannot represent 0.10 exactly, and
+// rounding errors would break "money is never created or destroyed".
+using Cents = std::int64_t;
+
+Cents toCents(double dollars);
+
+struct Transfer {
+    std::size_t from;
+    std::size_t to;
+    Cents amount;
+};
+
+struct BatchResult {
+    std::size_t applied = 0;
+    std::size_t rejected = 0; // insufficient funds or from == to
+};
+
+// Concurrent version of the BankAccount example: many accounts, many threads.
+// Accounts are not BankAccount objects, which keep a double balance and no
+// lock; each one is just its owner and a balance in cents.
+//
+// Accounts are guarded by a fixed number of striped mutexes (account i uses
+// stripe i % stripes) instead of one mutex per account or one for everything.
+// A transfer locks both stripes at once with std::scoped_lock, which avoids
+// deadlock no matter in which order two threads name the same accounts.
+//
+// Const methods (balance, total) still lock: locking does not change the
+// observable state of the ledger, so it does not break const correctness.
+class Ledger {
+private:
+    struct Account {
+        std::string owner;
+        Cents balance;
+    };
+
+    struct alignas(64) Stripe {
+        std::mutex m;
+    };
+
+    std::vector<Account> accounts;
+    std::unique_ptr<Stripe[]> stripes;
+    std::size_t stripeCount;
+
+    std::mutex& stripeFor(std::size_t account) const {
+        return stripes[account % stripeCount].m;
+    }
+
+    void checkAccount(std::size_t account) const;
+
+    // Caller holds the stripes of both accounts.
+    bool applyLocked(const Transfer& t);
+
+public:
+    explicit Ledger(std::size_t numStripes = 64);
+
+    // Not thread-safe: open every account before sharing the ledger.
+    std::size_t open(std::string owner, Cents initial);
+
+    std::size_t size() const {
+        return accounts.size();
+    }
+
+    const std::string& owner(std::size_t account) const;
+    Cents balance(std::size_t account) const;
+
+    void deposit(std::size_t account, Cents amount);
+
+    // Moves `amount` atomically: other threads see either both sides updated
+    // or neither. Returns false (and changes nothing) if funds are insufficient.
+    // Throws std::out_of_range for an unknown account.
+    bool transfer(std::size_t from, std::size_t to, Cents amount);
+
+    // Applies many transfers with far fewer lock acquisitions: transfers are
+    // grouped by the pair of stripes they touch, and each group is applied
+    // under a single lock of that pair, in the order given. Transfers in
+    // different groups may be applied in any order relative to each other.
+    BatchResult transferBatch(std::span<const Transfer> batch);
+
+    // Sum of all balances, taken with every stripe locked (a consistent snapshot).
+    Cents total() const;
+};
+
+#endif // LEDGER_H
@@ -0,0 +1,161 @@
+#include "ledger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+Cents toCents(double dollars) {
+    return static_cast<Cents>(std::llround(dollars * 100.0));
+}
+
+Ledger::Ledger(std::size_t numStripes)
+    : stripes(std::make_unique<Stripe[]>(std::max<std::size_t>(numStripes, 1)))
+    , stripeCount(std::max<std::size_t>(numStripes, 1)) {}
+
+std::size_t Ledger::open(std::string owner, Cents initial) {
+    if (initial < 0) {
+        throw std::invalid_argument("initial balance must not be negative");
+    }
+    accounts.push_back(Account{std::move(owner), initial});
+    return accounts.size() - 1;
+}
+
+void Ledger::checkAccount(std::size_t account) const {
+    if (account >= accounts.size()) {
+        throw std::out_of_range("unknown account " + std::to_string(account));
+    }
+}
+
+const std::string& Ledger::owner(std::size_t account) const {
+    checkAccount(account);
+    return accounts[account].owner; // never changes after open()
+}
+
+Cents Ledger::balance(std::size_t account) const {
+    checkAccount(account);
+    std::lock_guard<std::mutex> lock(stripeFor(account));
+    return accounts[account].balance;
+}
+
+void Ledger::deposit(std::size_t account, Cents amount) {
+    checkAccount(account);
+    if (amount < 0) {
+        throw std::invalid_argument("deposit amount must not be negative");
+    }
+    std::lock_guard<std::mutex> lock(stripeFor(account));
+    accounts[account].balance += amount;
+}
+
+bool Ledger::applyLocked(const Transfer& t) {
+    if (t.from == t.to || t.amount < 0 || accounts[t.from].balance < t.amount) {
+        return false;
+    }
+    accounts[t.from].balance -= t.amount;
+    accounts[t.to].balance += t.amount;
+    return true;
+}
+
+bool Ledger::transfer(std::size_t from, std::size_t to, Cents amount) {
+    checkAccount(from);
+    checkAccount(to);
+
+    std::mutex& a = stripeFor(from);
+    std::mutex& b = stripeFor(to);
+    if (&a == &b) {
+        // Same stripe: locking it twice would deadlock.
+        std::lock_guard<std::mutex> lock(a);
+        return applyLocked(Transfer{from, to, amount});
+    }
+    std::scoped_lock lock(a, b);
+    return applyLocked(Transfer{from, to, amount});
+}
+
+BatchResult Ledger::transferBatch(std::span<const Transfer> batch) {
+    for (const auto& t : batch) {
+        checkAccount(t.from);
+        checkAccount(t.to);
+    }
+
+    // Group by (lower stripe, higher stripe), keeping transfers within a
+    // group in their order. Big batches use two stable counting sorts, by
+    // the higher stripe and then the lower, O(b + stripes) for b transfers;
+    // batches smaller than the stripe count use a comparison sort instead,
+    // O(b log b). Either way the work is at most O(b log b), not stripes².
+    struct Pending {
+        std::size_t lo;
+        std::size_t hi;
+        std::size_t index;
+    };
+    std::vector<Pending> order(batch.size());
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        const std::size_t sa = batch[i].from % stripeCount;
+        const std::size_t sb = batch[i].to % stripeCount;
+        order[i] = Pending{std::min(sa, sb), std::max(sa, sb), i};
+    }
+    if (batch.size() >= stripeCount) {
+        std::vector<Pending> sorted(order.size());
+        std::vector<std::size_t> next(stripeCount + 1);
+        for (std::size_t Pending::*stripe : {&Pending::hi, &Pending::lo}) {
+            std::fill(next.begin(), next.end(), 0);
+            for (const auto& p : order) {
+                ++next[p.*stripe + 1];
+            }
+            std::partial_sum(next.begin(), next.end(), next.begin());
+            for (const auto& p : order) {
+                sorted[next[p.*stripe]++] = p;
+            }
+            order.swap(sorted);
+        }
+    }
+    else {
+        std::sort(order.begin(), order.end(), [](const Pending& a, const Pending& b) {
+            return std::tie(a.lo, a.hi, a.index) < std::tie(b.lo, b.hi, b.index);
+        });
+    }
+
+    BatchResult result;
+    for (std::size_t begin = 0, end; begin < order.size(); begin = end) {
+        const std::size_t lo = order[begin].lo;
+        const std::size_t hi = order[begin].hi;
+        end = begin + 1;
+        while (end < order.size() && order[end].lo == lo && order[end].hi == hi) {
+            ++end;
+        }
+
+        // Always lock the lower stripe first: address-ordered locking, so two
+        // batches can never wait on each other in a cycle.
+        std::unique_lock<std::mutex> first(stripes[lo].m);
+        std::unique_lock<std::mutex> second;
+        if (hi != lo) {
+            second = std::unique_lock<std::mutex>(stripes[hi].m);
+        }
+
+        for (std::size_t i = begin; i < end; ++i) {
+            if (applyLocked(batch[order[i].index])) {
+                ++result.applied;
+            }
+            else {
+                ++result.rejected;
+            }
+        }
+    }
+    return result;
+}
+
+Cents Ledger::total() const {
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(stripeCount);
+    for (std::size_t i = 0; i < stripeCount; ++i) {
+        locks.emplace_back(stripes[i].m); // ascending order, same as transferBatch
+    }
+
+    Cents sum = 0;
+    for (const auto& account : accounts) {
+        sum += account.balance;
+    }
+    return sum;
+}
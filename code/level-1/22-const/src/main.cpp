@@ -1,3 +1,5 @@
+#include "ledger.h"
+
 #include <iostream>
 #include <string>
 
@@ -97,6 +99,23 @@ public:
     }
 };
 
+// CONST IN A CONCURRENT SETTING
+void demonstrateLedger() {
+    Ledger ledger;
+    const std::size_t alice = ledger.open("Alice", toCents(100.00));
+    const std::size_t bob = ledger.open("Bob", toCents(50.00));
+
+    ledger.transfer(alice, bob, toCents(30.25));
+    bool ok = ledger.transfer(bob, alice, toCents(500.00)); // insufficient funds, nothing changes
+
+    // A const reference can still read balances: they are read under a lock,
+    // which is not an observable modification.
+    const Ledger& view = ledger;
+    std::cout << view.owner(alice) << ": " << view.balance(alice) << " cents" << std::endl;
+    std::cout << view.owner(bob) << ": " << view.balance(bob) << " cents" << std::endl;
+    std::cout << "Second transfer " << (ok ? "applied" : "rejected") << ", total: " << view.total() << " cents" << std::endl;
+}
+
 int main() {
     // Using const constants
     std::cout << "\nConst Constants:" << std::endl;
@@ -142,4 +161,7 @@ int main() {
     const double& bal = constAcc.getBalanceRef(); // Calls const version
     std::cout << "Balance: $" << bal << std::endl;
     // bal = 800.0; // ❌ Error: can't modify through const reference
+
+    std::cout << "\nConcurrent Ledger:" << std::endl;
+    demonstrateLedger();
 }
\ No newline at end of file
@@ -0,0 +1,110 @@
+// Cost of a short-lived RAII scope: a fresh heap Resource per manager, as
+// ResourceManager does, versus one borrowed from the thread-local pool.
+//
+// Usage: level-2_36-raii_resource_pool [scopes_per_thread] [threads] [managers_per_scope]
+//
+// Each scope creates managers_per_scope managers, touches their resources
+// and destroys them in reverse order.
+//   new/delete  what ResourceManager does (std::unique_ptr<Resource>)
+//   pooled      PooledResourceManager
+//
+// Each thread raises its pool's capacity to managers_per_scope first, if it
+// is smaller, so a whole scope's worth of Resources fits back into the pool.
+// The pooled run must then miss only while the pool warms up: at most
+// managers_per_scope times per thread.
+
+#include "resource_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+    std::atomic<std::uintptr_t> sink{0};
+
+    template <typename Manager>
+    void runScopes(long scopes, std::size_t managers) {
+        std::uintptr_t local = 0;
+        std::vector<Manager> live;
+        live.reserve(managers);
+        for (long i = 0; i < scopes; ++i) {
+            for (std::size_t j = 0; j < managers; ++j) {
+                live.emplace_back();
+                local += reinterpret_cast<std::uintptr_t>(live.back().get());
+            }
+            while (!live.empty()) {
+                live.pop_back();
+            }
+        }
+        sink += local;
+    }
+
+    // Stands in for ResourceManager, which lives in main.cpp.
+    class HeapManager {
+    private:
+        std::unique_ptr<Resource> resource = std::make_unique<Resource>();
+
+    public:
+        Resource* get() const {
+            return resource.get();
+        }
+    };
+
+    template <typename Fn>
+    double nsPerScope(long scopes, int threads, Fn body) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back(body);
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / static_cast<double>(scopes * threads);
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    const long scopes = argc > 1 ? std::atol(argv[1]) : 2'000'000;
+    const int threads = argc > 2 ? std::atoi(argv[2]) : 1;
+    const std::size_t managers = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 4;
+
+    if (scopes <= 0 || threads <= 0 || managers == 0) {
+        std::fprintf(stderr, "scopes, threads and managers_per_scope must be positive\n");
+        return 1;
+    }
+    traceResource = false;
+
+    const double heap = nsPerScope(scopes, threads, [&] { runScopes<HeapManager>(scopes, managers); });
+
+    std::atomic<std::uint64_t> hits{0};
+    std::atomic<std::uint64_t> misses{0};
+    const double pooled = nsPerScope(scopes, threads, [&] {
+        if (ResourcePool::capacity() < managers) {
+            ResourcePool::setCapacity(managers);
+        }
+        runScopes<PooledResourceManager>(scopes, managers);
+        hits += ResourcePool::threadStats().hits;
+        misses += ResourcePool::threadStats().misses;
+    });
+
+    std::printf("%ld scopes x %d threads, %zu managers per scope\n\n", scopes, threads, managers);
+    std::printf("%-12s %12s\n", "manager", "ns/scope");
+    std::printf("%-12s %12.1f\n", "new/delete", heap);
+    std::printf("%-12s %12.1f\n", "pooled", pooled);
+    std::printf("\npool: %llu hits, %llu misses\n", static_cast<unsigned long long>(hits.load()), static_cast<unsigned long long>(misses.load()));
+
+    const std::uint64_t expected = static_cast<std::uint64_t>(scopes) * threads * managers;
+    if (hits + misses != expected || misses > managers * static_cast<std::uint64_t>(threads)) {
+        std::fprintf(stderr, "FAILED: expected %llu acquisitions with at most %zu misses per thread\n",
+                     static_cast<unsigned long long>(expected), managers);
+        return 1;
+    }
+    return 0;
+}
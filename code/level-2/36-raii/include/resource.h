@@ -0,0 +1,28 @@
+// resource.h - The resource every manager in this example owns
+#ifndef RESOURCE_H
+#define RESOURCE_H
+
+#include <iostream>
+
+// Benchmarks turn this off to keep the constructor and destructor messages
+// out of their timings.
+inline bool traceResource = true;
+
+class Resource {
+public:
+    Resource() {
+        if (traceResource) {
+            std::cout << "Resource acquired\n";
+        }
+    }
+    ~Resource() {
+        if (traceResource) {
+            std::cout << "Resource destroyed\n";
+        }
+    }
+    void sayHello() const {
+        std::cout << "Hello from Resource\n";
+    }
+};
+
+#endif // RESOURCE_H
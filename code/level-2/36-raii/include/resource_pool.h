@@ -0,0 +1,92 @@
+// resource_pool.h - Thread-local pool of Resource objects and a manager that recycles them
+#ifndef RESOURCE_POOL_H
+#define RESOURCE_POOL_H
+
+#include "resource.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// ------------------------------------------------------------------------------
+// Each thread keeps a list of idle, already constructed Resource objects.
+// acquire() hands one out without touching the heap and release() puts it
+// back, so a scope that only borrows a Resource costs a few instructions
+// instead of a new/delete pair plus the constructor and destructor.
+//
+// A Resource may be released on another thread than the one that acquired
+// it; it then joins that thread's list. Releases that would grow a list past
+// its capacity delete the object instead, and a thread's idle objects are
+// deleted when the thread exits.
+//
+// A recycled Resource is handed out as it was returned: anything a caller
+// changes in it must be reset before it goes back.
+// ------------------------------------------------------------------------------
+class ResourcePool {
+public:
+    static constexpr std::size_t kDefaultCapacity = 64;
+
+    struct Stats {
+        std::uint64_t hits = 0;     // served from the idle list
+        std::uint64_t misses = 0;   // list was empty, constructed a new Resource
+        std::uint64_t recycled = 0; // released back into the list
+        std::uint64_t dropped = 0;  // released into a full list, deleted
+    };
+
+    // Throws whatever new Resource() throws on a miss.
+    static Resource* acquire();
+    static void release(Resource* resource) noexcept;
+
+    // Constructs idle objects until `count` (at most capacity()) are ready.
+    static void reserve(std::size_t count);
+
+    // Idle objects above the new capacity are deleted.
+    static void setCapacity(std::size_t capacity);
+
+    // All of these describe the calling thread's pool.
+    static std::size_t available();
+    static std::size_t capacity();
+    static Stats threadStats();
+};
+
+// Same ownership rules as ResourceManager: exactly one owner, move-only, and
+// the Resource goes back even when the scope is left by an exception. Only
+// where the Resource comes from and goes to differs.
+class PooledResourceManager {
+private:
+    Resource* resource;
+
+public:
+    // Constructor borrows a resource from the calling thread's pool
+    PooledResourceManager()
+        : resource(ResourcePool::acquire()) {}
+
+    // Destructor returns it
+    ~PooledResourceManager() {
+        ResourcePool::release(resource);
+        if (traceResource) {
+            std::cout << "PooledResourceManager destroyed\n";
+        }
+    }
+
+    Resource* get() const {
+        return resource;
+    }
+
+    PooledResourceManager(const PooledResourceManager&) = delete;
+    PooledResourceManager& operator=(const PooledResourceManager&) = delete;
+
+    PooledResourceManager(PooledResourceManager&& other) noexcept
+        : resource(other.resource) {
+        other.resource = nullptr;
+    }
+    PooledResourceManager& operator=(PooledResourceManager&& other) noexcept {
+        if (this != &other) {
+            ResourcePool::release(resource);
+            resource = other.resource;
+            other.resource = nullptr;
+        }
+        return *this;
+    }
+};
+
+#endif // RESOURCE_POOL_H
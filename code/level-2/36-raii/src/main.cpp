@@ -1,17 +1,9 @@
-#include <iostream>
+#include "resource.h"
+#include "resource_pool.h"
 
-class Resource {
-public:
-    Resource() {
-        std::cout << "Resource acquired\n";
-    }
-    ~Resource() {
-        std::cout << "Resource destroyed\n";
-    }
-    void sayHello() const {
-        std::cout << "Hello from Resource\n";
-    }
-};
+#include <iostream>
+#include <stdexcept>
+#include <utility>
 
 class ResourceManager {
 private:
@@ -63,6 +55,23 @@ void useResourceWithException() {
     resMgr.get()->sayHello();
 } // ResourceManager goes out of scope, Resource is automatically destroyed even on exception
 
+void usePooledResource() {
+    PooledResourceManager resMgr; // Resource borrowed from the pool
+    resMgr.get()->sayHello();
+} // Resource goes back to the pool instead of being destroyed
+
+void usePooledResourceWithException() {
+    PooledResourceManager resMgr;                  // Resource borrowed from the pool
+    throw std::runtime_error("An error occurred"); // Simulate an exception
+    resMgr.get()->sayHello();
+} // Resource goes back to the pool even on exception
+
+void printPoolStats() {
+    ResourcePool::Stats stats = ResourcePool::threadStats();
+    std::cout << "Pool: " << ResourcePool::available() << " idle of " << ResourcePool::capacity() << ", " << stats.hits << " hits, "
+              << stats.misses << " misses\n";
+}
+
 int main() {
     useResource();
     std::cout << "---\n";
@@ -71,4 +80,20 @@ int main() {
     } catch (const std::exception& e) {
         std::cout << "Caught exception: " << e.what() << '\n';
     }
-}
\ No newline at end of file
+
+    std::cout << "--- pooled\n";
+    ResourcePool::reserve(1); // constructed once, up front
+    usePooledResource();
+    try {
+        usePooledResourceWithException();
+    } catch (const std::exception& e) {
+        std::cout << "Caught exception: " << e.what() << '\n';
+    }
+    {
+        PooledResourceManager first;  // hit: the reserved Resource
+        PooledResourceManager second; // miss: pool is empty, new Resource
+        PooledResourceManager moved = std::move(second);
+        moved.get()->sayHello();
+    } // both go back; second's moved-from manager returns nothing
+    printPoolStats();
+} // idle Resources are destroyed when the main thread's pool is destroyed at exit
@@ -0,0 +1,97 @@
+#include "resource_pool.h"
+
+#include <vector>
+
+namespace {
+    // Set once the thread's pool has been destroyed, so managers that die
+    // later during thread exit bypass it. Trivially destructible on purpose.
+    thread_local bool poolGone = false;
+
+    struct LocalPool {
+        std::vector<Resource*> idle;
+        std::size_t capacity = ResourcePool::kDefaultCapacity;
+        ResourcePool::Stats stats;
+
+        // Room for `capacity` pointers up front, so release() never allocates.
+        LocalPool() {
+            idle.reserve(capacity);
+        }
+
+        ~LocalPool() {
+            for (Resource* resource : idle) {
+                delete resource;
+            }
+            poolGone = true;
+        }
+    };
+
+    thread_local LocalPool localPool;
+} // namespace
+
+Resource* ResourcePool::acquire() {
+    if (poolGone) {
+        return new Resource();
+    }
+    LocalPool& pool = localPool; // one trip through the thread_local wrapper
+    if (!pool.idle.empty()) {
+        Resource* resource = pool.idle.back();
+        pool.idle.pop_back();
+        ++pool.stats.hits;
+        return resource;
+    }
+    ++pool.stats.misses;
+    return new Resource();
+}
+
+void ResourcePool::release(Resource* resource) noexcept {
+    if (resource == nullptr) {
+        return;
+    }
+    if (poolGone) {
+        delete resource;
+        return;
+    }
+    LocalPool& pool = localPool;
+    if (pool.idle.size() >= pool.capacity) {
+        ++pool.stats.dropped;
+        delete resource;
+        return;
+    }
+    pool.idle.push_back(resource);
+    ++pool.stats.recycled;
+}
+
+void ResourcePool::reserve(std::size_t count) {
+    if (poolGone) {
+        return;
+    }
+    LocalPool& pool = localPool;
+    while (pool.idle.size() < count && pool.idle.size() < pool.capacity) {
+        pool.idle.push_back(new Resource());
+    }
+}
+
+void ResourcePool::setCapacity(std::size_t capacity) {
+    if (poolGone) {
+        return;
+    }
+    LocalPool& pool = localPool;
+    while (pool.idle.size() > capacity) {
+        delete pool.idle.back();
+        pool.idle.pop_back();
+    }
+    pool.idle.reserve(capacity);
+    pool.capacity = capacity;
+}
+
+std::size_t ResourcePool::available() {
+    return poolGone ? 0 : localPool.idle.size();
+}
+
+std::size_t ResourcePool::capacity() {
+    return poolGone ? 0 : localPool.capacity;
+}
+
+ResourcePool::Stats ResourcePool::threadStats() {
+    return poolGone ? Stats{} : localPool.stats;
+}
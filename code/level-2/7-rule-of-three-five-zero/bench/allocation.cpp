@@ -0,0 +1,124 @@
+// Allocation microbenchmark for the DynamicBuffer allocator policies.
+//
+// Usage: level-2_7-rule-of-three-five-zero_allocation [requests_per_thread] [threads] [max_size]
+//
+// Each "request" creates a batch of buffers with mixed sizes (16 .. max_size
+// bytes), copies a few of them, and then destroys the whole batch, the way a
+// server handling one message at a time churns through scratch buffers. The
+// same size sequence is replayed for every policy:
+//
+//   new[]  - NewDeleteAllocator, the original DynamicBuffer
+//   pool   - PoolAllocator, thread-local size-class free lists
+//   arena  - ArenaAllocator, one MonotonicArena per thread, released per request
+
+#include "dynamic_buffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr std::size_t kBatch = 64;
+
+    std::vector<std::size_t> makeSizes(std::size_t count, std::size_t maxSize, unsigned seed) {
+        // Mostly small buffers with a long tail, like real message sizes.
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> exponent(4.0, std::log2(static_cast<double>(maxSize)));
+        std::vector<std::size_t> sizes(count);
+        for (auto& size : sizes) {
+            size = static_cast<std::size_t>(std::exp2(exponent(rng)));
+        }
+        return sizes;
+    }
+
+    // Runs `requests` requests per thread. setup() creates a per-thread context
+    // whose make(size) builds one buffer and whose endRequest() runs after each
+    // batch is destroyed. Returns ns per buffer.
+    template <typename Buffer, typename Setup>
+    double run(unsigned threads, long requests, std::size_t maxSize, Setup setup) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([=] {
+                const std::vector<std::size_t> sizes = makeSizes(kBatch * 16, maxSize, 42 + t);
+                auto context = setup();
+                std::vector<Buffer> batch;
+                batch.reserve(kBatch + kBatch / 8);
+                std::size_t next = 0;
+                for (long r = 0; r < requests; ++r) {
+                    for (std::size_t i = 0; i < kBatch; ++i) {
+                        batch.push_back(context.make(sizes[next]));
+                        next = (next + 1) % sizes.size();
+                    }
+                    for (std::size_t i = 0; i < kBatch; i += 8) {
+                        batch.push_back(batch[i]); // copy constructor
+                    }
+                    batch.clear();
+                    context.endRequest();
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        const double buffers = static_cast<double>(requests) * static_cast<double>(kBatch + kBatch / 8) * threads;
+        return elapsed.count() / buffers;
+    }
+
+    struct NewDeleteContext {
+        DynamicBuffer make(std::size_t size) {
+            return DynamicBuffer(size);
+        }
+        void endRequest() {}
+    };
+
+    struct PoolContext {
+        PooledDynamicBuffer make(std::size_t size) {
+            return PooledDynamicBuffer(size);
+        }
+        void endRequest() {}
+    };
+
+    struct ArenaContext {
+        std::unique_ptr<MonotonicArena> arena = std::make_unique<MonotonicArena>();
+
+        ArenaDynamicBuffer make(std::size_t size) {
+            return ArenaDynamicBuffer(size, ArenaAllocator(*arena));
+        }
+        void endRequest() {
+            arena->release();
+        }
+    };
+} // namespace
+
+int main(int argc, char** argv) {
+    const long requests = argc > 1 ? std::atol(argv[1]) : 20'000;
+    const unsigned threads = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t maxSize = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 4096;
+
+    if (requests <= 0 || threads == 0 || maxSize < 16) {
+        std::fprintf(stderr, "requests and threads must be positive, max_size at least 16\n");
+        return 1;
+    }
+    traceDynamicBuffer = false;
+
+    std::printf("%ld requests x %zu buffers per thread, %u threads, sizes 16..%zu bytes\n\n",
+                requests, kBatch + kBatch / 8, threads, maxSize);
+    std::printf("%-8s %12s %10s\n", "policy", "ns/buffer", "speedup");
+
+    const double baseline = run<DynamicBuffer>(threads, requests, maxSize, [] { return NewDeleteContext{}; });
+    const double pool = run<PooledDynamicBuffer>(threads, requests, maxSize, [] { return PoolContext{}; });
+    const double arena = run<ArenaDynamicBuffer>(threads, requests, maxSize, [] { return ArenaContext{}; });
+
+    std::printf("%-8s %12.1f %9.2fx\n", "new[]", baseline, 1.0);
+    std::printf("%-8s %12.1f %9.2fx\n", "pool", pool, baseline / pool);
+    std::printf("%-8s %12.1f %9.2fx\n", "arena", arena, baseline / arena);
+    return 0;
+}
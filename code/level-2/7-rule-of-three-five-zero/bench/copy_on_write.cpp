@@ -0,0 +1,101 @@
+// Fan-out copies of one large buffer: deep copies vs copy-on-write.
+//
+// Usage: level-2_7-rule-of-three-five-zero_copy_on_write [buffer_bytes] [copies] [threads] [write_every]
+//
+// Every thread makes `copies` copies of a shared source buffer and writes to
+// every write_every-th copy (0 = never), which forces a copy-on-write buffer
+// to duplicate. The source must come out unchanged.
+//
+// Before that, one copy-on-write buffer with alignment 1 is made from an arena
+// whose cursor sits on an odd byte: its reference count must still be aligned.
+
+#include "dynamic_buffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+    // The reference count sits right in front of a copy-on-write buffer's
+    // bytes, so with alignment 1 those bytes must still land where an atomic
+    // count can go before them.
+    bool weakAlignmentIsSafe() {
+        MonotonicArena arena;
+        arena.allocate(1, 1); // leaves the cursor on an odd address
+        ArenaDynamicBuffer buffer(3, BufferOptions{.storage = BufferStorage::CopyOnWrite, .alignment = 1},
+                                  ArenaAllocator(arena));
+        ArenaDynamicBuffer copy = buffer;
+        const auto address = reinterpret_cast<std::uintptr_t>(copy.bytes());
+        return copy.useCount() == 2 && address % alignof(std::atomic<std::size_t>) == 0;
+    }
+
+    // Returns ns per copy; sets `corrupted` if a write leaked into the source.
+    double run(BufferStorage storage, std::size_t bytes, long copies, unsigned threads, long writeEvery, bool& corrupted) {
+        DynamicBuffer source(bytes, storage);
+        source.mutableBytes()[0] = 's';
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                std::vector<DynamicBuffer> kept;
+                kept.reserve(64);
+                for (long i = 0; i < copies; ++i) {
+                    kept.push_back(source);
+                    if (writeEvery > 0 && i % writeEvery == 0) {
+                        kept.back().mutableBytes()[0] = 'w';
+                    }
+                    if (kept.size() == 64) {
+                        kept.clear(); // readers come and go
+                    }
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+        corrupted = corrupted || source.bytes()[0] != 's' || source.useCount() != 1;
+        return elapsed.count() / (static_cast<double>(copies) * threads);
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t bytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1 << 20;
+    const long copies = argc > 2 ? std::atol(argv[2]) : 20'000;
+    const unsigned threads = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3])) : std::max(1u, std::thread::hardware_concurrency());
+    const long writeEvery = argc > 4 ? std::atol(argv[4]) : 0;
+
+    if (bytes == 0 || copies <= 0 || threads == 0 || writeEvery < 0) {
+        std::fprintf(stderr, "buffer_bytes, copies and threads must be positive\n");
+        return 1;
+    }
+    traceDynamicBuffer = false;
+
+    if (!weakAlignmentIsSafe()) {
+        std::fprintf(stderr, "FAILED: a copy-on-write block with alignment 1 misaligned its reference count\n");
+        return 1;
+    }
+
+    std::printf("%zu-byte buffer, %ld copies per thread, %u threads, write every %ld\n\n", bytes, copies, threads, writeEvery);
+    std::printf("%-14s %12s %10s\n", "storage", "ns/copy", "speedup");
+
+    bool corrupted = false;
+    const double deep = run(BufferStorage::Deep, bytes, copies, threads, writeEvery, corrupted);
+    const double cow = run(BufferStorage::CopyOnWrite, bytes, copies, threads, writeEvery, corrupted);
+
+    std::printf("%-14s %12.1f %9.2fx\n", "deep", deep, 1.0);
+    std::printf("%-14s %12.1f %9.2fx\n", "copy-on-write", cow, deep / cow);
+
+    if (corrupted) {
+        std::fprintf(stderr, "FAILED: a write to a copy changed the source\n");
+        return 1;
+    }
+    return 0;
+}
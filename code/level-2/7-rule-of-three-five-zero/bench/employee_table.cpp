@@ -0,0 +1,132 @@
+// One million employees as std::vector<Employee> versus EmployeeTable:
+// heap blocks and bytes per employee, build time, and a full scan.
+//
+// Usage: level-2_7-rule-of-three-five-zero_employee_table [employees] [skills_per_employee] [distinct_skills]
+//
+// Names are "Employee number <n>" (past the std::string inline buffer, as
+// most real names with a surname are). Each employee gets
+// skills_per_employee skills drawn from distinct_skills names such as
+// "skill-7". The scan counts employees listing "skill-0": string compares
+// over scattered heap blocks for the vector, one integer column for the
+// table. Both must find the same count.
+//
+// Heap figures come from the instrumentation hooks and are requested
+// bytes; malloc adds its own 8-16 bytes of overhead per block on top.
+
+#include "instrumentation.h"
+
+#include "employee.h"
+#include "employee_table.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+    struct Timer {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        double ms() const {
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            return elapsed.count();
+        }
+    };
+
+    void row(const char* layout, std::size_t employees, const instrumentation::Cost& cost, double buildMs, double scanMs) {
+        std::printf("%-24s %12.2f %14.1f %10.1f %10.2f\n", layout, static_cast<double>(cost.allocations) / employees,
+                    static_cast<double>(cost.allocatedBytes) / employees, buildMs, scanMs);
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t employees = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    const std::size_t perEmployee = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 3;
+    const std::size_t distinct = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 50;
+
+    if (employees == 0 || distinct == 0) {
+        std::fprintf(stderr, "employees and distinct_skills must be positive\n");
+        return 1;
+    }
+    traceEmployee = false;
+
+    std::vector<std::string> skillNames;
+    for (std::size_t i = 0; i < distinct; ++i) {
+        skillNames.push_back("skill-" + std::to_string(i));
+    }
+    auto skillOf = [&](std::size_t employee, std::size_t k) -> const std::string& {
+        return skillNames[(employee * 7 + k * 13) % distinct];
+    };
+    char name[48];
+    auto nameOf = [&](std::size_t employee) {
+        const int length = std::snprintf(name, sizeof(name), "Employee number %zu", employee);
+        return std::string_view(name, static_cast<std::size_t>(length));
+    };
+
+    std::printf("%zu employees, %zu skills each out of %zu\n\n", employees, perEmployee, distinct);
+    std::printf("%-24s %12s %14s %10s %10s\n", "layout", "blocks/emp", "heap B/emp", "build ms", "scan ms");
+
+    instrumentation::CostTable totals;
+    std::size_t vectorCount = 0;
+    {
+        std::vector<Employee> people;
+        instrumentation::Cost cost;
+        double buildMs = 0;
+        {
+            instrumentation::AllocationScope scope("std::vector<Employee> build", totals);
+            Timer timer;
+            people.reserve(employees);
+            for (std::size_t i = 0; i < employees; ++i) {
+                people.emplace_back(std::string(nameOf(i)), static_cast<int>(i));
+                for (std::size_t k = 0; k < perEmployee; ++k) {
+                    people.back().addSkill(skillOf(i, k));
+                }
+            }
+            buildMs = timer.ms();
+            cost = scope.cost();
+        }
+        Timer scan;
+        for (const Employee& employee : people) {
+            const std::vector<std::string>& skills = employee.getSkills();
+            vectorCount += std::find(skills.begin(), skills.end(), skillNames[0]) != skills.end() ? 1 : 0;
+        }
+        row("std::vector<Employee>", employees, cost, buildMs, scan.ms());
+    }
+
+    std::size_t tableCount = 0;
+    {
+        EmployeeTable table;
+        instrumentation::Cost cost;
+        double buildMs = 0;
+        std::vector<std::string_view> skills(perEmployee);
+        {
+            instrumentation::AllocationScope scope("EmployeeTable build", totals);
+            Timer timer;
+            table.reserve(employees, employees * 22, employees * perEmployee);
+            for (std::size_t i = 0; i < employees; ++i) {
+                for (std::size_t k = 0; k < perEmployee; ++k) {
+                    skills[k] = skillOf(i, k);
+                }
+                table.append(static_cast<int>(i), nameOf(i), skills);
+            }
+            buildMs = timer.ms();
+            cost = scope.cost();
+        }
+        Timer scan;
+        tableCount = table.countWithSkill(skillNames[0]);
+        row("EmployeeTable", employees, cost, buildMs, scan.ms());
+        std::printf("%-24s %12s %14.1f   (memoryBytes(), capacity included)\n", "", "", static_cast<double>(table.memoryBytes()) / employees);
+    }
+
+    std::printf("\n");
+    totals.print();
+
+    if (vectorCount != tableCount) {
+        std::fprintf(stderr, "FAILED: scan found %zu employees in the vector, %zu in the table\n", vectorCount, tableCount);
+        return 1;
+    }
+    return 0;
+}
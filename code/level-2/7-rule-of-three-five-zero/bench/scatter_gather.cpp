@@ -0,0 +1,119 @@
+// Sending a message made of many fragments: concatenate + write, one write
+// per fragment, or a single writev over a BufferChain.
+//
+// Usage: level-2_7-rule-of-three-five-zero_scatter_gather [messages] [fragments] [fragment_bytes]
+//
+// Each message is a chain of `fragments` zero-copy slices of one large
+// payload buffer. Messages go to an unlinked temporary file that is rewound
+// every 256 messages, so the page cache absorbs the writes.
+
+#include "buffer_chain.h"
+
+#include <cstdio>
+
+#if defined(_WIN32)
+int main() {
+    std::printf("writev/readv are not available on this platform\n");
+    return 0;
+}
+#else
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+    template <typename Fn>
+    double nsPerMessage(long messages, int fd, Fn send) {
+        auto start = std::chrono::steady_clock::now();
+        for (long i = 0; i < messages; ++i) {
+            if (i % 256 == 0) {
+                ::lseek(fd, 0, SEEK_SET);
+            }
+            send();
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / static_cast<double>(messages);
+    }
+
+    bool writeFully(int fd, const char* bytes, std::size_t length) {
+        while (length > 0) {
+            ssize_t written = ::write(fd, bytes, length);
+            if (written < 0) {
+                return false;
+            }
+            bytes += written;
+            length -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    const long messages = argc > 1 ? std::atol(argv[1]) : 50'000;
+    const std::size_t fragments = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16;
+    const std::size_t fragmentBytes = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1024;
+
+    if (messages <= 0 || fragments == 0 || fragmentBytes == 0) {
+        std::fprintf(stderr, "messages, fragments and fragment_bytes must be positive\n");
+        return 1;
+    }
+    traceDynamicBuffer = false;
+
+    std::FILE* file = std::tmpfile();
+    if (file == nullptr) {
+        std::perror("tmpfile");
+        return 1;
+    }
+    const int fd = ::fileno(file);
+
+    DynamicBuffer payload(fragments * fragmentBytes, BufferStorage::CopyOnWrite);
+    char* bytes = payload.mutableBytes();
+    for (std::size_t i = 0; i < payload.length(); ++i) {
+        bytes[i] = static_cast<char>('a' + i % 26);
+    }
+    BufferChain chain;
+    for (std::size_t i = 0; i < fragments; ++i) {
+        chain.append(payload.slice(i * fragmentBytes, fragmentBytes));
+    }
+
+    // Correctness: writev must produce exactly the concatenated bytes.
+    int status = 0;
+    {
+        DynamicBuffer flat = chain.flatten();
+        DynamicBuffer readBack(flat.length());
+        ::lseek(fd, 0, SEEK_SET);
+        if (!writeChain(fd, chain) || ::pread(fd, readBack.mutableBytes(), readBack.length(), 0) != static_cast<ssize_t>(flat.length())
+            || std::memcmp(flat.bytes(), readBack.bytes(), flat.length()) != 0) {
+            std::fprintf(stderr, "FAILED: writev output differs from the concatenation\n");
+            status = 1;
+        }
+    }
+
+    std::printf("%ld messages of %zu x %zu-byte fragments\n\n", messages, fragments, fragmentBytes);
+    std::printf("%-20s %12s\n", "method", "ns/message");
+
+    bool ok = true;
+    const double copy = nsPerMessage(messages, fd, [&] {
+        DynamicBuffer flat = chain.flatten();
+        ok = writeFully(fd, flat.bytes(), flat.length()) && ok;
+    });
+    const double perFragment = nsPerMessage(messages, fd, [&] {
+        for (const iovec& piece : chain.iovecs()) {
+            ok = writeFully(fd, static_cast<const char*>(piece.iov_base), piece.iov_len) && ok;
+        }
+    });
+    const double gather = nsPerMessage(messages, fd, [&] { ok = writeChain(fd, chain) && ok; });
+
+    std::printf("%-20s %12.0f\n", "concatenate + write", copy);
+    std::printf("%-20s %12.0f\n", "write per fragment", perFragment);
+    std::printf("%-20s %12.0f\n", "writev (chain)", gather);
+
+    std::fclose(file);
+    if (!ok) {
+        std::perror("write");
+        return 1;
+    }
+    return status;
+}
+#endif
@@ -0,0 +1,152 @@
+// buffer_allocator.h - Allocator policies for DynamicBuffer
+#ifndef BUFFER_ALLOCATOR_H
+#define BUFFER_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// Alignments worth asking for: a cache line (SIMD loads, no false sharing)
+// and a page (O_DIRECT and DMA-style I/O).
+inline constexpr std::size_t kCacheLineAlignment = 64;
+inline constexpr std::size_t kPageAlignment = 4096;
+
+// What operator new already guarantees without an align_val_t.
+inline constexpr std::size_t kDefaultAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+// An allocator policy is a small copyable object with
+//
+//     char* allocate(std::size_t n, std::size_t alignment);
+//     void deallocate(char* p, std::size_t n, std::size_t alignment) noexcept; // p may be nullptr
+//
+// and optionally
+//
+//     bool tryExpand(char* p, std::size_t n, std::size_t newN, std::size_t alignment) noexcept;
+//
+// which grows a block in place if it can; afterwards the block counts as
+// allocated with newN bytes. deallocate always receives the same n and
+// alignment the block was allocated (or last expanded) with, so a policy
+// never has to store them itself. alignment is a power of two.
+
+// Plain new[] / delete[]: one malloc and one free per buffer. Over-aligned
+// requests use the aligned operator new[].
+struct NewDeleteAllocator {
+    char* allocate(std::size_t n, std::size_t alignment = kDefaultAlignment) {
+        if (alignment <= kDefaultAlignment) {
+            return new char[n];
+        }
+        return static_cast<char*>(::operator new[](n, std::align_val_t(alignment)));
+    }
+
+    void deallocate(char* p, std::size_t, std::size_t alignment = kDefaultAlignment) noexcept {
+        if (alignment <= kDefaultAlignment) {
+            delete[] p;
+        }
+        else {
+            ::operator delete[](p, std::align_val_t(alignment));
+        }
+    }
+};
+
+// ------------------------------------------------------------------------------
+// Size-class pool.
+//
+// Requests are rounded up to a power of two between 16 bytes and 64 KiB. Each
+// thread keeps one free list per size class, so a freed block is handed back
+// to the next allocation of the same class without touching malloc or any
+// lock. Blocks are still individually allocated with operator new, which
+// means a block may be freed on another thread than the one that allocated
+// it: it simply joins that thread's free list.
+//
+// Larger or over-aligned requests, and frees that would grow a list past its
+// cap, go straight to operator new / delete. The cached blocks of a thread
+// are released when the thread exits.
+//
+// Since a pooled block really holds a whole size class, tryExpand succeeds
+// whenever the new size still falls into the same class.
+// ------------------------------------------------------------------------------
+struct PoolAllocator {
+    static constexpr std::size_t kMinBlock = 16;
+    static constexpr std::size_t kMaxBlock = 64 * 1024;
+    static constexpr std::size_t kClassCount = 13; // 16, 32, ..., 64 KiB
+    static constexpr std::size_t kCachedBytesPerClass = 256 * 1024;
+
+    struct Stats {
+        std::uint64_t hits = 0;      // served from a free list
+        std::uint64_t misses = 0;    // size class was empty, went to operator new
+        std::uint64_t oversized = 0; // larger than kMaxBlock
+    };
+
+    char* allocate(std::size_t n, std::size_t alignment = kDefaultAlignment);
+    void deallocate(char* p, std::size_t n, std::size_t alignment = kDefaultAlignment) noexcept;
+    bool tryExpand(char* p, std::size_t n, std::size_t newN, std::size_t alignment = kDefaultAlignment) noexcept;
+
+    // Counters of the calling thread.
+    static Stats threadStats();
+};
+
+// ------------------------------------------------------------------------------
+// Monotonic arena for request-scoped buffers.
+//
+// allocate() bumps a pointer inside the current chunk and never frees
+// anything individually; release() drops everything at once and keeps the
+// largest chunk for the next round. Not thread-safe: use one arena per thread
+// or per request. Same idea as std::pmr::monotonic_buffer_resource.
+// ------------------------------------------------------------------------------
+class MonotonicArena {
+private:
+    struct Chunk {
+        Chunk* next;
+        std::size_t capacity; // usable bytes after the header
+    };
+
+    Chunk* chunks = nullptr; // newest first
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    std::size_t nextChunkSize;
+    std::size_t bytesUsed = 0;
+
+    void addChunk(std::size_t minBytes);
+
+public:
+    explicit MonotonicArena(std::size_t initialChunkSize = 64 * 1024);
+    ~MonotonicArena();
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    char* allocate(std::size_t n, std::size_t alignment = alignof(std::max_align_t));
+
+    // Grows the most recent allocation in place if the chunk has room.
+    bool tryExpand(char* p, std::size_t n, std::size_t newN) noexcept;
+
+    // Invalidates every pointer handed out so far.
+    void release() noexcept;
+
+    // Bytes handed out since the last release().
+    std::size_t used() const {
+        return bytesUsed;
+    }
+};
+
+// Policy that draws from a MonotonicArena. Freeing a buffer is a no-op; the
+// memory comes back when the arena is released, so every buffer using it must
+// be gone (or never touched again) by then.
+struct ArenaAllocator {
+    MonotonicArena* arena;
+
+    explicit ArenaAllocator(MonotonicArena& a)
+        : arena(&a) {}
+
+    char* allocate(std::size_t n, std::size_t alignment = kDefaultAlignment) {
+        return arena->allocate(n, alignment);
+    }
+
+    void deallocate(char*, std::size_t, std::size_t = kDefaultAlignment) noexcept {}
+
+    bool tryExpand(char* p, std::size_t n, std::size_t newN, std::size_t = kDefaultAlignment) noexcept {
+        return arena->tryExpand(p, n, newN);
+    }
+};
+
+#endif // BUFFER_ALLOCATOR_H
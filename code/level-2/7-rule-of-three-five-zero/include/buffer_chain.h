@@ -0,0 +1,137 @@
+// buffer_chain.h - Scatter/gather chain of DynamicBuffers and BufferViews
+#ifndef BUFFER_CHAIN_H
+#define BUFFER_CHAIN_H
+
+#include "dynamic_buffer.h"
+
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#if defined(_WIN32)
+// Same layout as the POSIX struct, so iovecs() works everywhere; only the
+// readv/writev helpers below are POSIX-only.
+struct iovec {
+    void* iov_base;
+    size_t iov_len;
+};
+#else
+#include <sys/uio.h>
+#endif
+
+// Links several fragments without concatenating them. A fragment is either a
+// buffer the chain owns (writable, e.g. for readv to fill) or a BufferView
+// (read-only, pinned, e.g. a header slice shared by many messages).
+// iovecs() describes the fragments in order for writev / readv.
+template <typename Allocator = NewDeleteAllocator>
+class BasicBufferChain {
+private:
+    using Buffer = BasicDynamicBuffer<Allocator>;
+    using View = BasicBufferView<Allocator>;
+
+    std::vector<std::variant<Buffer, View>> fragments;
+    size_t total = 0;
+
+public:
+    void append(Buffer&& buffer) {
+        total += buffer.length();
+        fragments.emplace_back(std::in_place_type<Buffer>, std::move(buffer));
+    }
+
+    void append(View view) {
+        total += view.size();
+        fragments.emplace_back(std::in_place_type<View>, std::move(view));
+    }
+
+    void clear() {
+        fragments.clear();
+        total = 0;
+    }
+
+    // Number of fragments.
+    size_t count() const {
+        return fragments.size();
+    }
+
+    // Total bytes over all fragments.
+    size_t size() const {
+        return total;
+    }
+
+    // Gather list for writev. The iovecs point into the chain and are valid
+    // until it changes; iov_base is only non-const because struct iovec says so.
+    std::vector<iovec> iovecs() const {
+        std::vector<iovec> result;
+        result.reserve(fragments.size());
+        for (const auto& fragment : fragments) {
+            const char* bytes = nullptr;
+            size_t length = 0;
+            if (const auto* buffer = std::get_if<Buffer>(&fragment)) {
+                bytes = buffer->bytes();
+                length = buffer->length();
+            }
+            else {
+                const auto& view = std::get<View>(fragment);
+                bytes = view.data();
+                length = view.size();
+            }
+            result.push_back(iovec{const_cast<char*>(bytes), length});
+        }
+        return result;
+    }
+
+    // Scatter list for readv. Only owned buffers can be filled, so a chain
+    // holding a view throws std::logic_error.
+    std::vector<iovec> writableIovecs() {
+        std::vector<iovec> result;
+        result.reserve(fragments.size());
+        for (auto& fragment : fragments) {
+            auto* buffer = std::get_if<Buffer>(&fragment);
+            if (buffer == nullptr) {
+                throw std::logic_error("BufferChain: views are read-only, cannot read into them");
+            }
+            result.push_back(iovec{buffer->mutableBytes(), buffer->length()});
+        }
+        return result;
+    }
+
+    // Copies every fragment into one buffer: the step writev saves.
+    Buffer flatten() const {
+        Buffer flat(total, BufferOptions{.init = BufferInit::Uninitialized});
+        char* out = flat.mutableBytes();
+        for (const iovec& piece : iovecs()) {
+            if (piece.iov_len != 0) {
+                std::memcpy(out, piece.iov_base, piece.iov_len);
+                out += piece.iov_len;
+            }
+        }
+        return flat;
+    }
+};
+
+using BufferChain = BasicBufferChain<>;
+
+#if !defined(_WIN32)
+// Writes every byte described by iov to fd with writev, retrying after
+// partial writes and splitting lists longer than IOV_MAX. Returns false on
+// error (errno is set).
+bool writeAll(int fd, std::vector<iovec> iov);
+
+// One readv into iov. Returns the number of bytes read, 0 at end of file, or
+// -1 on error (errno is set).
+long readSome(int fd, const std::vector<iovec>& iov);
+
+template <typename Allocator>
+bool writeChain(int fd, const BasicBufferChain<Allocator>& chain) {
+    return writeAll(fd, chain.iovecs());
+}
+
+template <typename Allocator>
+long readChain(int fd, BasicBufferChain<Allocator>& chain) {
+    return readSome(fd, chain.writableIovecs());
+}
+#endif
+
+#endif // BUFFER_CHAIN_H
@@ -0,0 +1,503 @@
+// dynamic_buffer.h - Rule of Five buffer with a pluggable allocator policy, and views into it
+#ifndef DYNAMIC_BUFFER_H
+#define DYNAMIC_BUFFER_H
+
+#include "buffer_allocator.h"
+#include "instrumentation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Prints every special member call. Benchmarks turn it off.
+inline bool traceDynamicBuffer = true;
+
+enum class BufferStorage {
+    Deep,        // every copy gets its own bytes (the default)
+    CopyOnWrite, // copies share one reference-counted block until written to
+};
+
+enum class BufferInit {
+    Zeroed,        // memset to 0, like the original DynamicBuffer
+    Uninitialized, // for buffers that are about to be overwritten anyway
+};
+
+template <typename Allocator>
+class BasicBufferView;
+
+// Designated initializers read well here:
+//     DynamicBuffer io(8 << 20, {.init = BufferInit::Uninitialized, .alignment = kPageAlignment});
+struct BufferOptions {
+    BufferStorage storage = BufferStorage::Deep;
+    BufferInit init = BufferInit::Zeroed;
+    size_t alignment = kDefaultAlignment; // power of two
+};
+
+// RULE OF FIVE: Low-level RAII wrapper for dynamic array
+//
+// Where the bytes come from is decided by the Allocator policy (see
+// buffer_allocator.h). Copies use the allocator of the source, copy
+// assignment keeps the target's own, and moves take the allocator along with
+// the pointer, since only that allocator can free it.
+//
+// Copy-on-write (opt-in, BufferStorage::CopyOnWrite): the block starts with an
+// atomic reference count and copies just bump it, so fanning one large buffer
+// out to many readers costs O(1) per copy. mutableBytes() duplicates the block
+// first if it is still shared. Sharing copies also share the allocator, so a
+// shared copy assignment adopts the source's allocator like a move does.
+//
+// Growth: reserve() / resize() grow the capacity geometrically. If the
+// allocator has tryExpand (pool: same size class, arena: last allocation) the
+// block grows in place without copying; otherwise the bytes move to a new one.
+//
+// Slices: slice() hands out BufferViews that pin the block through the same
+// reference count, so they stay valid after the buffer is written to, moved
+// or destroyed. A Deep buffer switches to copy-on-write storage on its first
+// slice (one copy); create it as CopyOnWrite to avoid even that.
+template <typename Allocator = NewDeleteAllocator>
+class BasicDynamicBuffer {
+private:
+    friend class BasicBufferView<Allocator>;
+
+    // Sits right in front of the bytes of a copy-on-write block.
+    struct SharedHeader {
+        std::atomic<size_t> refs;
+    };
+
+    [[no_unique_address]] Allocator alloc;
+    char* data = nullptr;
+    size_t size;
+    size_t allocated;    // capacity of the block in bytes
+    size_t alignment;    // passed to every allocator call for this block (see sharedAlignment)
+    bool shared = false; // data is preceded by a SharedHeader
+
+    static size_t checkedAlignment(size_t alignment) {
+        if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+            throw std::invalid_argument("DynamicBuffer: alignment must be a power of two");
+        }
+        return alignment;
+    }
+
+    // A copy-on-write block is aligned for its header as well, even when
+    // the caller asked for less (alignment 1 from an arena, say).
+    static size_t sharedAlignment(size_t alignment) {
+        return std::max(alignment, alignof(SharedHeader));
+    }
+
+    // Room in front of a copy-on-write block: the header, padded so the
+    // bytes keep the block's alignment.
+    static size_t headerBytes(size_t alignment) {
+        const size_t blockAlignment = sharedAlignment(alignment);
+        return (sizeof(SharedHeader) + blockAlignment - 1) / blockAlignment * blockAlignment;
+    }
+
+    static SharedHeader* headerOf(char* bytes) {
+        return std::launder(reinterpret_cast<SharedHeader*>(bytes - sizeof(SharedHeader)));
+    }
+
+    char* allocateBlock(size_t n, bool copyOnWrite) {
+        if (!copyOnWrite) {
+            return alloc.allocate(n, alignment);
+        }
+        char* bytes = alloc.allocate(headerBytes(alignment) + n, sharedAlignment(alignment)) + headerBytes(alignment);
+        ::new (bytes - sizeof(SharedHeader)) SharedHeader{1};
+        return bytes;
+    }
+
+    // Drops one owner of a copy-on-write block; the last one frees it.
+    static void releaseShared(Allocator& alloc, char* bytes, size_t allocated, size_t alignment) noexcept {
+        SharedHeader* header = headerOf(bytes);
+        // acq_rel: the last owner must see every write made before the
+        // other owners let go.
+        if (header->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            header->~SharedHeader();
+            alloc.deallocate(bytes - headerBytes(alignment), headerBytes(alignment) + allocated, sharedAlignment(alignment));
+        }
+    }
+
+    void releaseBlock() noexcept {
+        if (shared) {
+            releaseShared(alloc, data, allocated, alignment);
+        }
+        else {
+            alloc.deallocate(data, allocated, alignment);
+        }
+    }
+
+    // Adds an owner to a copy-on-write block.
+    static char* pin(char* bytes) {
+        headerOf(bytes)->refs.fetch_add(1, std::memory_order_relaxed);
+        return bytes;
+    }
+
+    char* share() const {
+        return pin(data);
+    }
+
+    // Gives a shared block a private copy before the first write.
+    void unshare() {
+        if (shared && headerOf(data)->refs.load(std::memory_order_acquire) != 1) {
+            char* fresh = allocateBlock(allocated, true);
+            std::memcpy(fresh, data, size);
+            releaseBlock();
+            data = fresh;
+            counters().copied(size); // the copy that copy-on-write deferred
+            trace("Copy-on-write: duplicated ", size);
+        }
+    }
+
+    bool expandInPlace(size_t capacity) {
+        if constexpr (requires(Allocator& a, char* p, size_t n) { a.tryExpand(p, n, n, n); }) {
+            return !shared && data != nullptr && alloc.tryExpand(data, allocated, capacity, alignment);
+        }
+        else {
+            return false;
+        }
+    }
+
+    // Grows to `preferred` bytes, or at least to `minimum` if only that
+    // fits in place; a new block always gets `preferred`.
+    void regrow(size_t minimum, size_t preferred) {
+        for (size_t capacity : {preferred, minimum}) {
+            if (expandInPlace(capacity)) {
+                allocated = capacity;
+                trace("Grow: expanded in place to ", allocated);
+                return;
+            }
+        }
+        const size_t capacity = preferred;
+        char* fresh = allocateBlock(capacity, shared);
+        if (size != 0) {
+            std::memcpy(fresh, data, size);
+        }
+        releaseBlock();
+        data = fresh;
+        allocated = capacity;
+        trace("Grow: reallocated to ", allocated);
+    }
+
+    // Every allocator policy reports as one "DynamicBuffer" row.
+    static instrumentation::TypeCounters& counters() {
+        static instrumentation::TypeCounters& all = instrumentation::typeCounters("DynamicBuffer");
+        return all;
+    }
+
+    static void trace(const char* message, size_t bytes) {
+        if (traceDynamicBuffer) {
+            std::cout << "[RuleOfFive] " << message << bytes << " bytes\n";
+        }
+    }
+
+    static void trace(const char* message) {
+        if (traceDynamicBuffer) {
+            std::cout << "[RuleOfFive] " << message << "\n";
+        }
+    }
+
+public:
+    // Constructor
+    BasicDynamicBuffer(size_t sz, Allocator a = Allocator())
+        : BasicDynamicBuffer(sz, BufferOptions{}, a) {}
+
+    BasicDynamicBuffer(size_t sz, BufferStorage storage, Allocator a = Allocator())
+        : BasicDynamicBuffer(sz, BufferOptions{storage}, a) {}
+
+    BasicDynamicBuffer(size_t sz, BufferOptions options, Allocator a = Allocator())
+        : alloc(a)
+        , size(sz)
+        , allocated(sz)
+        , alignment(checkedAlignment(options.alignment))
+        , shared(options.storage == BufferStorage::CopyOnWrite) {
+        data = allocateBlock(allocated, shared);
+        if (options.init == BufferInit::Zeroed) {
+            std::memset(data, 0, size);
+            trace("Constructor: allocated ", size);
+        }
+        else {
+            trace("Constructor: allocated (uninitialized) ", size);
+        }
+    }
+
+    // Destructor
+    ~BasicDynamicBuffer() {
+        releaseBlock();
+        trace("Destructor: freed ", size);
+    }
+
+    // Copy Constructor (Deep Copy, or a shared reference in copy-on-write mode)
+    BasicDynamicBuffer(const BasicDynamicBuffer& other)
+        : alloc(other.alloc)
+        , size(other.size)
+        , allocated(other.shared ? other.allocated : other.size)
+        , alignment(other.alignment)
+        , shared(other.shared) {
+        if (shared) {
+            data = other.share();
+            counters().copied(0);
+            trace("Copy Constructor: shared ", size);
+            return;
+        }
+        data = allocateBlock(allocated, false);
+        std::memcpy(data, other.data, size);
+        counters().copied(size);
+        trace("Copy Constructor: copied ", size);
+    }
+
+    // Copy Assignment Operator (Deep Copy, or a shared reference in copy-on-write mode)
+    BasicDynamicBuffer& operator=(const BasicDynamicBuffer& other) {
+        if (this != &other) {
+            if (other.shared) {
+                other.share(); // before releaseBlock(), in case both share the block
+                releaseBlock();
+                alloc = other.alloc;
+                data = other.data;
+                size = other.size;
+                allocated = other.allocated;
+                alignment = other.alignment;
+                shared = true;
+                counters().copied(0);
+                trace("Copy Assignment: shared ", size);
+                return *this;
+            }
+            // Allocate first so a throwing allocator leaves *this untouched.
+            char* copy = alloc.allocate(other.size, other.alignment);
+            std::memcpy(copy, other.data, other.size);
+            releaseBlock();
+            data = copy;
+            size = other.size;
+            allocated = other.size;
+            alignment = other.alignment;
+            shared = false;
+            counters().copied(size);
+            trace("Copy Assignment: copied ", size);
+        }
+        return *this;
+    }
+
+    // Move Constructor (Transfer Ownership)
+    BasicDynamicBuffer(BasicDynamicBuffer&& other) noexcept
+        : alloc(other.alloc)
+        , data(other.data)
+        , size(other.size)
+        , allocated(other.allocated)
+        , alignment(other.alignment)
+        , shared(other.shared) {
+        other.data = nullptr;
+        other.size = 0;
+        other.allocated = 0;
+        other.shared = false;
+        counters().moved(size);
+        trace("Move Constructor: transferred ownership");
+    }
+
+    // Move Assignment Operator (Transfer Ownership)
+    BasicDynamicBuffer& operator=(BasicDynamicBuffer&& other) noexcept {
+        if (this != &other) {
+            releaseBlock();
+            alloc = other.alloc;
+            data = other.data;
+            size = other.size;
+            allocated = other.allocated;
+            alignment = other.alignment;
+            shared = other.shared;
+            other.data = nullptr;
+            other.size = 0;
+            other.allocated = 0;
+            other.shared = false;
+            counters().moved(size);
+            trace("Move Assignment: transferred ownership");
+        }
+        return *this;
+    }
+
+    // Makes room for at least `capacity` bytes without changing length().
+    void reserve(size_t capacity) {
+        if (capacity > allocated) {
+            regrow(capacity, capacity);
+        }
+    }
+
+    // Changes length(), growing the capacity geometrically (at least 2x) when
+    // it runs out. New bytes are zeroed unless init says otherwise.
+    void resize(size_t n, BufferInit init = BufferInit::Zeroed) {
+        if (n > allocated) {
+            regrow(n, std::max(n, allocated * 2));
+        }
+        else {
+            unshare();
+        }
+        if (n > size && init == BufferInit::Zeroed) {
+            std::memset(data + size, 0, n - size);
+        }
+        size = n;
+    }
+
+    const char* bytes() const {
+        return data;
+    }
+
+    // Zero-copy, read-only view of [offset, offset + count) that keeps the
+    // bytes alive on its own. Throws std::out_of_range past the end.
+    BasicBufferView<Allocator> slice(size_t offset, size_t count);
+
+    BasicBufferView<Allocator> slice() {
+        return slice(0, size);
+    }
+
+    // Write access. A copy-on-write block that other buffers still share is
+    // duplicated first, so only this buffer sees the writes.
+    char* mutableBytes() {
+        unshare();
+        return data;
+    }
+
+    // Number of buffers sharing this one's bytes (1 unless copy-on-write).
+    size_t useCount() const {
+        return shared ? headerOf(data)->refs.load(std::memory_order_relaxed) : 1;
+    }
+
+    size_t length() const {
+        return size;
+    }
+
+    size_t capacity() const {
+        return allocated;
+    }
+};
+
+// Non-owning slice of a DynamicBuffer that pins the underlying copy-on-write
+// block: copying a view bumps the reference count, destroying the last view
+// (or buffer) frees the block. Views only read; writes through the buffer go
+// to a private copy once views exist, so a view never changes under a reader.
+// With an ArenaAllocator the arena's release() still ends every view.
+template <typename Allocator>
+class BasicBufferView {
+private:
+    using Buffer = BasicDynamicBuffer<Allocator>;
+
+    [[no_unique_address]] Allocator alloc;
+    char* block = nullptr; // start of the pinned block, nullptr for an empty view
+    size_t blockCapacity = 0;
+    size_t blockAlignment = 0;
+    const char* first = nullptr;
+    size_t count = 0;
+
+    friend class BasicDynamicBuffer<Allocator>;
+
+    // Takes over one reference to the block, which the caller has pinned.
+    BasicBufferView(const Allocator& a, char* pinned, size_t capacity, size_t alignment, const char* begin, size_t n)
+        : alloc(a)
+        , block(pinned)
+        , blockCapacity(capacity)
+        , blockAlignment(alignment)
+        , first(begin)
+        , count(n) {}
+
+    void unpin() noexcept {
+        if (block != nullptr) {
+            Buffer::releaseShared(alloc, block, blockCapacity, blockAlignment);
+            block = nullptr;
+        }
+    }
+
+public:
+    BasicBufferView() requires std::is_default_constructible_v<Allocator> = default;
+
+    BasicBufferView(const BasicBufferView& other)
+        : alloc(other.alloc)
+        , block(other.block != nullptr ? Buffer::pin(other.block) : nullptr)
+        , blockCapacity(other.blockCapacity)
+        , blockAlignment(other.blockAlignment)
+        , first(other.first)
+        , count(other.count) {}
+
+    BasicBufferView(BasicBufferView&& other) noexcept
+        : alloc(other.alloc)
+        , block(std::exchange(other.block, nullptr))
+        , blockCapacity(other.blockCapacity)
+        , blockAlignment(other.blockAlignment)
+        , first(std::exchange(other.first, nullptr))
+        , count(std::exchange(other.count, 0)) {}
+
+    BasicBufferView& operator=(BasicBufferView other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~BasicBufferView() {
+        unpin();
+    }
+
+    void swap(BasicBufferView& other) noexcept {
+        std::swap(alloc, other.alloc);
+        std::swap(block, other.block);
+        std::swap(blockCapacity, other.blockCapacity);
+        std::swap(blockAlignment, other.blockAlignment);
+        std::swap(first, other.first);
+        std::swap(count, other.count);
+    }
+
+    // A narrower view of the same block. Throws std::out_of_range past the end.
+    BasicBufferView subview(size_t offset, size_t n) const {
+        if (offset > count || n > count - offset) {
+            throw std::out_of_range("BufferView::subview: range past the end");
+        }
+        BasicBufferView view(*this);
+        view.first += offset;
+        view.count = n;
+        return view;
+    }
+
+    const char* data() const {
+        return first;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    std::span<const char> span() const {
+        return {first, count};
+    }
+};
+
+template <typename Allocator>
+BasicBufferView<Allocator> BasicDynamicBuffer<Allocator>::slice(size_t offset, size_t count) {
+    if (offset > size || count > size - offset) {
+        throw std::out_of_range("DynamicBuffer::slice: range past the end");
+    }
+    if (!shared) {
+        // One-time switch to a reference-counted block.
+        char* fresh = allocateBlock(allocated, true);
+        if (size != 0) {
+            std::memcpy(fresh, data, size);
+        }
+        releaseBlock();
+        data = fresh;
+        shared = true;
+        trace("Slice: switched to shared storage ", size);
+    }
+    return BasicBufferView<Allocator>(alloc, pin(data), allocated, alignment, data + offset, count);
+}
+
+using DynamicBuffer = BasicDynamicBuffer<>;
+using PooledDynamicBuffer = BasicDynamicBuffer<PoolAllocator>;
+using ArenaDynamicBuffer = BasicDynamicBuffer<ArenaAllocator>;
+
+using BufferView = BasicBufferView<NewDeleteAllocator>;
+using PooledBufferView = BasicBufferView<PoolAllocator>;
+using ArenaBufferView = BasicBufferView<ArenaAllocator>;
+
+#endif // DYNAMIC_BUFFER_H
@@ -0,0 +1,71 @@
+// employee.h - Rule of Zero record type, one heap-owning object per employee
+#ifndef EMPLOYEE_H
+#define EMPLOYEE_H
+
+#include "instrumentation.h"
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Prints a line per constructed Employee. Benchmarks turn it off.
+inline bool traceEmployee = true;
+
+// RULE OF ZERO: Modern C++ with RAII types
+class Employee {
+private:
+    std::string name;                // RAII type manages memory
+    int id;                          // Primitive type
+    std::vector<std::string> skills; // RAII type manages memory
+
+    // Counts the compiler-generated copies and moves. Empty, so it takes no
+    // space on GCC and Clang; MSVC ignores [[no_unique_address]] (it only
+    // honours [[msvc::no_unique_address]]) and gives it a byte plus padding.
+    [[no_unique_address]] instrumentation::Counted<Employee> counted;
+
+public:
+    static constexpr const char* kTypeName = "Employee";
+
+    Employee(std::string n, int empId)
+        : name(std::move(n))
+        , id(empId) {
+        if (traceEmployee) {
+            std::cout << "[RuleOfZero] Employee created: " << name << "\n";
+        }
+    }
+
+    // No destructor needed!
+    // No copy constructor needed!
+    // No copy assignment needed!
+    // No move constructor needed!
+    // No move assignment needed!
+    // Compiler generates all of them correctly!
+
+    void addSkill(const std::string& skill) {
+        skills.push_back(skill);
+    }
+
+    const std::string& getName() const {
+        return name;
+    }
+
+    int getId() const {
+        return id;
+    }
+
+    const std::vector<std::string>& getSkills() const {
+        return skills;
+    }
+
+    void display() const {
+        std::cout << "Employee: " << name << " (ID: " << id << ")\n";
+        std::cout << "Skills: ";
+        for (const auto& skill : skills) {
+            std::cout << skill << " ";
+        }
+        std::cout << "\n";
+    }
+};
+
+#endif // EMPLOYEE_H
@@ -0,0 +1,188 @@
+// employee_table.h - Column-oriented employee storage with interned skill names
+#ifndef EMPLOYEE_TABLE_H
+#define EMPLOYEE_TABLE_H
+
+#include "employee.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// ------------------------------------------------------------------------------
+// Interns skill names: each distinct name is stored once and referred to by a
+// dense 32-bit id (0, 1, 2, ... in order of first appearance).
+// ------------------------------------------------------------------------------
+class SkillPool {
+private:
+    // Lets find() look up a std::string_view without building a std::string.
+    struct Hash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view s) const noexcept {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+
+    std::unordered_map<std::string, std::uint32_t, Hash, std::equal_to<>> ids;
+    std::vector<const std::string*> names; // by id; map keys never move
+
+public:
+    // The id of `name`, adding it on first use.
+    std::uint32_t intern(std::string_view name);
+
+    // The id of `name`, or kMissing.
+    static constexpr std::uint32_t kMissing = UINT32_MAX;
+    std::uint32_t find(std::string_view name) const;
+
+    std::string_view name(std::uint32_t id) const {
+        return *names[id];
+    }
+
+    std::size_t size() const {
+        return names.size();
+    }
+
+    // Approximate: node sizes are an implementation detail of the map.
+    std::size_t memoryBytes() const;
+};
+
+// ------------------------------------------------------------------------------
+// Structure of arrays instead of std::vector<Employee>.
+//
+//   ids          [1001, 1002, ...]
+//   nameOffsets  [0, 13, 22, ...]          row r's name is
+//   nameChars    "Alice JohnsonBob Smith"  nameChars[nameOffsets[r] .. nameOffsets[r + 1])
+//   skillOffsets [0, 2, 3, ...]            row r's skills are
+//   skillIds     [0, 1, 0, ...]            skillIds[skillOffsets[r] .. skillOffsets[r + 1])
+//
+// The skill lists form a CSR (compressed sparse row) layout and the ids
+// index one SkillPool, so "C++" is stored once however many people list it.
+// The rows themselves live in five heap blocks, one per column, whatever the
+// row count; append() allocates for them only when a column outgrows its
+// capacity, which reserve() can rule out. The SkillPool is separate and grows
+// with the number of distinct skills: a map node per skill (plus its name,
+// if too long for the string's inline buffer), the bucket array and the
+// id-to-name vector. Iteration walks contiguous arrays.
+//
+// Rows are read-only views (Row); a table is append-only. Offsets are 32-bit,
+// so the name characters and the skill references are each limited to 4 Gi
+// entries (std::length_error past that).
+// ------------------------------------------------------------------------------
+class EmployeeTable {
+private:
+    std::vector<int> ids;
+    std::vector<std::uint32_t> nameOffsets{0};
+    std::vector<char> nameChars;
+    std::vector<std::uint32_t> skillOffsets{0};
+    std::vector<std::uint32_t> skillIds;
+    SkillPool skills;
+
+    void appendRow(int id, std::string_view name);
+    void endRow();
+
+    // Drops everything past the first `rows` complete rows, undoing a
+    // half-appended one. Skill names interned on the way stay in the pool.
+    void truncate(std::size_t rows) noexcept;
+
+public:
+    struct Row {
+        int id;
+        std::string_view name;
+        std::span<const std::uint32_t> skills; // ids into skillPool()
+    };
+
+    class iterator {
+    private:
+        const EmployeeTable* table = nullptr;
+        std::size_t row = 0;
+
+    public:
+        using value_type = Row;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        iterator(const EmployeeTable* owner, std::size_t index)
+            : table(owner)
+            , row(index) {}
+
+        Row operator*() const {
+            return (*table)[row];
+        }
+
+        iterator& operator++() {
+            ++row;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator before = *this;
+            ++row;
+            return before;
+        }
+
+        bool operator==(const iterator& other) const {
+            return row == other.row;
+        }
+    };
+
+    // Room for `rows` employees with `nameBytes` name characters and
+    // `skillRefs` skill entries in total.
+    void reserve(std::size_t rows, std::size_t nameBytes, std::size_t skillRefs);
+
+    void append(int id, std::string_view name, std::initializer_list<std::string_view> rowSkills);
+    void append(const Employee& employee);
+
+    // Any range of things convertible to std::string_view.
+    // If an allocation throws, the table is left as it was.
+    template <typename Skills>
+    void append(int id, std::string_view name, const Skills& rowSkills) {
+        const std::size_t rows = size();
+        try {
+            appendRow(id, name);
+            for (const auto& skill : rowSkills) {
+                skillIds.push_back(skills.intern(skill));
+            }
+            endRow();
+        } catch (...) {
+            truncate(rows);
+            throw;
+        }
+    }
+
+    Row operator[](std::size_t row) const {
+        return Row{ids[row],
+                   std::string_view(nameChars.data() + nameOffsets[row], nameOffsets[row + 1] - nameOffsets[row]),
+                   std::span<const std::uint32_t>(skillIds.data() + skillOffsets[row], skillOffsets[row + 1] - skillOffsets[row])};
+    }
+
+    std::size_t size() const {
+        return ids.size();
+    }
+
+    iterator begin() const {
+        return iterator(this, 0);
+    }
+
+    iterator end() const {
+        return iterator(this, size());
+    }
+
+    const SkillPool& skillPool() const {
+        return skills;
+    }
+
+    // Rows that list `skill`; a scan of one integer column.
+    std::size_t countWithSkill(std::string_view skill) const;
+
+    // Heap bytes held by the columns (capacity, not size) and the pool.
+    std::size_t memoryBytes() const;
+
+    void display(std::size_t row) const;
+};
+
+#endif // EMPLOYEE_TABLE_H
@@ -0,0 +1,181 @@
+#include "buffer_allocator.h"
+
+#include <algorithm>
+#include <bit>
+#include <new>
+
+namespace {
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    std::size_t classIndex(std::size_t n) {
+        if (n <= PoolAllocator::kMinBlock) {
+            return 0;
+        }
+        return static_cast<std::size_t>(std::bit_width(n - 1)) - 4; // 16 == 2^4
+    }
+
+    std::size_t classSize(std::size_t index) {
+        return PoolAllocator::kMinBlock << index;
+    }
+
+    std::size_t classCap(std::size_t index) {
+        return std::max<std::size_t>(4, PoolAllocator::kCachedBytesPerClass / classSize(index));
+    }
+
+    // Set once the thread's cache has been destroyed, so buffers that die
+    // later during thread exit bypass it. Trivially destructible on purpose.
+    thread_local bool cacheGone = false;
+
+    struct ThreadCache {
+        FreeBlock* heads[PoolAllocator::kClassCount] = {};
+        std::size_t counts[PoolAllocator::kClassCount] = {};
+        PoolAllocator::Stats stats;
+
+        ~ThreadCache() {
+            for (std::size_t i = 0; i < PoolAllocator::kClassCount; ++i) {
+                while (heads[i] != nullptr) {
+                    FreeBlock* block = heads[i];
+                    heads[i] = block->next;
+                    ::operator delete(block);
+                }
+            }
+            cacheGone = true;
+        }
+    };
+
+    thread_local ThreadCache cache;
+} // namespace
+
+char* PoolAllocator::allocate(std::size_t n, std::size_t alignment) {
+    if (alignment > kDefaultAlignment) {
+        return static_cast<char*>(::operator new(n == 0 ? 1 : n, std::align_val_t(alignment)));
+    }
+    if (n > kMaxBlock) {
+        if (!cacheGone) {
+            ++cache.stats.oversized;
+        }
+        return static_cast<char*>(::operator new(n));
+    }
+
+    // Always a whole size class, even when the cache is gone, so tryExpand
+    // holds for every block of pooled size.
+    const std::size_t index = classIndex(n);
+    if (cacheGone) {
+        return static_cast<char*>(::operator new(classSize(index)));
+    }
+    if (FreeBlock* block = cache.heads[index]) {
+        cache.heads[index] = block->next;
+        --cache.counts[index];
+        ++cache.stats.hits;
+        return reinterpret_cast<char*>(block);
+    }
+    ++cache.stats.misses;
+    return static_cast<char*>(::operator new(classSize(index)));
+}
+
+void PoolAllocator::deallocate(char* p, std::size_t n, std::size_t alignment) noexcept {
+    if (p == nullptr) {
+        return;
+    }
+    if (alignment > kDefaultAlignment) {
+        ::operator delete(p, std::align_val_t(alignment));
+        return;
+    }
+    if (n > kMaxBlock || cacheGone) {
+        ::operator delete(p);
+        return;
+    }
+
+    const std::size_t index = classIndex(n);
+    if (cache.counts[index] >= classCap(index)) {
+        ::operator delete(p);
+        return;
+    }
+    auto* block = reinterpret_cast<FreeBlock*>(p);
+    block->next = cache.heads[index];
+    cache.heads[index] = block;
+    ++cache.counts[index];
+}
+
+bool PoolAllocator::tryExpand(char*, std::size_t n, std::size_t newN, std::size_t alignment) noexcept {
+    // Oversized and over-aligned blocks have exactly the size asked for.
+    return alignment <= kDefaultAlignment && n <= kMaxBlock && newN <= kMaxBlock && classIndex(n) == classIndex(newN);
+}
+
+PoolAllocator::Stats PoolAllocator::threadStats() {
+    return cacheGone ? Stats{} : cache.stats;
+}
+
+// ------------------------------------------------------------------------------
+
+MonotonicArena::MonotonicArena(std::size_t initialChunkSize)
+    : nextChunkSize(std::max<std::size_t>(initialChunkSize, 256)) {}
+
+MonotonicArena::~MonotonicArena() {
+    release();
+    if (chunks != nullptr) {
+        ::operator delete(chunks);
+    }
+}
+
+void MonotonicArena::addChunk(std::size_t minBytes) {
+    // Grow geometrically so a long request needs only a few chunks.
+    std::size_t capacity = nextChunkSize;
+    while (capacity < minBytes) {
+        capacity *= 2;
+    }
+    nextChunkSize = capacity * 2;
+
+    auto* chunk = static_cast<Chunk*>(::operator new(sizeof(Chunk) + capacity));
+    chunk->next = chunks;
+    chunk->capacity = capacity;
+    chunks = chunk;
+    cursor = reinterpret_cast<char*>(chunk + 1);
+    limit = cursor + capacity;
+}
+
+char* MonotonicArena::allocate(std::size_t n, std::size_t alignment) {
+    auto aligned = [&](char* p) {
+        auto address = reinterpret_cast<std::uintptr_t>(p);
+        return p + ((alignment - address % alignment) % alignment);
+    };
+
+    char* p = cursor != nullptr ? aligned(cursor) : nullptr;
+    if (p == nullptr || static_cast<std::size_t>(limit - p) < n) {
+        addChunk(n + alignment);
+        p = aligned(cursor);
+    }
+    cursor = p + n;
+    bytesUsed += n;
+    return p;
+}
+
+bool MonotonicArena::tryExpand(char* p, std::size_t n, std::size_t newN) noexcept {
+    if (p + n != cursor || static_cast<std::size_t>(limit - p) < newN) {
+        return false;
+    }
+    cursor = p + newN;
+    bytesUsed += newN - n;
+    return true;
+}
+
+void MonotonicArena::release() noexcept {
+    if (chunks == nullptr) {
+        return;
+    }
+    // The newest chunk is the largest one; keep it for the next round.
+    Chunk* keep = chunks;
+    Chunk* chunk = keep->next;
+    while (chunk != nullptr) {
+        Chunk* next = chunk->next;
+        ::operator delete(chunk);
+        chunk = next;
+    }
+    keep->next = nullptr;
+    chunks = keep;
+    cursor = reinterpret_cast<char*>(keep + 1);
+    limit = cursor + keep->capacity;
+    bytesUsed = 0;
+}
@@ -0,0 +1,51 @@
+#include "buffer_chain.h"
+
+#if !defined(_WIN32)
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <unistd.h>
+
+#if !defined(IOV_MAX)
+#define IOV_MAX 1024
+#endif
+
+bool writeAll(int fd, std::vector<iovec> iov) {
+    std::size_t next = 0;
+    while (next < iov.size()) {
+        if (iov[next].iov_len == 0) {
+            ++next;
+            continue;
+        }
+        const int batch = static_cast<int>(std::min<std::size_t>(iov.size() - next, IOV_MAX));
+        ssize_t written = ::writev(fd, iov.data() + next, batch);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        // Skip what was written; a partial write leaves us inside a fragment.
+        auto remaining = static_cast<std::size_t>(written);
+        while (remaining > 0 && next < iov.size() && remaining >= iov[next].iov_len) {
+            remaining -= iov[next].iov_len;
+            ++next;
+        }
+        if (remaining > 0) {
+            iov[next].iov_base = static_cast<char*>(iov[next].iov_base) + remaining;
+            iov[next].iov_len -= remaining;
+        }
+    }
+    return true;
+}
+
+long readSome(int fd, const std::vector<iovec>& iov) {
+    const int count = static_cast<int>(std::min<std::size_t>(iov.size(), IOV_MAX));
+    for (;;) {
+        ssize_t got = ::readv(fd, iov.data(), count);
+        if (got >= 0 || errno != EINTR) {
+            return static_cast<long>(got);
+        }
+    }
+}
+#endif
@@ -0,0 +1,117 @@
+#include "employee_table.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    std::uint32_t checkedOffset(std::size_t n) {
+        if (n > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::length_error("EmployeeTable: column exceeds 32-bit offsets");
+        }
+        return static_cast<std::uint32_t>(n);
+    }
+
+    template <typename T>
+    std::size_t heapBytes(const std::vector<T>& column) {
+        return column.capacity() * sizeof(T);
+    }
+} // namespace
+
+std::uint32_t SkillPool::intern(std::string_view name) {
+    if (auto found = ids.find(name); found != ids.end()) {
+        return found->second;
+    }
+    const std::uint32_t id = checkedOffset(names.size());
+    names.push_back(nullptr); // first, so a throwing emplace is easy to undo
+    try {
+        names.back() = &ids.emplace(std::string(name), id).first->first;
+    } catch (...) {
+        names.pop_back();
+        throw;
+    }
+    return id;
+}
+
+std::uint32_t SkillPool::find(std::string_view name) const {
+    auto found = ids.find(name);
+    return found == ids.end() ? kMissing : found->second;
+}
+
+std::size_t SkillPool::memoryBytes() const {
+    // One node (key, value, next pointer, cached hash) per name, the bucket
+    // array, the id-to-name vector, and name characters past the SSO buffer.
+    std::size_t bytes = ids.bucket_count() * sizeof(void*) + heapBytes(names);
+    for (const auto& [name, id] : ids) {
+        bytes += sizeof(std::string) + sizeof(id) + 2 * sizeof(void*);
+        if (name.capacity() > std::string().capacity()) {
+            bytes += name.capacity() + 1;
+        }
+    }
+    return bytes;
+}
+
+void EmployeeTable::reserve(std::size_t rows, std::size_t nameBytes, std::size_t skillRefs) {
+    ids.reserve(rows);
+    nameOffsets.reserve(rows + 1);
+    nameChars.reserve(nameBytes);
+    skillOffsets.reserve(rows + 1);
+    skillIds.reserve(skillRefs);
+}
+
+void EmployeeTable::appendRow(int id, std::string_view name) {
+    checkedOffset(nameChars.size() + name.size());
+    ids.push_back(id);
+    nameChars.insert(nameChars.end(), name.begin(), name.end());
+    nameOffsets.push_back(static_cast<std::uint32_t>(nameChars.size()));
+}
+
+void EmployeeTable::endRow() {
+    skillOffsets.push_back(checkedOffset(skillIds.size()));
+}
+
+void EmployeeTable::truncate(std::size_t rows) noexcept {
+    ids.resize(rows);
+    nameOffsets.resize(rows + 1);
+    nameChars.resize(nameOffsets[rows]);
+    skillOffsets.resize(rows + 1);
+    skillIds.resize(skillOffsets[rows]);
+}
+
+void EmployeeTable::append(int id, std::string_view name, std::initializer_list<std::string_view> rowSkills) {
+    append<std::initializer_list<std::string_view>>(id, name, rowSkills);
+}
+
+void EmployeeTable::append(const Employee& employee) {
+    append(employee.getId(), employee.getName(), employee.getSkills());
+}
+
+std::size_t EmployeeTable::countWithSkill(std::string_view skill) const {
+    const std::uint32_t wanted = skills.find(skill);
+    if (wanted == SkillPool::kMissing) {
+        return 0;
+    }
+    std::size_t count = 0;
+    for (std::size_t row = 0; row < size(); ++row) {
+        const auto first = skillIds.begin() + skillOffsets[row];
+        const auto last = skillIds.begin() + skillOffsets[row + 1];
+        count += std::find(first, last, wanted) != last ? 1 : 0;
+    }
+    return count;
+}
+
+std::size_t EmployeeTable::memoryBytes() const {
+    return heapBytes(ids) + heapBytes(nameOffsets) + heapBytes(nameChars) + heapBytes(skillOffsets) + heapBytes(skillIds)
+           + skills.memoryBytes();
+}
+
+void EmployeeTable::display(std::size_t row) const {
+    const Row employee = (*this)[row];
+    std::cout << "Employee: " << employee.name << " (ID: " << employee.id << ")\n";
+    std::cout << "Skills: ";
+    for (std::uint32_t skill : employee.skills) {
+        std::cout << skills.name(skill) << " ";
+    }
+    std::cout << "\n";
+}
@@ -1,121 +1,131 @@
+#include "instrumentation.h"
+
+#include "buffer_chain.h"
+#include "dynamic_buffer.h"
+#include "employee.h"
+#include "employee_table.h"
+
+#include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 
-// RULE OF FIVE: Low-level RAII wrapper for dynamic array
-class DynamicBuffer {
-private:
-    char* data;
-    size_t size;
-
-public:
-    // Constructor
-    DynamicBuffer(size_t sz)
-        : data(new char[sz])
-        , size(sz) {
-        std::memset(data, 0, size);
-        std::cout << "[RuleOfFive] Constructor: allocated " << size << " bytes\n";
-    }
+// DEMONSTRATION FUNCTIONS
+// Each scenario runs in its own AllocationScope, which adds a row to `costs`
+// (allocations include the frees at the end of the scenario's block).
+void demonstrateRuleOfFive(instrumentation::CostTable& costs) {
+    std::cout << "\n========== RULE OF FIVE ==========\n";
 
-    // Destructor
-    ~DynamicBuffer() {
-        delete[] data;
-        std::cout << "[RuleOfFive] Destructor: freed " << size << " bytes\n";
+    DynamicBuffer buf1(64);
+    {
+        instrumentation::AllocationScope scope("DynamicBuffer copy constructor", costs);
+        DynamicBuffer buf2 = buf1; // Copy constructor
     }
-
-    // Copy Constructor (Deep Copy)
-    DynamicBuffer(const DynamicBuffer& other)
-        : data(new char[other.size])
-        , size(other.size) {
-        std::memcpy(data, other.data, size);
-        std::cout << "[RuleOfFive] Copy Constructor: copied " << size << " bytes\n";
+    {
+        instrumentation::AllocationScope scope("DynamicBuffer copy assignment", costs);
+        DynamicBuffer buf3(32);
+        buf3 = buf1; // Copy assignment
     }
-
-    // Copy Assignment Operator (Deep Copy)
-    DynamicBuffer& operator=(const DynamicBuffer& other) {
-        if (this != &other) {
-            delete[] data;
-            size = other.size;
-            data = new char[size];
-            std::memcpy(data, other.data, size);
-            std::cout << "[RuleOfFive] Copy Assignment: copied " << size << " bytes\n";
-        }
-        return *this;
+    {
+        instrumentation::AllocationScope scope("DynamicBuffer copy (copy-on-write)", costs);
+        DynamicBuffer shared(64, BufferStorage::CopyOnWrite);
+        DynamicBuffer reader = shared; // no bytes copied until someone writes
     }
-
-    // Move Constructor (Transfer Ownership)
-    DynamicBuffer(DynamicBuffer&& other) noexcept
-        : data(other.data)
-        , size(other.size) {
-        other.data = nullptr;
-        other.size = 0;
-        std::cout << "[RuleOfFive] Move Constructor: transferred ownership\n";
+    {
+        // Move operations
+        instrumentation::AllocationScope scope("DynamicBuffer push_back(std::move)", costs);
+        std::vector<DynamicBuffer> vec;
+        vec.push_back(std::move(buf1)); // Move constructor
     }
+}
+
+void demonstrateAllocators() {
+    std::cout << "\n========== ALLOCATOR POLICIES ==========\n";
+    traceDynamicBuffer = false;
 
-    // Move Assignment Operator (Transfer Ownership)
-    DynamicBuffer& operator=(DynamicBuffer&& other) noexcept {
-        if (this != &other) {
-            delete[] data;
-            data = other.data;
-            size = other.size;
-            other.data = nullptr;
-            other.size = 0;
-            std::cout << "[RuleOfFive] Move Assignment: transferred ownership\n";
+    // Size-class pool: the second round reuses the blocks freed by the first.
+    for (int round = 0; round < 2; ++round) {
+        std::vector<PooledDynamicBuffer> pooled;
+        for (size_t sz : {24, 100, 1000, 4000}) {
+            pooled.emplace_back(sz);
         }
-        return *this;
     }
-};
-
-// RULE OF ZERO: Modern C++ with RAII types
-class Employee {
-private:
-    std::string name;                // RAII type manages memory
-    int id;                          // Primitive type
-    std::vector<std::string> skills; // RAII type manages memory
-
-public:
-    Employee(std::string n, int empId)
-        : name(std::move(n))
-        , id(empId) {
-        std::cout << "[RuleOfZero] Employee created: " << name << "\n";
+    PoolAllocator::Stats stats = PoolAllocator::threadStats();
+    std::cout << "Pool: " << stats.misses << " misses, " << stats.hits << " hits\n";
+
+    // Monotonic arena: per-buffer frees are no-ops, release() drops them all.
+    MonotonicArena arena;
+    {
+        std::vector<ArenaDynamicBuffer> request;
+        for (size_t sz : {24, 100, 1000, 4000}) {
+            request.emplace_back(sz, ArenaAllocator(arena));
+        }
+        std::cout << "Arena: " << arena.used() << " bytes in use\n";
     }
+    arena.release();
+    std::cout << "Arena after release: " << arena.used() << " bytes in use\n";
 
-    // No destructor needed!
-    // No copy constructor needed!
-    // No copy assignment needed!
-    // No move constructor needed!
-    // No move assignment needed!
-    // Compiler generates all of them correctly!
+    traceDynamicBuffer = true;
+}
 
-    void addSkill(const std::string& skill) {
-        skills.push_back(skill);
-    }
+void demonstrateCopyOnWrite() {
+    std::cout << "\n========== COPY-ON-WRITE ==========\n";
 
-    void display() const {
-        std::cout << "Employee: " << name << " (ID: " << id << ")\n";
-        std::cout << "Skills: ";
-        for (const auto& skill : skills) {
-            std::cout << skill << " ";
-        }
-        std::cout << "\n";
-    }
-};
+    DynamicBuffer shared(4096, BufferStorage::CopyOnWrite);
+    std::vector<DynamicBuffer> readers(3, shared); // three shared copies, no memcpy
+    std::cout << "Owners before write: " << shared.useCount() << "\n";
 
-// DEMONSTRATION FUNCTIONS
-void demonstrateRuleOfFive() {
-    std::cout << "\n========== RULE OF FIVE ==========\n";
+    readers[0].mutableBytes()[0] = 'x'; // this reader gets a private copy
+    std::cout << "Owners after write: " << shared.useCount() << "\n";
+}
 
-    DynamicBuffer buf1(64);
-    DynamicBuffer buf2 = buf1; // Copy constructor
-    DynamicBuffer buf3(32);
-    buf3 = buf1; // Copy assignment
-    // Move operations
-    std::vector<DynamicBuffer> vec;
-    vec.push_back(std::move(buf1)); // Move constructor
+void demonstrateGrowth() {
+    std::cout << "\n========== ALIGNMENT AND GROWTH ==========\n";
+
+    // An I/O buffer that is about to be overwritten: no memset, page aligned.
+    DynamicBuffer io(1 << 20, {.init = BufferInit::Uninitialized, .alignment = kPageAlignment});
+    std::cout << "Page aligned: " << (reinterpret_cast<std::uintptr_t>(io.bytes()) % kPageAlignment == 0 ? "yes" : "no") << "\n";
+
+    // Geometric growth; pooled blocks grow in place within their size class.
+    PooledDynamicBuffer grown(20);
+    grown.resize(30); // still fits the 32-byte class: no copy
+    grown.resize(40); // next class: reallocates, doubling to 60 bytes
+    std::cout << "Length " << grown.length() << ", capacity " << grown.capacity() << "\n";
 }
 
-void demonstrateRuleOfZero() {
+void demonstrateViews() {
+    std::cout << "\n========== VIEWS AND CHAINS ==========\n";
+    traceDynamicBuffer = false;
+    {
+        const std::string_view message = "HEADER|payload";
+        DynamicBuffer frame(message.size());
+        std::memcpy(frame.mutableBytes(), message.data(), message.size());
+
+        // Zero-copy slices; they pin the bytes, so the frame can go away.
+        BufferView header = frame.slice(0, 6);
+        BufferView payload = frame.slice(7, 7);
+        frame = DynamicBuffer(0);
+        std::cout << "Header: " << std::string_view(header.data(), header.size())
+                  << ", payload: " << std::string_view(payload.data(), payload.size()) << "\n";
+
+        // A chain links fragments for writev instead of concatenating them.
+        DynamicBuffer separator(2);
+        std::memcpy(separator.mutableBytes(), ": ", 2);
+        BufferChain chain;
+        chain.append(header);
+        chain.append(std::move(separator));
+        chain.append(payload);
+        DynamicBuffer flat = chain.flatten(); // what writev saves us from
+        std::cout << "Chain of " << chain.count() << " fragments, " << chain.size()
+                  << " bytes: " << std::string_view(flat.bytes(), flat.length()) << "\n";
+    }
+    traceDynamicBuffer = true;
+}
+
+void demonstrateRuleOfZero(instrumentation::CostTable& costs) {
     std::cout << "\n========== RULE OF ZERO ==========\n";
 
     Employee emp1("Alice Johnson", 1001);
@@ -123,18 +133,75 @@ void demonstrateRuleOfZero() {
     emp1.addSkill("Python");
     emp1.display();
 
-    // Copy works automatically (compiler-generated)
-    Employee emp2 = emp1;
-    std::cout << "\nCopied employee:\n";
-    emp2.display();
+    {
+        // Copy works automatically (compiler-generated)
+        instrumentation::AllocationScope scope("Employee copy constructor", costs);
+        Employee emp2 = emp1;
+        std::cout << "\nCopied employee:\n";
+        emp2.display();
+    }
+    {
+        // Move works automatically!
+        instrumentation::AllocationScope scope("Employee push_back(std::move)", costs);
+        std::vector<Employee> team;
+        team.push_back(std::move(emp1));
+        std::cout << "\nEmployee moved to team vector\n";
+    }
+}
 
-    // Move works automatically!
-    std::vector<Employee> team;
-    team.push_back(std::move(emp1));
-    std::cout << "\nEmployee moved to team vector\n";
+void demonstrateEmployeeTable(instrumentation::CostTable& costs) {
+    std::cout << "\n========== COLUMNAR EMPLOYEE TABLE ==========\n";
+
+    EmployeeTable table;
+    table.append(1001, "Alice Johnson", {"C++", "Python"});
+    table.append(1002, "Bob Smith", {"C++", "Rust", "SQL"});
+    table.append(1003, "Carol White", {"Python"});
+    for (size_t row = 0; row < table.size(); ++row) {
+        table.display(row);
+    }
+    std::cout << table.skillPool().size() << " distinct skills stored once; " << table.countWithSkill("C++") << " employees know C++\n";
+
+    // The same employees both ways; the cost table shows the difference.
+    // Both lines count every byte allocated while filling the container,
+    // including blocks freed again when something grew.
+    constexpr int kRows = 1000;
+    char name[32];
+    traceEmployee = false;
+    {
+        instrumentation::AllocationScope scope("1000 Employees in std::vector", costs);
+        std::vector<Employee> people;
+        people.reserve(kRows);
+        for (int i = 0; i < kRows; ++i) {
+            std::snprintf(name, sizeof(name), "Employee number %d", i);
+            people.emplace_back(name, i);
+            people.back().addSkill("C++");
+            people.back().addSkill("Python");
+        }
+        std::cout << "std::vector<Employee>: " << scope.cost().allocatedBytes / kRows << " heap bytes allocated per employee\n";
+    }
+    {
+        instrumentation::AllocationScope scope("1000 rows in EmployeeTable", costs);
+        EmployeeTable rows;
+        rows.reserve(kRows, kRows * 20, kRows * 2);
+        for (int i = 0; i < kRows; ++i) {
+            const int length = std::snprintf(name, sizeof(name), "Employee number %d", i);
+            rows.append(i, std::string_view(name, static_cast<size_t>(length)), {"C++", "Python"});
+        }
+        std::cout << "EmployeeTable: " << scope.cost().allocatedBytes / kRows << " heap bytes allocated per employee\n";
+    }
+    traceEmployee = true;
 }
 
 int main() {
-    demonstrateRuleOfFive();
-    demonstrateRuleOfZero();
+    instrumentation::CostTable costs;
+    demonstrateRuleOfFive(costs);
+    demonstrateAllocators();
+    demonstrateCopyOnWrite();
+    demonstrateGrowth();
+    demonstrateViews();
+    demonstrateRuleOfZero(costs);
+    demonstrateEmployeeTable(costs);
+
+    std::cout << "\n========== COST PER SCENARIO ==========\n";
+    costs.print();
 }
\ No newline at end of file
@@ -1,13 +1,23 @@
+#include "instrumentation.h"
+
 #include <iostream>
 #include <string>
 #include <utility>
 
 class Resource {
+private:
+    // std::string cannot report its own copies, so process() does it.
+    static instrumentation::TypeCounters& stringCounters() {
+        static instrumentation::TypeCounters& counters = instrumentation::typeCounters("std::string");
+        return counters;
+    }
+
 public:
     // 1. Lvalue Reference Overload (The "Copy" path)
     void process(const std::string& s) {
         std::cout << "[LVALUE PATH] Copying: " << s << "\n";
         data = s; // Triggers copy assignment
+        stringCounters().copied(s.size());
     }
 
     // 2. Rvalue Reference Overload (The "Move" path)
@@ -15,6 +25,7 @@ public:
         std::cout << "[RVALUE PATH] Moving/Stealing: " << s << "\n";
         // CRUCIAL: 's' is an lvalue here because it has a name.
         // std::move(s) casts it back to an xvalue so 'data' can steal the pointer.
+        stringCounters().moved(s.size());
         data = std::move(s);
     }
 
@@ -28,19 +39,38 @@ private:
 
 int main() {
     Resource res;
+    instrumentation::CostTable costs;
 
     // Scenario A: Standard lvalue
     std::string text = "Persistent Data";
-    res.process(text); // Calls (const std::string&)
+    {
+        instrumentation::AllocationScope scope("A: lvalue", costs);
+        res.process(text); // Calls (const std::string&)
+    }
 
     // Scenario B: prvalue (Pure temporary)
-    res.process(std::string("Temporary Data")); // Calls (std::string&&)
+    {
+        instrumentation::AllocationScope scope("B: prvalue", costs);
+        res.process(std::string("Temporary Data")); // Calls (std::string&&)
+    }
 
     // Scenario C: xvalue (Explicit move)
-    res.process(std::move(text)); // Calls (std::string&&)
+    {
+        instrumentation::AllocationScope scope("C: xvalue (std::move)", costs);
+        res.process(std::move(text)); // Calls (std::string&&)
+    }
 
     // Scenario D: The "Const" Trap (Sparring Partner Addition)
     const std::string permanent = "I cannot be moved";
-    res.process(std::move(permanent)); // SURPRISE: Calls (const std::string&)
+    {
+        instrumentation::AllocationScope scope("D: std::move of const", costs);
+        res.process(std::move(permanent)); // SURPRISE: Calls (const std::string&)
+    }
     // Why? You cannot steal from a 'const' object, so it falls back to copying.
-}
\ No newline at end of file
+
+    // Strings this short live inside the std::string object itself (small
+    // string optimization), so copying them allocates nothing; the copy
+    // column still shows which scenarios copied.
+    std::cout << "\n";
+    costs.print();
+}
@@ -0,0 +1,90 @@
+// Mutex vs atomic counter, split by memory order.
+//
+// Usage: level-3_18-locks_atomic_counter [max_threads] [ops_per_thread]
+//
+// Columns: the lock_guard path from main.cpp, then fetch_add and the CAS-loop
+// try_increment under each ordering policy. The gap between "mutex" and
+// "seq_cst" is the price of the lock itself; the gap between the orderings is
+// the price of the fences (often zero on x86, where every RMW is a full barrier).
+
+#include "atomic_counter.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    std::mutex m;
+    int counter = 0;
+
+    template <typename Op>
+    double run(int threads, long opsPerThread, Op op) {
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                for (long i = 0; i < opsPerThread; ++i) {
+                    op();
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        return static_cast<double>(threads) * static_cast<double>(opsPerThread) / elapsed.count() / 1e6;
+    }
+
+    bool failed = false;
+
+    void check(const char* name, int actual, long expected) {
+        if (actual != expected) {
+            std::fprintf(stderr, "%s: expected %ld, got %d\n", name, expected, actual);
+            failed = true;
+        }
+    }
+
+    template <typename Order>
+    void runOrder(const char* name, int threads, long opsPerThread, double& addRate, double& casRate) {
+        AtomicCounter<Order> added;
+        addRate = run(threads, opsPerThread, [&] { added.increment(); });
+        check(name, added.load(), threads * opsPerThread);
+
+        AtomicCounter<Order> cas;
+        casRate = run(threads, opsPerThread, [&] { cas.try_increment(); });
+        check(name, cas.load(), threads * opsPerThread);
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    int maxThreads = argc > 1 ? std::atoi(argv[1]) : 16;
+    long opsPerThread = argc > 2 ? std::atol(argv[2]) : 1'000'000;
+
+    std::printf("Mops/s\n%8s %8s | %12s %12s %12s | %12s %12s %12s\n", "threads", "mutex", "add/relaxed", "add/acq_rel", "add/seq_cst", "cas/relaxed",
+                "cas/acq_rel", "cas/seq_cst");
+
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        counter = 0;
+        double mutexRate = run(threads, opsPerThread, [] {
+            std::lock_guard<std::mutex> lock(m);
+            ++counter;
+        });
+        check("mutex", counter, threads * opsPerThread);
+
+        double add[3];
+        double cas[3];
+        runOrder<RelaxedOrder>("relaxed", threads, opsPerThread, add[0], cas[0]);
+        runOrder<AcqRelOrder>("acq_rel", threads, opsPerThread, add[1], cas[1]);
+        runOrder<SeqCstOrder>("seq_cst", threads, opsPerThread, add[2], cas[2]);
+
+        std::printf("%8d %8.2f | %12.2f %12.2f %12.2f | %12.2f %12.2f %12.2f\n", threads, mutexRate, add[0], add[1], add[2], cas[0], cas[1], cas[2]);
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,76 @@
+// bench_util.h - Small helpers shared by the 18-locks benchmarks
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace bench {
+    // Stand-in for real work; the volatile sink keeps the loop from being folded away.
+    // The sink is local: a shared one would be a data race between threads and
+    // would bounce its cache line among them even outside any lock.
+    inline void spin(int iterations) {
+        volatile int sink = 0;
+        for (int i = 0; i < iterations; ++i) {
+            sink = sink + i;
+        }
+    }
+
+    // Value at quantile q (0..1) of an already sorted sample.
+    inline std::int64_t percentile(const std::vector<std::int64_t>& sorted, double q) {
+        if (sorted.empty()) {
+            return 0;
+        }
+        auto index = static_cast<std::size_t>(q * static_cast<double>(sorted.size() - 1));
+        return sorted[index];
+    }
+
+    // "1,2,4" -> {1, 2, 4}
+    inline std::vector<int> parseList(const char* text) {
+        std::vector<int> values;
+        while (*text != '\0') {
+            char* end = nullptr;
+            long value = std::strtol(text, &end, 10);
+            if (end == text) {
+                break;
+            }
+            values.push_back(static_cast<int>(value));
+            text = (*end == ',') ? end + 1 : end;
+        }
+        return values;
+    }
+
+    // "a,b" -> {"a", "b"}
+    inline std::vector<std::string> parseNames(const char* text) {
+        std::vector<std::string> names;
+        std::string current;
+        for (; *text != '\0'; ++text) {
+            if (*text == ',') {
+                names.push_back(current);
+                current.clear();
+            }
+            else {
+                current += *text;
+            }
+        }
+        if (!current.empty()) {
+            names.push_back(current);
+        }
+        return names;
+    }
+
+    // Matches "--name=value" and points *value at the text after '='.
+    inline bool matchOption(const char* arg, const char* name, const char** value) {
+        std::size_t len = std::strlen(name);
+        if (std::strncmp(arg, name, len) == 0 && arg[len] == '=') {
+            *value = arg + len + 1;
+            return true;
+        }
+        return false;
+    }
+} // namespace bench
+
+#endif // BENCH_UTIL_H
@@ -0,0 +1,81 @@
+// try_to_lock vs flat combining under contention.
+//
+// Usage: level-3_18-locks_flat_combining [max_threads] [ops_per_thread]
+//
+// try_to_lock is fast because it throws work away; the "kept" column shows how
+// much of it survived. Flat combining keeps every update, and "ops/lock" shows
+// how many updates each lock acquisition applied on the holder's behalf.
+
+#include "flat_combining.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    std::mutex m;
+    long counter = 0;
+
+    template <typename Op>
+    double run(int threads, long opsPerThread, Op op) {
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                for (long i = 0; i < opsPerThread; ++i) {
+                    op();
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        return static_cast<double>(threads) * static_cast<double>(opsPerThread) / elapsed.count() / 1e6;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    int maxThreads = argc > 1 ? std::atoi(argv[1]) : 16;
+    long opsPerThread = argc > 2 ? std::atol(argv[2]) : 500'000;
+
+    std::printf("%8s | %12s %8s | %12s %8s | %12s %8s %9s\n", "threads", "lock Mops/s", "kept", "try Mops/s", "kept", "fc Mops/s", "kept", "ops/lock");
+
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        const double total = static_cast<double>(threads) * static_cast<double>(opsPerThread);
+
+        counter = 0;
+        double lockRate = run(threads, opsPerThread, [] {
+            std::lock_guard<std::mutex> lock(m);
+            ++counter;
+        });
+        double lockKept = static_cast<double>(counter) / total;
+
+        counter = 0;
+        double tryRate = run(threads, opsPerThread, [] {
+            std::unique_lock<std::mutex> lock(m, std::try_to_lock);
+            if (lock) {
+                ++counter;
+            }
+        });
+        double tryKept = static_cast<double>(counter) / total;
+
+        FlatCombiningCounter<> combining;
+        double fcRate = run(threads, opsPerThread, [&] { combining.try_increment(); });
+        double fcKept = static_cast<double>(combining.load()) / total;
+
+        std::printf("%8d | %12.2f %7.1f%% | %12.2f %7.1f%% | %12.2f %7.1f%% %9.2f\n", threads, lockRate, lockKept * 100, tryRate, tryKept * 100, fcRate,
+                    fcKept * 100, combining.combinedPerAcquisition());
+
+        if (combining.load() != threads * opsPerThread) {
+            std::fprintf(stderr, "flat combining lost updates at %d threads\n", threads);
+            return 1;
+        }
+    }
+}
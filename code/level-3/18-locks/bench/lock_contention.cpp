@@ -0,0 +1,282 @@
+// Contention sweep over the four locking styles used in 18-locks.
+//
+// Usage: level-3_18-locks_lock_contention [options]
+//   --locks=std,ttas,ticket,mcs,adaptive   lock types to sweep
+//   --threads=1,2,4,8     thread counts to sweep
+//   --cs=0,50,500         critical-section length (spin iterations under the lock)
+//   --think=0,50,500      think time (spin iterations outside the lock)
+//   --ops=200000          operations per thread
+//   --format=csv|json     output format (default csv)
+//
+// For every (lock, strategy, threads, cs, think) point it reports throughput,
+// p50/p99/p999 lock acquisition latency in nanoseconds and, for try_to_lock,
+// the fraction of attempts that were skipped because the mutex was busy.
+// Redirect stdout to a file to keep results between releases.
+
+#include "bench_util.h"
+#include "locks.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using bench::matchOption;
+    using bench::parseList;
+    using bench::parseNames;
+    using bench::percentile;
+    using bench::spin;
+    using Clock = std::chrono::steady_clock;
+
+    long counter = 0;
+
+    std::int64_t nanosSince(Clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+
+    struct ThreadStats {
+        std::vector<std::int64_t> latencies;
+        long done = 0;
+        long skipped = 0;
+    };
+
+    struct Params {
+        int cs;
+        int think;
+    };
+
+    // The four strategies mirror the functions in src/main.cpp, minus the printing.
+    template <typename Mutex>
+    void lockGuardOp(Mutex& m, const Params& p, ThreadStats& stats) {
+        auto start = Clock::now();
+        std::lock_guard<Mutex> lock(m);
+        stats.latencies.push_back(nanosSince(start));
+        ++counter;
+        spin(p.cs);
+        ++stats.done;
+    }
+
+    template <typename Mutex>
+    void uniqueLockOp(Mutex& m, const Params& p, ThreadStats& stats) {
+        auto start = Clock::now();
+        std::unique_lock<Mutex> lock(m);
+        stats.latencies.push_back(nanosSince(start));
+        ++counter;
+        spin(p.cs);
+        lock.unlock();
+        ++stats.done;
+    }
+
+    template <typename Mutex>
+    void tryLockOp(Mutex& m, const Params& p, ThreadStats& stats) {
+        auto start = Clock::now();
+        std::unique_lock<Mutex> lock(m, std::try_to_lock);
+        stats.latencies.push_back(nanosSince(start));
+        if (!lock) {
+            ++stats.skipped;
+            return;
+        }
+        ++counter;
+        spin(p.cs);
+        ++stats.done;
+    }
+
+    template <typename Mutex>
+    void deferLockOp(Mutex& m, const Params& p, ThreadStats& stats) {
+        std::unique_lock<Mutex> lock(m, std::defer_lock);
+        auto start = Clock::now();
+        lock.lock();
+        stats.latencies.push_back(nanosSince(start));
+        ++counter;
+        spin(p.cs);
+        ++stats.done;
+    }
+
+    template <typename Mutex>
+    struct Strategy {
+        const char* name;
+        void (*op)(Mutex&, const Params&, ThreadStats&);
+    };
+
+    struct Result {
+        const char* lock;
+        const char* strategy;
+        int threads;
+        int cs;
+        int think;
+        double opsPerSec;
+        std::int64_t p50;
+        std::int64_t p99;
+        std::int64_t p999;
+        double skipRate;
+    };
+
+    struct Sweep {
+        std::vector<int> threadCounts{1, 2, 4, 8};
+        std::vector<int> csLengths{0, 50, 500};
+        std::vector<int> thinkLengths{0, 50, 500};
+        long opsPerThread = 200'000;
+    };
+
+    template <typename Mutex>
+    Result runPoint(const char* lockName, const Strategy<Mutex>& strategy, int threads, const Params& params, long opsPerThread) {
+        Mutex m;
+        std::vector<ThreadStats> stats(threads);
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        counter = 0;
+
+        auto start = Clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                ThreadStats& own = stats[t];
+                own.latencies.reserve(opsPerThread);
+                for (long i = 0; i < opsPerThread; ++i) {
+                    strategy.op(m, params, own);
+                    spin(params.think);
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+
+        std::vector<std::int64_t> all;
+        long done = 0;
+        long skipped = 0;
+        for (auto& s : stats) {
+            all.insert(all.end(), s.latencies.begin(), s.latencies.end());
+            done += s.done;
+            skipped += s.skipped;
+        }
+        std::sort(all.begin(), all.end());
+
+        if (counter != done) {
+            std::fprintf(stderr, "%s/%s lost updates: %ld of %ld\n", lockName, strategy.name, done - counter, done);
+            std::exit(1);
+        }
+
+        long attempts = done + skipped;
+        return Result{
+            lockName,
+            strategy.name,
+            threads,
+            params.cs,
+            params.think,
+            static_cast<double>(done) / elapsed.count(),
+            percentile(all, 0.50),
+            percentile(all, 0.99),
+            percentile(all, 0.999),
+            attempts == 0 ? 0.0 : static_cast<double>(skipped) / static_cast<double>(attempts),
+        };
+    }
+
+    template <typename Mutex>
+    void sweepLock(const char* lockName, const Sweep& sweep, std::vector<Result>& results) {
+        const Strategy<Mutex> strategies[] = {
+            {"lock_guard", lockGuardOp<Mutex>},
+            {"unique_lock", uniqueLockOp<Mutex>},
+            {"try_to_lock", tryLockOp<Mutex>},
+            {"defer_lock", deferLockOp<Mutex>},
+        };
+
+        for (const auto& strategy : strategies) {
+            for (int threads : sweep.threadCounts) {
+                for (int cs : sweep.csLengths) {
+                    for (int think : sweep.thinkLengths) {
+                        results.push_back(runPoint<Mutex>(lockName, strategy, threads, Params{cs, think}, sweep.opsPerThread));
+                    }
+                }
+            }
+        }
+    }
+
+    void printCsv(const std::vector<Result>& results) {
+        std::printf("lock,strategy,threads,cs,think,ops_per_sec,p50_ns,p99_ns,p999_ns,skip_rate\n");
+        for (const auto& r : results) {
+            std::printf("%s,%s,%d,%d,%d,%.0f,%lld,%lld,%lld,%.4f\n", r.lock, r.strategy, r.threads, r.cs, r.think, r.opsPerSec,
+                        static_cast<long long>(r.p50), static_cast<long long>(r.p99), static_cast<long long>(r.p999), r.skipRate);
+        }
+    }
+
+    void printJson(const std::vector<Result>& results) {
+        std::printf("[\n");
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const auto& r = results[i];
+            std::printf("  {\"lock\": \"%s\", \"strategy\": \"%s\", \"threads\": %d, \"cs\": %d, \"think\": %d, \"ops_per_sec\": %.0f, "
+                        "\"p50_ns\": %lld, \"p99_ns\": %lld, \"p999_ns\": %lld, \"skip_rate\": %.4f}%s\n",
+                        r.lock, r.strategy, r.threads, r.cs, r.think, r.opsPerSec, static_cast<long long>(r.p50), static_cast<long long>(r.p99),
+                        static_cast<long long>(r.p999), r.skipRate, i + 1 < results.size() ? "," : "");
+        }
+        std::printf("]\n");
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    Sweep sweep;
+    std::vector<std::string> locks{"std", "ttas", "ticket", "mcs", "adaptive"};
+    std::string format = "csv";
+
+    for (int i = 1; i < argc; ++i) {
+        const char* value = nullptr;
+        if (matchOption(argv[i], "--locks", &value)) {
+            locks = parseNames(value);
+        }
+        else if (matchOption(argv[i], "--threads", &value)) {
+            sweep.threadCounts = parseList(value);
+        }
+        else if (matchOption(argv[i], "--cs", &value)) {
+            sweep.csLengths = parseList(value);
+        }
+        else if (matchOption(argv[i], "--think", &value)) {
+            sweep.thinkLengths = parseList(value);
+        }
+        else if (matchOption(argv[i], "--ops", &value)) {
+            sweep.opsPerThread = std::atol(value);
+        }
+        else if (matchOption(argv[i], "--format", &value)) {
+            format = value;
+        }
+        else {
+            std::fprintf(stderr, "unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::vector<Result> results;
+    for (const auto& lock : locks) {
+        if (lock == "std") {
+            sweepLock<std::mutex>("std::mutex", sweep, results);
+        }
+        else if (lock == "ttas") {
+            sweepLock<TtasSpinlock>("TtasSpinlock", sweep, results);
+        }
+        else if (lock == "ticket") {
+            sweepLock<TicketLock>("TicketLock", sweep, results);
+        }
+        else if (lock == "mcs") {
+            sweepLock<McsLock>("McsLock", sweep, results);
+        }
+        else if (lock == "adaptive") {
+            sweepLock<AdaptiveMutex>("AdaptiveMutex", sweep, results);
+        }
+        else {
+            std::fprintf(stderr, "unknown lock: %s\n", lock.c_str());
+            return 1;
+        }
+    }
+
+    if (format == "json") {
+        printJson(results);
+    }
+    else {
+        printCsv(results);
+    }
+}
@@ -0,0 +1,72 @@
+// Logging inside the critical section: std::ostream vs LogRing.
+//
+// Usage: level-3_18-locks_log_ring [threads] [ops_per_thread] [output_file]
+//
+// Both variants hold the same mutex around "++counter; log it". The stream
+// variant formats and writes while holding the lock; LogRing only copies a
+// record. Output goes to output_file (default: log_ring_bench.out).
+
+#include "log_ring.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    std::mutex m;
+    long counter = 0;
+
+    template <typename Op>
+    double run(int threads, long opsPerThread, Op op) {
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                for (long i = 0; i < opsPerThread; ++i) {
+                    op();
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        return static_cast<double>(threads) * static_cast<double>(opsPerThread) / elapsed.count() / 1e6;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    int threads = argc > 1 ? std::atoi(argv[1]) : 4;
+    long opsPerThread = argc > 2 ? std::atol(argv[2]) : 200'000;
+    const char* path = argc > 3 ? argv[3] : "log_ring_bench.out";
+
+    std::ofstream file(path);
+
+    counter = 0;
+    double streamRate = run(threads, opsPerThread, [&] {
+        std::lock_guard<std::mutex> lock(m);
+        ++counter;
+        file << "increment -> " << counter << "\n" << std::flush;
+    });
+    std::printf("%-16s %8.2f Mops/s\n", "ostream", streamRate);
+
+    for (OverflowPolicy policy : {OverflowPolicy::Block, OverflowPolicy::Drop}) {
+        LogRing logger(4096, policy, file);
+        counter = 0;
+        double ringRate = run(threads, opsPerThread, [&] {
+            std::lock_guard<std::mutex> lock(m);
+            ++counter;
+            logger.log("increment", counter);
+        });
+        logger.flush();
+        std::printf("%-16s %8.2f Mops/s  dropped %llu of %ld\n", policy == OverflowPolicy::Block ? "LogRing (block)" : "LogRing (drop)", ringRate,
+                    static_cast<unsigned long long>(logger.dropped()), threads * opsPerThread);
+    }
+}
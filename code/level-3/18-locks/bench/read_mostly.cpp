@@ -0,0 +1,92 @@
+// Read-mostly workloads: exclusive mutex vs shared_mutex vs seqlock.
+//
+// Usage: level-3_18-locks_read_mostly [max_threads] [ops_per_thread]
+//
+// Every thread mixes reads and writes at 90/10 and 99/1. Writes add +1, so
+// the final value must equal the number of writes performed.
+
+#include "read_mostly_counter.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Where every thread publishes the sum of what it read, so the reads
+    // cannot be optimized away.
+    std::atomic<std::uint64_t> sink{0};
+
+    // Cheap per-thread PRNG so choosing read vs write costs next to nothing.
+    std::uint32_t xorshift(std::uint32_t& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    template <typename Counter>
+    double run(int threads, long opsPerThread, int readPercent, bool& ok) {
+        Counter counter;
+        std::vector<long> writes(threads, 0);
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                std::uint32_t rng = 0x9e3779b9u ^ static_cast<std::uint32_t>(t + 1);
+                std::uint64_t read = 0; // unsigned: may wrap, harmlessly
+                long written = 0;
+                for (long i = 0; i < opsPerThread; ++i) {
+                    if (static_cast<int>(xorshift(rng) % 100) < readPercent) {
+                        read += static_cast<std::uint64_t>(counter.load());
+                    }
+                    else {
+                        counter.add(1);
+                        ++written;
+                    }
+                }
+                sink.fetch_add(read, std::memory_order_relaxed);
+                writes[t] = written;
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        long expected = 0;
+        for (long w : writes) {
+            expected += w;
+        }
+        ok = ok && counter.load() == expected;
+
+        return static_cast<double>(threads) * static_cast<double>(opsPerThread) / elapsed.count() / 1e6;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    int maxThreads = argc > 1 ? std::atoi(argv[1]) : 16;
+    long opsPerThread = argc > 2 ? std::atol(argv[2]) : 1'000'000;
+    bool ok = true;
+
+    for (int readPercent : {90, 99}) {
+        std::printf("\n%d%% reads / %d%% writes (Mops/s)\n", readPercent, 100 - readPercent);
+        std::printf("%8s %12s %14s %10s\n", "threads", "mutex", "shared_mutex", "seqlock");
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            double exclusive = run<ExclusiveCounter>(threads, opsPerThread, readPercent, ok);
+            double shared = run<SharedMutexCounter>(threads, opsPerThread, readPercent, ok);
+            double seq = run<SeqLockCounter>(threads, opsPerThread, readPercent, ok);
+            std::printf("%8d %12.2f %14.2f %10.2f\n", threads, exclusive, shared, seq);
+        }
+    }
+
+    if (!ok) {
+        std::fprintf(stderr, "counter mismatch\n");
+        return 1;
+    }
+}
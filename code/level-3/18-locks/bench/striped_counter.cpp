@@ -0,0 +1,76 @@
+// Scaling of a single mutex-protected counter vs striped counters.
+//
+// Usage: level-3_18-locks_striped_counter [max_threads] [ops_per_thread]
+//
+// Every configuration does the same total work per thread; the table shows
+// how throughput changes as threads are added. "packed" keeps the slots on
+// shared cache lines, "padded" gives each slot its own line, so the gap
+// between the two columns is the cost of false sharing.
+
+#include "striped_counter.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    std::mutex m;
+    long counter = 0;
+
+    void lockedIncrement() {
+        std::lock_guard<std::mutex> lock(m);
+        ++counter;
+    }
+
+    // Runs `op` ops_per_thread times on each of `threads` threads and returns
+    // the throughput in millions of operations per second.
+    template <typename Op>
+    double run(int threads, long opsPerThread, Op op) {
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                for (long i = 0; i < opsPerThread; ++i) {
+                    op();
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        return static_cast<double>(threads) * static_cast<double>(opsPerThread) / elapsed.count() / 1e6;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    int maxThreads = argc > 1 ? std::atoi(argv[1]) : 64;
+    long opsPerThread = argc > 2 ? std::atol(argv[2]) : 1'000'000;
+
+    std::printf("%8s %14s %14s %14s\n", "threads", "mutex Mops/s", "packed Mops/s", "padded Mops/s");
+
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        counter = 0;
+        double mutexRate = run(threads, opsPerThread, lockedIncrement);
+
+        PackedStripedCounter packed(threads);
+        double packedRate = run(threads, opsPerThread, [&] { packed.increment(); });
+
+        StripedCounter padded(threads);
+        double paddedRate = run(threads, opsPerThread, [&] { padded.increment(); });
+
+        long expected = threads * opsPerThread;
+        if (counter != expected || packed.load() != expected || padded.load() != expected) {
+            std::fprintf(stderr, "count mismatch at %d threads\n", threads);
+            return 1;
+        }
+
+        std::printf("%8d %14.2f %14.2f %14.2f\n", threads, mutexRate, packedRate, paddedRate);
+    }
+}
@@ -0,0 +1,73 @@
+// Cost of running one tiny task: raw std::thread vs std::async vs ThreadPool.
+//
+// Usage: level-3_18-locks_task_spawn [tasks]
+//
+// Each sample starts a task that only bumps a counter and waits for it to
+// finish, so the numbers are pure spawn + hand-off + join overhead.
+
+#include "bench_util.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    std::atomic<long> counter{0};
+
+    void tinyTask() {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    template <typename Spawn>
+    void measure(const char* name, int tasks, Spawn spawnAndWait) {
+        std::vector<std::int64_t> samples;
+        samples.reserve(tasks);
+        for (int i = 0; i < tasks; ++i) {
+            auto start = Clock::now();
+            spawnAndWait();
+            samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        }
+        std::sort(samples.begin(), samples.end());
+        std::printf("%-14s %10lld %10lld %10lld\n", name, static_cast<long long>(bench::percentile(samples, 0.50)),
+                    static_cast<long long>(bench::percentile(samples, 0.99)), static_cast<long long>(bench::percentile(samples, 0.999)));
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    int tasks = argc > 1 ? std::atoi(argv[1]) : 20'000;
+
+    ThreadPool pool;
+
+    std::printf("%-14s %10s %10s %10s\n", "ns per task", "p50", "p99", "p999");
+
+    measure("std::thread", tasks, [] {
+        std::thread t(tinyTask);
+        t.join();
+    });
+
+    measure("std::async", tasks, [] { std::async(std::launch::async, tinyTask).get(); });
+
+    measure("pool.submit", tasks, [&] { pool.submit(tinyTask).get(); });
+
+    // Batch hand-off: many tasks per wait, the case parallel_for is built for.
+    const std::size_t batch = 1000;
+    long ran = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < tasks; i += static_cast<int>(batch)) {
+        const std::size_t count = std::min(batch, static_cast<std::size_t>(tasks - i)); // the last batch may be short
+        pool.parallel_for(0, count, [](std::size_t) { tinyTask(); }, 1);
+        ran += static_cast<long>(count);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    std::printf("%-14s %10lld (mean, %zu tasks per parallel_for)\n", "parallel_for",
+                static_cast<long long>(elapsed / std::max(ran, 1L)), batch);
+}
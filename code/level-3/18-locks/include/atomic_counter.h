@@ -0,0 +1,62 @@
+// atomic_counter.h - Lock-free counter with a compile-time memory-order policy
+#ifndef ATOMIC_COUNTER_H
+#define ATOMIC_COUNTER_H
+
+#include "cache_line.h"
+
+#include <atomic>
+
+// Memory-order policies. `rmw` is used for fetch_add / fetch_sub / successful
+// CAS, `load` for plain reads and failed CAS.
+struct RelaxedOrder {
+    static constexpr std::memory_order rmw = std::memory_order_relaxed;
+    static constexpr std::memory_order load = std::memory_order_relaxed;
+};
+
+struct AcqRelOrder {
+    static constexpr std::memory_order rmw = std::memory_order_acq_rel;
+    static constexpr std::memory_order load = std::memory_order_acquire;
+};
+
+struct SeqCstOrder {
+    static constexpr std::memory_order rmw = std::memory_order_seq_cst;
+    static constexpr std::memory_order load = std::memory_order_seq_cst;
+};
+
+// Same operations as the mutex-based functions in main.cpp, but each one is a
+// single atomic instruction (or a CAS loop) and no thread ever blocks.
+//
+// RelaxedOrder is enough when the counter is the only shared data. Use
+// AcqRelOrder or SeqCstOrder when other memory is published together with
+// the count, e.g. "write the item, then bump the counter".
+template <typename Order = SeqCstOrder>
+class AtomicCounter {
+private:
+    alignas(kCacheLineSize) std::atomic<int> value{0};
+
+public:
+    // Each returns the value after the update.
+    int increment() {
+        return value.fetch_add(1, Order::rmw) + 1;
+    }
+
+    int decrement() {
+        return value.fetch_sub(1, Order::rmw) - 1;
+    }
+
+    // Unlike the try_to_lock version, this never drops the update: if another
+    // thread changed the value in between, compare_exchange reloads `current`
+    // and we simply retry.
+    int try_increment() {
+        int current = value.load(Order::load);
+        while (!value.compare_exchange_weak(current, current + 1, Order::rmw, Order::load)) {
+        }
+        return current + 1;
+    }
+
+    int load() const {
+        return value.load(Order::load);
+    }
+};
+
+#endif // ATOMIC_COUNTER_H
@@ -0,0 +1,11 @@
+// cache_line.h - Cache line size used to keep hot data on separate lines
+#ifndef CACHE_LINE_H
+#define CACHE_LINE_H
+
+#include <cstddef>
+
+// std::hardware_destructive_interference_size is not available everywhere and
+// GCC warns when it leaks into an ABI, so use the common x86/ARM value instead.
+inline constexpr std::size_t kCacheLineSize = 64;
+
+#endif // CACHE_LINE_H
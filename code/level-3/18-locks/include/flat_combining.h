@@ -0,0 +1,162 @@
+// flat_combining.h - Counter that batches contended updates instead of dropping them
+#ifndef FLAT_COMBINING_H
+#define FLAT_COMBINING_H
+
+#include "cache_line.h"
+#include "locks.h"
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+inline constexpr std::size_t kMaxCombiningThreads = 64;
+
+// Publication slots are handed out per thread and recycled when the thread
+// exits, so short-lived threads don't run out of them. The index is shared by
+// every FlatCombiningCounter.
+inline std::atomic<bool> combiningSlotUsed[kMaxCombiningThreads];
+
+class CombiningSlotLease {
+private:
+    std::size_t index = kMaxCombiningThreads; // kMaxCombiningThreads means "no slot"
+
+public:
+    CombiningSlotLease() {
+        for (std::size_t i = 0; i < kMaxCombiningThreads; ++i) {
+            bool expected = false;
+            if (combiningSlotUsed[i].compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                index = i;
+                break;
+            }
+        }
+    }
+
+    ~CombiningSlotLease() {
+        if (index < kMaxCombiningThreads) {
+            combiningSlotUsed[index].store(false, std::memory_order_release);
+        }
+    }
+
+    CombiningSlotLease(const CombiningSlotLease&) = delete;
+    CombiningSlotLease& operator=(const CombiningSlotLease&) = delete;
+
+    std::size_t get() const {
+        return index;
+    }
+};
+
+inline std::size_t combiningSlotIndex() {
+    thread_local CombiningSlotLease lease;
+    return lease.get();
+}
+
+// Flat combining: a thread that finds the lock busy does not give up (like
+// try_to_lock) or queue on the mutex (like lock_guard). It writes its update
+// into its own slot and waits. Whoever holds the lock applies every pending
+// slot in one pass before releasing it, so one lock acquisition can serve
+// many threads and no update is ever lost.
+template <typename Mutex = std::mutex>
+class FlatCombiningCounter {
+private:
+    struct alignas(kCacheLineSize) Slot {
+        std::atomic<int> request{0}; // pending delta, 0 = empty
+    };
+
+    Mutex m;
+    Slot slots[kMaxCombiningThreads];
+
+    // Number of published, not yet applied requests. Lets the uncontended
+    // path skip scanning the slots entirely.
+    alignas(kCacheLineSize) std::atomic<int> pending{0};
+
+    // Guarded by m
+    int value = 0;
+    long acquisitions = 0;
+    long operations = 0;
+
+    // Caller holds m. Applies its own delta plus everything published so far.
+    void combine(int ownDelta) {
+        value += ownDelta;
+        long applied = ownDelta != 0 ? 1 : 0;
+        if (pending.load(std::memory_order_acquire) != 0) {
+            int collected = 0;
+            for (auto& slot : slots) {
+                if (slot.request.load(std::memory_order_relaxed) == 0) {
+                    continue;
+                }
+                value += slot.request.exchange(0, std::memory_order_acq_rel);
+                ++collected;
+            }
+            pending.fetch_sub(collected, std::memory_order_relaxed);
+            applied += collected;
+        }
+        ++acquisitions;
+        operations += applied;
+    }
+
+    void apply(int delta) {
+        if (m.try_lock()) {
+            combine(delta);
+            m.unlock();
+            return;
+        }
+
+        const std::size_t index = combiningSlotIndex();
+        if (index >= kMaxCombiningThreads) {
+            // More live threads than slots: fall back to plain locking.
+            std::lock_guard<Mutex> lock(m);
+            combine(delta);
+            return;
+        }
+
+        Slot& own = slots[index];
+        pending.fetch_add(1, std::memory_order_relaxed);
+        own.request.store(delta, std::memory_order_release);
+
+        SpinWait spinner;
+        for (;;) {
+            if (own.request.load(std::memory_order_acquire) == 0) {
+                return; // a combiner applied it for us
+            }
+            if (m.try_lock()) {
+                combine(0); // our own slot is picked up in the pass
+                m.unlock();
+                return;
+            }
+            spinner.wait();
+        }
+    }
+
+public:
+    void increment() {
+        apply(1);
+    }
+
+    void decrement() {
+        apply(-1);
+    }
+
+    // Same call as the try_to_lock version, but a busy lock means "let the
+    // current holder do it" rather than "skip it".
+    void try_increment() {
+        apply(1);
+    }
+
+    int load() {
+        std::lock_guard<Mutex> lock(m);
+        return value;
+    }
+
+    // How many updates one lock acquisition applied on average.
+    double combinedPerAcquisition() {
+        std::lock_guard<Mutex> lock(m);
+        return acquisitions == 0 ? 0.0 : static_cast<double>(operations) / static_cast<double>(acquisitions);
+    }
+
+    long lockAcquisitions() {
+        std::lock_guard<Mutex> lock(m);
+        return acquisitions;
+    }
+};
+
+#endif // FLAT_COMBINING_H
@@ -0,0 +1,122 @@
+// instrumented_mutex.h - std::mutex wrapper that records contention per lock site
+#ifndef INSTRUMENTED_MUTEX_H
+#define INSTRUMENTED_MUTEX_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <source_location>
+#include <thread>
+
+// Identifies where a lock was taken: file:line from a Site, or the mutex name
+// when it is locked directly through lock_guard / unique_lock.
+struct LockSiteKey {
+    const char* file;
+    std::uint32_t line;
+
+    bool operator==(const LockSiteKey& other) const;
+};
+
+// Log2 histogram of durations: bucket i counts samples in [2^(i-1), 2^i) ns.
+struct DurationHistogram {
+    std::array<std::uint64_t, 40> buckets{};
+    std::uint64_t count = 0;
+    std::uint64_t totalNs = 0;
+    std::uint64_t maxNs = 0;
+
+    void merge(const DurationHistogram& other);
+    // Upper bound of the bucket holding quantile q (0..1).
+    std::uint64_t quantileNs(double q) const;
+};
+
+struct LockSiteStats {
+    DurationHistogram wait; // time spent in lock() / successful try_lock()
+    DurationHistogram hold; // time between acquiring and unlock()
+    std::uint64_t contended = 0;       // lock() calls that found the mutex busy
+    std::uint64_t tryLockFailures = 0; // try_lock() calls that returned false
+
+    void merge(const LockSiteStats& other);
+};
+
+// Drop-in replacement for std::mutex: works with std::lock_guard,
+// std::unique_lock (try_to_lock, defer_lock) and std::scoped_lock.
+//
+// Each thread records into its own thread-local table, so the added cost on an
+// uncontended lock/unlock is two clock reads and a few plain (non-locked)
+// counter updates. The tables are only merged when a report is requested.
+//
+// Direct use attributes everything to the mutex name. To tell the lock sites
+// of one mutex apart, lock through a Site, which remembers file:line:
+//
+//     InstrumentedMutex::Site site(m);
+//     std::lock_guard<InstrumentedMutex::Site> lock(site);
+class InstrumentedMutex {
+private:
+    std::mutex m;
+    const char* name;
+
+    // Written only by the thread holding m.
+    std::chrono::steady_clock::time_point lockedAt;
+    LockSiteKey holderSite{};
+    std::atomic<std::thread::id> holder{};
+
+    void acquired(const LockSiteKey& site, std::uint64_t waitNs, bool contended);
+
+public:
+    class Site {
+    private:
+        InstrumentedMutex& mutex;
+        LockSiteKey key;
+
+    public:
+        explicit Site(InstrumentedMutex& m, std::source_location location = std::source_location::current())
+            : mutex(m)
+            , key{location.file_name(), location.line()} {}
+
+        void lock() {
+            mutex.lock(key);
+        }
+
+        bool try_lock() {
+            return mutex.try_lock(key);
+        }
+
+        void unlock() {
+            mutex.unlock();
+        }
+    };
+
+    explicit InstrumentedMutex(const char* name = "InstrumentedMutex")
+        : name(name) {}
+
+    InstrumentedMutex(const InstrumentedMutex&) = delete;
+    InstrumentedMutex& operator=(const InstrumentedMutex&) = delete;
+
+    void lock() {
+        lock(LockSiteKey{name, 0});
+    }
+
+    bool try_lock() {
+        return try_lock(LockSiteKey{name, 0});
+    }
+
+    void lock(const LockSiteKey& site);
+    bool try_lock(const LockSiteKey& site);
+    void unlock();
+
+    // Thread currently holding the mutex (default-constructed id if none).
+    std::thread::id owner() const {
+        return holder.load(std::memory_order_relaxed);
+    }
+
+    // Prints one line per lock site, merged over all threads.
+    static void report(std::ostream& out);
+
+    // Calls report(std::cerr) when the program exits.
+    static void reportAtExit();
+};
+
+#endif // INSTRUMENTED_MUTEX_H
@@ -0,0 +1,256 @@
+// locks.h - Alternatives to std::mutex that satisfy Lockable
+#ifndef LOCKS_H
+#define LOCKS_H
+
+#include "cache_line.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+// Tells the CPU we are busy-waiting (x86 PAUSE / ARM YIELD). It saves power and
+// stops the spinning core from starving its hyper-thread sibling.
+inline void cpuRelax() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+// Busy-wait step for the spin loops below. After a while it starts yielding,
+// so a waiter cannot burn its whole time slice while the holder is preempted
+// (more runnable threads than cores).
+class SpinWait {
+private:
+    static constexpr int kYieldAfter = 64;
+
+    int rounds = 0;
+
+public:
+    void wait(std::uint32_t relaxCount = 1) {
+        if (rounds < kYieldAfter) {
+            ++rounds;
+            for (std::uint32_t i = 0; i < relaxCount; ++i) {
+                cpuRelax();
+            }
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+};
+
+// Every class below has lock(), try_lock() and unlock(), so it works with
+// std::lock_guard, std::unique_lock (including try_to_lock / defer_lock) and
+// std::scoped_lock exactly like std::mutex.
+
+// ------------------------------------------------------------------------------
+// Test-and-test-and-set spinlock with exponential backoff.
+// Waiters spin on a plain load (served from their own cached copy) and only try
+// the exchange once the lock looks free. Unfair, but the cheapest uncontended
+// path of all.
+// ------------------------------------------------------------------------------
+class TtasSpinlock {
+private:
+    static constexpr std::uint32_t kMaxBackoff = 1024;
+
+    alignas(kCacheLineSize) std::atomic<bool> locked{false};
+
+public:
+    void lock() {
+        std::uint32_t backoff = 1;
+        SpinWait spinner;
+        while (locked.exchange(true, std::memory_order_acquire)) {
+            while (locked.load(std::memory_order_relaxed)) {
+                spinner.wait(backoff);
+                if (backoff < kMaxBackoff) {
+                    backoff *= 2;
+                }
+            }
+        }
+    }
+
+    bool try_lock() {
+        return !locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock() {
+        locked.store(false, std::memory_order_release);
+    }
+};
+
+// ------------------------------------------------------------------------------
+// Ticket lock: threads take a number and are served in FIFO order.
+// Fair, but every waiter still spins on the same `serving` cache line.
+// ------------------------------------------------------------------------------
+class TicketLock {
+private:
+    alignas(kCacheLineSize) std::atomic<std::uint32_t> next{0};
+    alignas(kCacheLineSize) std::atomic<std::uint32_t> serving{0};
+
+public:
+    void lock() {
+        const std::uint32_t ticket = next.fetch_add(1, std::memory_order_relaxed);
+        SpinWait spinner;
+        for (;;) {
+            const std::uint32_t current = serving.load(std::memory_order_acquire);
+            if (current == ticket) {
+                return;
+            }
+            // Back off in proportion to our place in the queue.
+            spinner.wait(ticket - current);
+        }
+    }
+
+    bool try_lock() {
+        std::uint32_t current = serving.load(std::memory_order_acquire);
+        std::uint32_t expected = current;
+        // Only take a ticket if it would be served immediately.
+        return next.compare_exchange_strong(expected, current + 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock() {
+        serving.store(serving.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+};
+
+// ------------------------------------------------------------------------------
+// MCS queue lock: each waiter spins on a flag in its own queue node, so a
+// release touches exactly one other core's cache line. FIFO like the ticket
+// lock, but scales to many waiters.
+//
+// lock()/unlock() take no arguments, so queue nodes come from a small
+// thread-local pool; a thread may hold up to kMaxHeld MCS locks at once.
+// ------------------------------------------------------------------------------
+class McsLock {
+private:
+    struct alignas(kCacheLineSize) Node {
+        std::atomic<Node*> next{nullptr};
+        std::atomic<bool> waiting{false};
+        bool inUse = false; // only touched by the owning thread
+    };
+
+    static constexpr std::size_t kMaxHeld = 8;
+
+    alignas(kCacheLineSize) std::atomic<Node*> tail{nullptr};
+    Node* holder = nullptr; // written only while the lock is held
+
+    static Node* acquireNode() {
+        thread_local Node pool[kMaxHeld];
+        for (auto& node : pool) {
+            if (!node.inUse) {
+                node.inUse = true;
+                node.next.store(nullptr, std::memory_order_relaxed);
+                node.waiting.store(true, std::memory_order_relaxed);
+                return &node;
+            }
+        }
+        // Holding more than kMaxHeld MCS locks on one thread is a usage error.
+        std::abort();
+    }
+
+    static void releaseNode(Node* node) {
+        node->inUse = false;
+    }
+
+public:
+    void lock() {
+        Node* node = acquireNode();
+        Node* prev = tail.exchange(node, std::memory_order_acq_rel);
+        if (prev != nullptr) {
+            prev->next.store(node, std::memory_order_release);
+            SpinWait spinner;
+            while (node->waiting.load(std::memory_order_acquire)) {
+                spinner.wait();
+            }
+        }
+        holder = node;
+    }
+
+    bool try_lock() {
+        Node* node = acquireNode();
+        Node* expected = nullptr;
+        if (tail.compare_exchange_strong(expected, node, std::memory_order_acquire, std::memory_order_relaxed)) {
+            holder = node;
+            return true;
+        }
+        releaseNode(node);
+        return false;
+    }
+
+    void unlock() {
+        Node* node = holder;
+        Node* successor = node->next.load(std::memory_order_acquire);
+        if (successor == nullptr) {
+            Node* expected = node;
+            if (tail.compare_exchange_strong(expected, nullptr, std::memory_order_release, std::memory_order_relaxed)) {
+                releaseNode(node);
+                return;
+            }
+            // A new waiter swapped itself into `tail` but has not linked in yet.
+            SpinWait spinner;
+            while ((successor = node->next.load(std::memory_order_acquire)) == nullptr) {
+                spinner.wait();
+            }
+        }
+        successor->waiting.store(false, std::memory_order_release);
+        releaseNode(node);
+    }
+};
+
+// ------------------------------------------------------------------------------
+// Adaptive mutex: spin briefly in user space, then park in the kernel.
+// Short critical sections are usually over before the spin budget runs out,
+// so the futex syscalls are only paid under real contention.
+//
+// state: 0 = unlocked, 1 = locked, 2 = locked and someone may be parked.
+// ------------------------------------------------------------------------------
+class AdaptiveMutex {
+private:
+    static constexpr int kSpinLimit = 100;
+
+    alignas(kCacheLineSize) std::atomic<std::uint32_t> state{0};
+
+    // Implemented with futex(2) on Linux and std::atomic::wait elsewhere (locks.cpp).
+    void park();
+    void unparkOne();
+
+public:
+    void lock() {
+        for (int i = 0; i < kSpinLimit; ++i) {
+            std::uint32_t expected = 0;
+            if (state.compare_exchange_weak(expected, 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+            if (expected == 2) {
+                break; // others are already parked, don't jump the queue by spinning
+            }
+            cpuRelax();
+        }
+        while (state.exchange(2, std::memory_order_acquire) != 0) {
+            park();
+        }
+    }
+
+    bool try_lock() {
+        std::uint32_t expected = 0;
+        return state.compare_exchange_strong(expected, 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock() {
+        if (state.exchange(0, std::memory_order_release) == 2) {
+            unparkOne();
+        }
+    }
+};
+
+#endif // LOCKS_H
@@ -0,0 +1,76 @@
+// log_ring.h - Asynchronous logger backed by a lock-free MPSC ring buffer
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include "cache_line.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+// What to do when producers outrun the background writer.
+enum class OverflowPolicy {
+    Drop,  // discard the record and count it in dropped()
+    Block, // spin/yield until a slot frees up
+};
+
+// Copied into the ring by the producer; formatted later by the writer thread
+// as "<label> -> <value>". The label must outlive the logger (a string literal).
+struct LogRecord {
+    const char* label;
+    long value;
+};
+
+// Producers only copy a LogRecord into a slot (a few atomic operations, no
+// locks, no system calls), so logging from inside a critical section no longer
+// stretches the time the lock is held. A single background thread formats the
+// records and writes them out in batches with one flush per batch.
+class LogRing {
+private:
+    struct alignas(kCacheLineSize) Cell {
+        std::atomic<std::uint64_t> sequence;
+        LogRecord record;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    const std::uint64_t mask;
+    const OverflowPolicy policy;
+    std::ostream& out;
+
+    alignas(kCacheLineSize) std::atomic<std::uint64_t> tail{0}; // next slot to claim (producers)
+    alignas(kCacheLineSize) std::atomic<std::uint64_t> written{0}; // records already written out
+    std::uint64_t head = 0;                                         // next slot to read, writer thread only
+    alignas(kCacheLineSize) std::atomic<std::uint64_t> droppedCount{0};
+    std::atomic<bool> stopping{false};
+
+    std::thread writer;
+
+    bool tryPush(const LogRecord& record);
+    void run();
+    std::size_t drainBatch();
+
+public:
+    // capacity is rounded up to a power of two.
+    explicit LogRing(std::size_t capacity = 1024, OverflowPolicy policy = OverflowPolicy::Drop, std::ostream& out = std::cout);
+
+    // Writes out everything still queued, then stops the writer thread.
+    ~LogRing();
+
+    LogRing(const LogRing&) = delete;
+    LogRing& operator=(const LogRing&) = delete;
+
+    // Returns false if the record was dropped (Drop policy, ring full).
+    bool log(const char* label, long value);
+
+    // Blocks until every record logged before the call has been written.
+    void flush();
+
+    std::uint64_t dropped() const {
+        return droppedCount.load(std::memory_order_relaxed);
+    }
+};
+
+#endif // LOG_RING_H
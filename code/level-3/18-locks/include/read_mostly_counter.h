@@ -0,0 +1,63 @@
+// read_mostly_counter.h - Counters for workloads that mostly read the value
+#ifndef READ_MOSTLY_COUNTER_H
+#define READ_MOSTLY_COUNTER_H
+
+#include "seqlock.h"
+
+#include <mutex>
+#include <shared_mutex>
+
+// Baseline: every read takes the same exclusive lock as a write.
+class ExclusiveCounter {
+private:
+    mutable std::mutex m;
+    int value = 0;
+
+public:
+    void add(int delta) {
+        std::lock_guard<std::mutex> lock(m);
+        value += delta;
+    }
+
+    int load() const {
+        std::lock_guard<std::mutex> lock(m);
+        return value;
+    }
+};
+
+// Readers share the lock with each other and only exclude writers. Each read
+// still increments/decrements the reader count, so readers do write to one
+// shared cache line.
+class SharedMutexCounter {
+private:
+    mutable std::shared_mutex m;
+    int value = 0;
+
+public:
+    void add(int delta) {
+        std::unique_lock<std::shared_mutex> lock(m);
+        value += delta;
+    }
+
+    int load() const {
+        std::shared_lock<std::shared_mutex> lock(m);
+        return value;
+    }
+};
+
+// Readers only load the sequence number and the value, they never write.
+class SeqLockCounter {
+private:
+    SeqLock<int> value;
+
+public:
+    void add(int delta) {
+        value.update([delta](int current) { return current + delta; });
+    }
+
+    int load() const {
+        return value.load();
+    }
+};
+
+#endif // READ_MOSTLY_COUNTER_H
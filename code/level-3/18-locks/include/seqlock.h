@@ -0,0 +1,96 @@
+// seqlock.h - Sequence lock: readers never write shared memory
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include "cache_line.h"
+#include "locks.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+// A writer makes `sequence` odd, updates the value, then makes it even again.
+// A reader copies the value and retries if the sequence was odd or changed
+// in the meantime. Readers therefore never touch a shared cache line for
+// writing (unlike a reader count in std::shared_mutex), so any number of them
+// scale perfectly; the price is that a reader can spin while a write is in
+// progress. Best for small values that are read far more often than written.
+//
+// The value is stored as relaxed atomic words so that a torn read (which the
+// sequence check then discards) is not a data race.
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock copies T byte-wise");
+
+private:
+    static constexpr std::size_t kWords = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    alignas(kCacheLineSize) std::atomic<std::uint64_t> sequence{0};
+    std::atomic<std::uint64_t> words[kWords]{};
+    std::mutex writers; // writers still exclude each other
+
+    void storeWords(const T& value) {
+        std::uint64_t raw[kWords]{};
+        std::memcpy(raw, &value, sizeof(T));
+        for (std::size_t i = 0; i < kWords; ++i) {
+            words[i].store(raw[i], std::memory_order_relaxed);
+        }
+    }
+
+public:
+    explicit SeqLock(const T& initial = T{}) {
+        storeWords(initial);
+    }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    T load() const {
+        std::uint64_t raw[kWords];
+        SpinWait spinner;
+        for (;;) {
+            const std::uint64_t before = sequence.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                for (std::size_t i = 0; i < kWords; ++i) {
+                    raw[i] = words[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == before) {
+                    break;
+                }
+            }
+            spinner.wait();
+        }
+        T value;
+        std::memcpy(&value, raw, sizeof(T));
+        return value;
+    }
+
+    // Read-modify-write under the writer lock: update(fn) stores fn(current).
+    template <typename Fn>
+    void update(Fn fn) {
+        std::lock_guard<std::mutex> lock(writers);
+        std::uint64_t raw[kWords];
+        for (std::size_t i = 0; i < kWords; ++i) {
+            raw[i] = words[i].load(std::memory_order_relaxed);
+        }
+        T current;
+        std::memcpy(&current, raw, sizeof(T));
+        const T next = fn(current);
+
+        const std::uint64_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed); // odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        storeWords(next);
+        sequence.store(seq + 2, std::memory_order_release); // even: stable again
+    }
+
+    void store(const T& value) {
+        update([&](const T&) { return value; });
+    }
+};
+
+#endif // SEQLOCK_H
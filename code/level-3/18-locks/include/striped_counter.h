@@ -0,0 +1,76 @@
+// striped_counter.h - Counter split into per-thread slots
+#ifndef STRIPED_COUNTER_H
+#define STRIPED_COUNTER_H
+
+#include "cache_line.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+// Each thread adds to its own slot, so writers never share a lock or (when the
+// slots are padded) a cache line. Reading sums every slot, which is cheap when
+// reads are rare compared to writes.
+//
+// SlotAlign controls the padding: kCacheLineSize gives one slot per line,
+// alignof(std::atomic<long>) packs the slots together to show false sharing.
+template <std::size_t SlotAlign>
+class BasicStripedCounter {
+private:
+    struct alignas(SlotAlign) Slot {
+        std::atomic<long> value{0};
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    std::size_t count;
+
+    // Threads get consecutive ids on first use and keep them, and the ids are
+    // shared by every counter with the same SlotAlign. Threads never collide
+    // on a slot only while at most `count` threads have ever called add() on
+    // such a counter in this process; after that, ids wrap modulo `count`.
+    static std::size_t threadId() {
+        static std::atomic<std::size_t> nextId{0};
+        thread_local std::size_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+public:
+    explicit BasicStripedCounter(std::size_t stripes = std::thread::hardware_concurrency())
+        : slots(std::make_unique<Slot[]>(stripes == 0 ? 1 : stripes))
+        , count(stripes == 0 ? 1 : stripes) {}
+
+    BasicStripedCounter(const BasicStripedCounter&) = delete;
+    BasicStripedCounter& operator=(const BasicStripedCounter&) = delete;
+
+    void add(long delta) {
+        slots[threadId() % count].value.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    void increment() {
+        add(1);
+    }
+
+    void decrement() {
+        add(-1);
+    }
+
+    // Sum of all slots. Concurrent writers may or may not be included, but
+    // once they have been joined the result is exact.
+    long load() const {
+        long sum = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            sum += slots[i].value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+    std::size_t stripes() const {
+        return count;
+    }
+};
+
+using StripedCounter = BasicStripedCounter<kCacheLineSize>;
+using PackedStripedCounter = BasicStripedCounter<alignof(std::atomic<long>)>;
+
+#endif // STRIPED_COUNTER_H
@@ -0,0 +1,269 @@
+// thread_pool.h - Work-stealing thread pool
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "cache_line.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Type-erased, move-only unit of work (std::function needs copyable callables,
+// std::packaged_task is move-only).
+class Task {
+public:
+    virtual ~Task() = default;
+    virtual void run() = 0;
+};
+
+template <typename F>
+class CallableTask : public Task {
+private:
+    F fn;
+
+public:
+    explicit CallableTask(F&& f)
+        : fn(std::move(f)) {}
+
+    void run() override {
+        fn();
+    }
+};
+
+// ------------------------------------------------------------------------------
+// Chase-Lev work-stealing deque (Le, Pop, Cohen, Zappa Nardelli, PPoPP 2013).
+// The owner pushes and pops at the bottom without any lock; thieves take from
+// the top with a single CAS. Only the last remaining element is contended.
+// ------------------------------------------------------------------------------
+template <typename T>
+class ChaseLevDeque {
+    static_assert(std::is_trivially_copyable_v<T>, "elements are copied through std::atomic");
+
+private:
+    struct Array {
+        std::int64_t capacity;
+        std::unique_ptr<std::atomic<T>[]> slots;
+
+        explicit Array(std::int64_t cap)
+            : capacity(cap)
+            , slots(std::make_unique<std::atomic<T>[]>(static_cast<std::size_t>(cap))) {}
+
+        T get(std::int64_t i) const {
+            return slots[static_cast<std::size_t>(i & (capacity - 1))].load(std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t i, T value) {
+            slots[static_cast<std::size_t>(i & (capacity - 1))].store(value, std::memory_order_relaxed);
+        }
+    };
+
+    alignas(kCacheLineSize) std::atomic<std::int64_t> top{0};
+    alignas(kCacheLineSize) std::atomic<std::int64_t> bottom{0};
+    std::atomic<Array*> array;
+
+    // Thieves may still be reading an old array after a resize, so retired
+    // arrays are only freed together with the deque.
+    std::vector<std::unique_ptr<Array>> arrays;
+
+    Array* grow(Array* old, std::int64_t b, std::int64_t t) {
+        auto bigger = std::make_unique<Array>(old->capacity * 2);
+        for (std::int64_t i = t; i < b; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        Array* raw = bigger.get();
+        arrays.push_back(std::move(bigger));
+        array.store(raw, std::memory_order_release);
+        return raw;
+    }
+
+public:
+    explicit ChaseLevDeque(std::int64_t capacity = 256) {
+        arrays.push_back(std::make_unique<Array>(capacity));
+        array.store(arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+    // Owner thread only.
+    void push(T value) {
+        std::int64_t b = bottom.load(std::memory_order_relaxed);
+        std::int64_t t = top.load(std::memory_order_acquire);
+        Array* a = array.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1) {
+            a = grow(a, b, t);
+        }
+        a->put(b, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Owner thread only. Returns false if the deque is empty.
+    bool pop(T& out) {
+        std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Array* a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        out = a->get(b);
+        if (t == b) {
+            // Last element: race the thieves for it.
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // Any thread. Returns false if empty or another thief won the race.
+    bool steal(T& out) {
+        std::int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        Array* a = array.load(std::memory_order_acquire);
+        T value = a->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return false;
+        }
+        out = value;
+        return true;
+    }
+
+    bool empty() const {
+        return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+    }
+};
+
+// ------------------------------------------------------------------------------
+// Work-stealing thread pool.
+//
+// Threads are created once and reused. A task submitted from a worker goes to
+// that worker's own deque (hot in its cache, no shared lock); tasks from other
+// threads go to a shared injection queue. Idle workers steal from the others
+// before they go to sleep.
+//
+// Don't block a worker on a future of another task from the same pool unless
+// you know a free worker will run it; use parallel_for, which helps run tasks
+// while it waits.
+// ------------------------------------------------------------------------------
+class ThreadPool {
+private:
+    struct alignas(kCacheLineSize) Worker {
+        ChaseLevDeque<Task*> deque;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    std::mutex injectionMutex;
+    std::deque<Task*> injection;
+
+    // Sleeping: `epoch` changes on every submit, a worker sleeps only if it
+    // has not changed since it last looked for work.
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<std::uint64_t> epoch{0};
+    std::atomic<int> sleeping{0};
+    std::atomic<bool> stopping{false};
+
+    void enqueue(Task* task);
+    bool findTask(Task*& task, std::size_t self);
+    void workerLoop(std::size_t index);
+
+    // Index of the calling worker in this pool, or workers.size() if the
+    // caller is not one of our workers.
+    std::size_t currentWorker() const;
+
+public:
+    explicit ThreadPool(std::size_t threads = std::max(1u, std::thread::hardware_concurrency()));
+
+    // Runs every task still queued, then joins the workers.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template <typename F>
+    auto submit(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        std::packaged_task<Result()> packaged(std::forward<F>(fn));
+        std::future<Result> future = packaged.get_future();
+        enqueue(new CallableTask<std::packaged_task<Result()>>(std::move(packaged)));
+        return future;
+    }
+
+    // Calls body(i) for every i in [begin, end), split into chunks of `grain`
+    // indices. The calling thread runs pool tasks while it waits. The first
+    // exception thrown by body is rethrown here after all chunks finished.
+    template <typename Body>
+    void parallel_for(std::size_t begin, std::size_t end, Body body, std::size_t grain = 1024);
+
+    // Runs one queued task on the calling thread, if there is one.
+    bool runPendingTask();
+
+    std::size_t size() const {
+        return workers.size();
+    }
+};
+
+template <typename Body>
+void ThreadPool::parallel_for(std::size_t begin, std::size_t end, Body body, std::size_t grain) {
+    if (begin >= end) {
+        return;
+    }
+    grain = std::max<std::size_t>(grain, 1);
+
+    std::atomic<std::size_t> remaining{(end - begin + grain - 1) / grain};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    for (std::size_t chunk = begin; chunk < end; chunk += grain) {
+        const std::size_t chunkEnd = std::min(end, chunk + grain);
+        auto run = [&, chunk, chunkEnd] {
+            try {
+                for (std::size_t i = chunk; i < chunkEnd; ++i) {
+                    body(i);
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            remaining.fetch_sub(1, std::memory_order_acq_rel);
+        };
+        enqueue(new CallableTask<decltype(run)>(std::move(run)));
+    }
+
+    while (remaining.load(std::memory_order_acquire) != 0) {
+        if (!runPendingTask()) {
+            std::this_thread::yield();
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+#endif // THREAD_POOL_H
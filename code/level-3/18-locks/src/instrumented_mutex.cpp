@@ -0,0 +1,287 @@
+#include "instrumented_mutex.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+bool LockSiteKey::operator==(const LockSiteKey& other) const {
+    // The same file name can be a different literal in different translation units.
+    return line == other.line && (file == other.file || std::strcmp(file, other.file) == 0);
+}
+
+void DurationHistogram::merge(const DurationHistogram& other) {
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    totalNs += other.totalNs;
+    maxNs = std::max(maxNs, other.maxNs);
+}
+
+std::uint64_t DurationHistogram::quantileNs(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    const auto target = static_cast<std::uint64_t>(q * static_cast<double>(count - 1)) + 1;
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= target) {
+            return std::min(i == 0 ? 0 : (std::uint64_t{1} << i) - 1, maxNs);
+        }
+    }
+    return maxNs;
+}
+
+void LockSiteStats::merge(const LockSiteStats& other) {
+    wait.merge(other.wait);
+    hold.merge(other.hold);
+    contended += other.contended;
+    tryLockFailures += other.tryLockFailures;
+}
+
+namespace {
+    struct SiteEntry {
+        LockSiteKey key;
+        LockSiteStats stats;
+    };
+
+    void mergeInto(std::vector<SiteEntry>& into, const LockSiteKey& key, const LockSiteStats& stats) {
+        for (auto& existing : into) {
+            if (existing.key == key) {
+                existing.stats.merge(stats);
+                return;
+            }
+        }
+        into.push_back(SiteEntry{key, stats});
+    }
+
+    // Counters below have a single writer (the owning thread) and are read by
+    // report(), so a relaxed load + store is enough: no locked instruction.
+    void bump(std::atomic<std::uint64_t>& counter, std::uint64_t by = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    struct ThreadHistogram {
+        std::array<std::atomic<std::uint64_t>, std::tuple_size_v<decltype(DurationHistogram::buckets)>> buckets{};
+        std::atomic<std::uint64_t> totalNs{0};
+        std::atomic<std::uint64_t> maxNs{0};
+
+        void record(std::uint64_t ns) {
+            const auto bucket = std::min<std::size_t>(static_cast<std::size_t>(std::bit_width(ns)), buckets.size() - 1);
+            bump(buckets[bucket]);
+            bump(totalNs, ns);
+            if (ns > maxNs.load(std::memory_order_relaxed)) {
+                maxNs.store(ns, std::memory_order_relaxed);
+            }
+        }
+
+        DurationHistogram snapshot() const {
+            DurationHistogram h;
+            for (std::size_t i = 0; i < buckets.size(); ++i) {
+                h.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+                h.count += h.buckets[i];
+            }
+            h.totalNs = totalNs.load(std::memory_order_relaxed);
+            h.maxNs = maxNs.load(std::memory_order_relaxed);
+            return h;
+        }
+    };
+
+    struct ThreadSite {
+        LockSiteKey key{};
+        ThreadHistogram wait;
+        ThreadHistogram hold;
+        std::atomic<std::uint64_t> contended{0};
+        std::atomic<std::uint64_t> tryLockFailures{0};
+
+        LockSiteStats snapshot() const {
+            LockSiteStats s;
+            s.wait = wait.snapshot();
+            s.hold = hold.snapshot();
+            s.contended = contended.load(std::memory_order_relaxed);
+            s.tryLockFailures = tryLockFailures.load(std::memory_order_relaxed);
+            return s;
+        }
+    };
+
+    struct ThreadTable;
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<ThreadTable*> live;
+        std::vector<SiteEntry> retired; // stats of threads that already exited
+    };
+
+    // Intentionally leaked: thread-local tables and the atexit report may use it
+    // after static destructors have run.
+    Registry& registry() {
+        static Registry* instance = new Registry;
+        return *instance;
+    }
+
+    const char* const kOtherSites = "(other sites)";
+
+    // One per thread, written only by that thread. Fixed-size so report() can
+    // read it while the owner adds sites; sites beyond the capacity share the
+    // last slot.
+    struct ThreadTable {
+        static constexpr std::size_t kMaxSites = 32;
+
+        std::array<ThreadSite, kMaxSites> sites;
+        std::atomic<std::size_t> used{0};
+
+        ThreadTable() {
+            std::lock_guard<std::mutex> lock(registry().mutex);
+            registry().live.push_back(this);
+        }
+
+        ~ThreadTable() {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            mergeTo(r.retired);
+            r.live.erase(std::find(r.live.begin(), r.live.end(), this));
+        }
+
+        void mergeTo(std::vector<SiteEntry>& into) const {
+            const std::size_t n = used.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < n; ++i) {
+                mergeInto(into, sites[i].key, sites[i].snapshot());
+            }
+        }
+
+        // Few sites per thread, so a linear scan on pointer identity is fine.
+        ThreadSite& find(const LockSiteKey& key) {
+            const std::size_t n = used.load(std::memory_order_relaxed);
+            for (std::size_t i = 0; i < n; ++i) {
+                if (sites[i].key.line == key.line && sites[i].key.file == key.file) {
+                    return sites[i];
+                }
+            }
+            if (n == kMaxSites - 1) {
+                sites[n].key = LockSiteKey{kOtherSites, 0};
+            }
+            else if (n == kMaxSites) {
+                return sites[kMaxSites - 1];
+            }
+            else {
+                sites[n].key = key;
+            }
+            used.store(n + 1, std::memory_order_release); // publishes the key to report()
+            return sites[n];
+        }
+    };
+
+    ThreadTable& threadTable() {
+        thread_local ThreadTable table;
+        return table;
+    }
+
+    std::uint64_t nanosBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+    }
+
+    // "p50/p99/max"
+    std::string summary(const DurationHistogram& h) {
+        std::string text = std::to_string(h.quantileNs(0.5));
+        text += '/';
+        text += std::to_string(h.quantileNs(0.99));
+        text += '/';
+        text += std::to_string(h.maxNs);
+        return text;
+    }
+
+    const char* baseName(const char* path) {
+        const char* base = path;
+        for (const char* p = path; *p != '\0'; ++p) {
+            if (*p == '/' || *p == '\\') {
+                base = p + 1;
+            }
+        }
+        return base;
+    }
+} // namespace
+
+// An uncontended acquisition costs one clock read (lockedAt); the wait time is
+// only measured when the first try_lock fails.
+void InstrumentedMutex::acquired(const LockSiteKey& site, std::uint64_t waitNs, bool contended) {
+    lockedAt = std::chrono::steady_clock::now();
+    holderSite = site;
+    holder.store(std::this_thread::get_id(), std::memory_order_relaxed);
+
+    ThreadSite& stats = threadTable().find(site);
+    stats.wait.record(waitNs);
+    if (contended) {
+        bump(stats.contended);
+    }
+}
+
+void InstrumentedMutex::lock(const LockSiteKey& site) {
+    if (m.try_lock()) {
+        acquired(site, 0, false);
+        return;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    m.lock();
+    acquired(site, nanosBetween(start, std::chrono::steady_clock::now()), true);
+}
+
+bool InstrumentedMutex::try_lock(const LockSiteKey& site) {
+    if (m.try_lock()) {
+        acquired(site, 0, false);
+        return true;
+    }
+    bump(threadTable().find(site).tryLockFailures);
+    return false;
+}
+
+void InstrumentedMutex::unlock() {
+    // Copy out before unlocking: the next owner overwrites these.
+    const std::uint64_t held = nanosBetween(lockedAt, std::chrono::steady_clock::now());
+    const LockSiteKey site = holderSite;
+    holder.store(std::thread::id{}, std::memory_order_relaxed);
+    m.unlock();
+
+    threadTable().find(site).hold.record(held);
+}
+
+void InstrumentedMutex::report(std::ostream& out) {
+    std::vector<SiteEntry> merged;
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        merged = r.retired;
+        for (const ThreadTable* table : r.live) {
+            table->mergeTo(merged);
+        }
+    }
+
+    // Hottest sites (most total wait time) first.
+    std::sort(merged.begin(), merged.end(), [](const SiteEntry& a, const SiteEntry& b) { return a.stats.wait.totalNs > b.stats.wait.totalNs; });
+
+    out << std::left << std::setw(32) << "lock site" << std::right << std::setw(10) << "locks" << std::setw(11) << "contended" << std::setw(10) << "try_fail"
+        << std::setw(26) << "wait p50/p99/max ns" << std::setw(26) << "hold p50/p99/max ns" << "\n";
+    for (const auto& entry : merged) {
+        const LockSiteStats& s = entry.stats;
+        std::string site = baseName(entry.key.file);
+        if (entry.key.line != 0) {
+            site += ':';
+            site += std::to_string(entry.key.line);
+        }
+        const std::string wait = summary(s.wait);
+        const std::string hold = summary(s.hold);
+        out << std::left << std::setw(32) << site << std::right << std::setw(10) << s.wait.count << std::setw(11) << s.contended << std::setw(10)
+            << s.tryLockFailures << std::setw(26) << wait << std::setw(26) << hold << "\n";
+    }
+}
+
+void InstrumentedMutex::reportAtExit() {
+    static std::once_flag once;
+    std::call_once(once, [] { std::atexit([] { report(std::cerr); }); });
+}
@@ -0,0 +1,27 @@
+#include "locks.h"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "futex needs a plain 32-bit word");
+
+// Sleep while the state is still 2 (locked with waiters). A spurious or
+// stale wake-up is fine: lock() re-checks the state in a loop.
+void AdaptiveMutex::park() {
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&state), FUTEX_WAIT_PRIVATE, 2u, nullptr, nullptr, 0);
+#else
+    state.wait(2, std::memory_order_relaxed);
+#endif
+}
+
+void AdaptiveMutex::unparkOne() {
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&state), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+    state.notify_one();
+#endif
+}
@@ -0,0 +1,125 @@
+#include "log_ring.h"
+
+#include <chrono>
+#include <string>
+
+namespace {
+    std::size_t roundUpToPowerOfTwo(std::size_t n) {
+        std::size_t power = 1;
+        while (power < n) {
+            power <<= 1;
+        }
+        return power;
+    }
+} // namespace
+
+LogRing::LogRing(std::size_t capacity, OverflowPolicy policy, std::ostream& out)
+    : cells(std::make_unique<Cell[]>(roundUpToPowerOfTwo(capacity < 2 ? 2 : capacity)))
+    , mask(roundUpToPowerOfTwo(capacity < 2 ? 2 : capacity) - 1)
+    , policy(policy)
+    , out(out) {
+    // Cell i is free for the producer that claims position i.
+    for (std::uint64_t i = 0; i <= mask; ++i) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    writer = std::thread(&LogRing::run, this);
+}
+
+LogRing::~LogRing() {
+    stopping.store(true, std::memory_order_release);
+    writer.join();
+}
+
+// Bounded MPMC queue by Dmitry Vyukov, used with a single consumer. A cell's
+// sequence equals the position that may write it next; the producer publishes
+// by storing position + 1, the consumer frees it with position + capacity.
+bool LogRing::tryPush(const LogRecord& record) {
+    std::uint64_t pos = tail.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& cell = cells[pos & mask];
+        std::uint64_t sequence = cell.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::int64_t>(sequence - pos);
+        if (diff == 0) {
+            if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.record = record;
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            return false; // full: the writer has not freed this cell yet
+        }
+        else {
+            pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool LogRing::log(const char* label, long value) {
+    const LogRecord record{label, value};
+    if (tryPush(record)) {
+        return true;
+    }
+    if (policy == OverflowPolicy::Drop) {
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    while (!tryPush(record)) {
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+// Formats every record that is ready into one string and writes it with a
+// single flush. Returns the number of records written.
+std::size_t LogRing::drainBatch() {
+    std::string batch;
+    std::size_t count = 0;
+    for (;;) {
+        Cell& cell = cells[head & mask];
+        if (cell.sequence.load(std::memory_order_acquire) != head + 1) {
+            break; // empty, or the producer has claimed but not yet filled it
+        }
+        const LogRecord record = cell.record;
+        cell.sequence.store(head + mask + 1, std::memory_order_release);
+        ++head;
+        ++count;
+
+        batch += record.label;
+        batch += " -> ";
+        batch += std::to_string(record.value);
+        batch += '\n';
+    }
+    if (count > 0) {
+        out.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+        out.flush();
+        written.store(head, std::memory_order_release);
+    }
+    return count;
+}
+
+void LogRing::run() {
+    auto idle = std::chrono::microseconds(1);
+    for (;;) {
+        if (drainBatch() > 0) {
+            idle = std::chrono::microseconds(1);
+            continue;
+        }
+        if (stopping.load(std::memory_order_acquire)) {
+            drainBatch(); // records pushed between the last drain and stop
+            return;
+        }
+        // Back off while idle so an unused logger costs next to nothing.
+        std::this_thread::sleep_for(idle);
+        if (idle < std::chrono::milliseconds(1)) {
+            idle *= 2;
+        }
+    }
+}
+
+void LogRing::flush() {
+    const std::uint64_t target = tail.load(std::memory_order_acquire);
+    while (written.load(std::memory_order_acquire) < target) {
+        std::this_thread::yield();
+    }
+}
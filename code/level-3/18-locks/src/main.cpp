@@ -1,51 +1,156 @@
+#include "atomic_counter.h"
+#include "flat_combining.h"
+#include "instrumented_mutex.h"
+#include "locks.h"
+#include "log_ring.h"
+#include "read_mostly_counter.h"
+#include "striped_counter.h"
+#include "thread_pool.h"
+
 #include <chrono>
 #include <iostream>
 #include <mutex>
 #include <thread>
 
-std::mutex m;
 int counter = 0;
 
-void increment() {
-    std::lock_guard<std::mutex> lock(m);
+// Writing to std::cout while holding the lock would make the critical section
+// as long as the formatting plus a write syscall. Instead the record is copied
+// into a lock-free ring and a background thread prints it.
+LogRing logger(1024, OverflowPolicy::Block);
+
+// Threads are created once here and reused by every example below, instead of
+// paying for a new std::thread per task.
+ThreadPool pool(4);
+
+// Every function works with any Lockable type (lock / try_lock / unlock),
+// not just std::mutex: lock_guard and unique_lock only need those three.
+template <typename Mutex>
+void increment(Mutex& m) {
+    std::lock_guard<Mutex> lock(m);
     ++counter;
-    std::cout << "increment -> " << counter << "\n";
+    logger.log("increment", counter);
 }
 
-void decrement() {
-    std::unique_lock<std::mutex> lock(m);
+template <typename Mutex>
+void decrement(Mutex& m) {
+    std::unique_lock<Mutex> lock(m);
     --counter;
-    std::cout << "decrement -> " << counter << "\n";
+    logger.log("decrement", counter);
     lock.unlock();
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
 }
 
-void try_increment() {
-    std::unique_lock<std::mutex> lock(m, std::try_to_lock);
+template <typename Mutex>
+void try_increment(Mutex& m) {
+    std::unique_lock<Mutex> lock(m, std::try_to_lock);
     if (!lock) {
         // try_increment -> busy, skipped
         return;
     }
     ++counter;
-    std::cout << "try_increment -> " << counter << "\n";
+    logger.log("try_increment", counter);
 }
 
-void deferred_increment() {
-    std::unique_lock<std::mutex> lock(m, std::defer_lock);
+template <typename Mutex>
+void deferred_increment(Mutex& m) {
+    std::unique_lock<Mutex> lock(m, std::defer_lock);
     std::this_thread::sleep_for(std::chrono::milliseconds(50)); // prep work
     lock.lock();
     ++counter;
-    std::cout << "deferred_increment -> " << counter << "\n";
+    logger.log("deferred_increment", counter);
+}
+
+template <typename Mutex>
+void run_all(const char* name) {
+    std::cout << "--- " << name << " ---\n";
+    Mutex m;
+    counter = 0;
+
+    auto t1 = pool.submit([&] { increment(m); });
+    auto t2 = pool.submit([&] { deferred_increment(m); });
+    auto t3 = pool.submit([&] { decrement(m); });
+    auto t4 = pool.submit([&] { try_increment(m); });
+
+    t1.get();
+    t2.get();
+    t3.get();
+    t4.get();
+    logger.flush();
 }
 
+// Lock-free: every operation is one atomic read-modify-write, nothing is skipped.
+AtomicCounter<> atomic_counter;
+
+void atomic_increment() {
+    int value = atomic_counter.increment();
+    logger.log("atomic_increment", value);
+}
+
+void atomic_decrement() {
+    int value = atomic_counter.decrement();
+    logger.log("atomic_decrement", value);
+}
+
+void atomic_try_increment() {
+    int value = atomic_counter.try_increment(); // CAS loop, never gives up
+    logger.log("atomic_try_increment", value);
+}
+
+// Flat combining: a busy lock means "the holder applies it for me", not "skip".
+FlatCombiningCounter<> combining;
+
+// Read-mostly: readers share the lock (shared_mutex) or take none (seqlock).
+SharedMutexCounter shared_counter;
+SeqLockCounter seqlock_counter;
+
+template <typename Counter>
+void read_mostly(Counter& c, std::size_t i) {
+    if (i % 10 == 0) {
+        c.add(1); // 1 write ...
+    }
+    else {
+        (void)c.load(); // ... per 9 reads
+    }
+}
+
+// No shared lock at all: each thread bumps its own cache-line-sized slot and
+// the reader sums the slots once the writers are done. One stripe per pool
+// worker.
+StripedCounter striped(4);
+
 int main() {
-    std::thread t1(increment);
-    std::thread t2(deferred_increment);
-    std::thread t3(decrement);
-    std::thread t4(try_increment);
-
-    t1.join();
-    t2.join();
-    t3.join();
-    t4.join();
+    run_all<std::mutex>("std::mutex");
+    run_all<TtasSpinlock>("TtasSpinlock");
+    run_all<TicketLock>("TicketLock");
+    run_all<McsLock>("McsLock");
+    run_all<AdaptiveMutex>("AdaptiveMutex");
+    run_all<InstrumentedMutex>("InstrumentedMutex");
+    InstrumentedMutex::report(std::cout);
+
+    std::cout << "--- AtomicCounter ---\n";
+    auto a1 = pool.submit(atomic_increment);
+    auto a2 = pool.submit(atomic_decrement);
+    auto a3 = pool.submit(atomic_try_increment);
+    a1.get();
+    a2.get();
+    a3.get();
+    logger.flush();
+    std::cout << "atomic_counter -> " << atomic_counter.load() << "\n";
+
+    std::cout << "--- FlatCombiningCounter ---\n";
+    // 3000 increments split into chunks of 100 and spread over the workers.
+    pool.parallel_for(0, 3000, [](std::size_t) { combining.try_increment(); }, 100);
+    std::cout << "combining_counter -> " << combining.load() << " (" << combining.combinedPerAcquisition() << " ops per lock)\n";
+
+    std::cout << "--- Read-mostly counters ---\n";
+    pool.parallel_for(0, 1000, [](std::size_t i) { read_mostly(shared_counter, i); }, 100);
+    pool.parallel_for(0, 1000, [](std::size_t i) { read_mostly(seqlock_counter, i); }, 100);
+    std::cout << "shared_mutex_counter -> " << shared_counter.load() << "\n";
+    std::cout << "seqlock_counter -> " << seqlock_counter.load() << "\n";
+
+    std::cout << "--- StripedCounter ---\n";
+    // 1000 increments per stripe, in chunks of 1000: at least one task per stripe.
+    pool.parallel_for(0, 1000 * striped.stripes(), [](std::size_t) { striped.increment(); }, 1000);
+    std::cout << "striped_counter -> " << striped.load() << " over " << striped.stripes() << " stripes\n";
 }
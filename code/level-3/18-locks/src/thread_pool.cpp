@@ -0,0 +1,116 @@
+#include "thread_pool.h"
+
+namespace {
+    // Which pool (if any) the current thread works for, and its index there.
+    thread_local const ThreadPool* currentPool = nullptr;
+    thread_local std::size_t currentIndex = 0;
+} // namespace
+
+ThreadPool::ThreadPool(std::size_t threads) {
+    threads = std::max<std::size_t>(threads, 1);
+    workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    // Start the threads only once every deque exists, since they steal from each other.
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers[i]->thread = std::thread(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true, std::memory_order_seq_cst);
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker->thread.join();
+    }
+}
+
+std::size_t ThreadPool::currentWorker() const {
+    return currentPool == this ? currentIndex : workers.size();
+}
+
+void ThreadPool::enqueue(Task* task) {
+    const std::size_t self = currentWorker();
+    if (self < workers.size()) {
+        workers[self]->deque.push(task);
+    }
+    else {
+        std::lock_guard<std::mutex> lock(injectionMutex);
+        injection.push_back(task);
+    }
+
+    // Pairs with the sleeping/epoch check in workerLoop: either the sleeper
+    // sees the new epoch, or we see the sleeper and wake it.
+    epoch.fetch_add(1, std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_seq_cst) > 0) {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wake.notify_one();
+    }
+}
+
+bool ThreadPool::findTask(Task*& task, std::size_t self) {
+    if (self < workers.size() && workers[self]->deque.pop(task)) {
+        return true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(injectionMutex);
+        if (!injection.empty()) {
+            task = injection.front();
+            injection.pop_front();
+            return true;
+        }
+    }
+
+    // Start stealing at our neighbour so thieves spread over the victims.
+    const std::size_t count = workers.size();
+    const std::size_t start = self < count ? self + 1 : 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::size_t victim = (start + i) % count;
+        if (victim != self && workers[victim]->deque.steal(task)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::runPendingTask() {
+    Task* task = nullptr;
+    if (!findTask(task, currentWorker())) {
+        return false;
+    }
+    std::unique_ptr<Task> owned(task);
+    owned->run();
+    return true;
+}
+
+void ThreadPool::workerLoop(std::size_t index) {
+    currentPool = this;
+    currentIndex = index;
+
+    for (;;) {
+        const std::uint64_t seen = epoch.load(std::memory_order_seq_cst);
+
+        Task* task = nullptr;
+        if (findTask(task, index)) {
+            std::unique_ptr<Task> owned(task);
+            owned->run();
+            continue;
+        }
+
+        if (stopping.load(std::memory_order_acquire)) {
+            return; // nothing left to run
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleeping.fetch_add(1, std::memory_order_seq_cst);
+        wake.wait(lock, [&] { return epoch.load(std::memory_order_seq_cst) != seen || stopping.load(std::memory_order_acquire); });
+        sleeping.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
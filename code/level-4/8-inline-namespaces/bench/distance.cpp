@@ -0,0 +1,173 @@
+// Batched distance kernels against a loop over distance(), for 2D (v1) and 3D
+// (v2) points, at every SIMD level the CPU supports.
+//
+// Usage: level-4_8-inline-namespaces_distance [points] [queries]
+//
+//   one-to-many  distances(from, to, out)   `points` distances
+//   pairwise     distances(a, b, out)       `points` distances
+//   nearest      nearest(p, candidates)     `queries` searches over `points`
+//
+// Times are per distance, best of five runs. Every result is checked against
+// distance() itself: the run fails if any batch result is more than 2 ULP
+// away (the bound documented in geometry.h; expect 0) or nearest() picks
+// another index.
+
+#include "geometry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+    // Distance in representable doubles between two non-negative values.
+    std::uint64_t ulps(double a, double b) {
+        std::uint64_t ia = 0;
+        std::uint64_t ib = 0;
+        std::memcpy(&ia, &a, sizeof a);
+        std::memcpy(&ib, &b, sizeof b);
+        return ia > ib ? ia - ib : ib - ia;
+    }
+
+    std::uint64_t maxUlps(const std::vector<double>& got, const std::vector<double>& expected) {
+        std::uint64_t worst = 0;
+        for (std::size_t i = 0; i < got.size(); ++i) {
+            worst = std::max(worst, ulps(got[i], expected[i]));
+        }
+        return worst;
+    }
+
+    template <typename Fn>
+    double bestNs(Fn fn, std::size_t distancesPerRun) {
+        fn(); // warm-up
+        double best = 0;
+        for (int run = 0; run < 5; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            best = run == 0 ? elapsed.count() : std::min(best, elapsed.count());
+        }
+        return best / static_cast<double>(distancesPerRun);
+    }
+
+    Geometry::v1::Point randomPoint(std::mt19937_64& rng, Geometry::v1::Point) {
+        std::uniform_real_distribution<double> coordinate(-1000.0, 1000.0);
+        return {coordinate(rng), coordinate(rng)};
+    }
+
+    Geometry::v2::Point randomPoint(std::mt19937_64& rng, Geometry::v2::Point) {
+        std::uniform_real_distribution<double> coordinate(-1000.0, 1000.0);
+        return {coordinate(rng), coordinate(rng), coordinate(rng)};
+    }
+
+    // Benchmarks one point version; returns false on a mismatch.
+    template <typename Point>
+    bool run(const char* label, std::size_t count, std::size_t queryCount) {
+        using namespace Geometry;
+
+        std::mt19937_64 rng(42);
+        std::vector<Point> a(count);
+        std::vector<Point> b(count);
+        std::vector<Point> queries(queryCount);
+        for (std::size_t i = 0; i < count; ++i) {
+            a[i] = randomPoint(rng, Point{});
+            b[i] = randomPoint(rng, Point{});
+        }
+        for (Point& q : queries) {
+            q = randomPoint(rng, Point{});
+        }
+        const Point from = queries[0];
+
+        // Reference results from distance(), one call per pair.
+        std::vector<double> oneToManyRef(count);
+        std::vector<double> pairwiseRef(count);
+        const double loopNs = bestNs(
+            [&] {
+                for (std::size_t i = 0; i < count; ++i) {
+                    pairwiseRef[i] = distance(a[i], b[i]);
+                }
+            },
+            count);
+        for (std::size_t i = 0; i < count; ++i) {
+            oneToManyRef[i] = distance(from, b[i]);
+        }
+        std::vector<Nearest> nearestRef(queryCount);
+        for (std::size_t q = 0; q < queryCount; ++q) {
+            nearestRef[q] = Nearest{0, distance(queries[q], a[0])};
+            for (std::size_t i = 1; i < count; ++i) {
+                double d = distance(queries[q], a[i]);
+                if (d < nearestRef[q].distance) {
+                    nearestRef[q] = Nearest{i, d};
+                }
+            }
+        }
+
+        std::printf("%s, %zu points\n", label, count);
+        std::printf("%-10s %14s %14s %14s %8s\n", "kernel", "1-to-many ns", "pairwise ns", "nearest ns", "max ULP");
+        std::printf("%-10s %14s %14.3f %14s %8s\n", "distance()", "", loopNs, "", "-");
+
+        bool ok = true;
+        std::vector<double> out(count);
+        std::vector<Nearest> found(queryCount);
+        for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512}) {
+            if (level > supportedSimdLevel()) {
+                std::printf("%-10s %14s\n", simdLevelName(level), "n/a");
+                continue;
+            }
+            setSimdLevel(level);
+
+            const double oneToManyNs = bestNs([&] { distances(from, b, out); }, count);
+            std::uint64_t worst = maxUlps(out, oneToManyRef);
+
+            const double pairwiseNs = bestNs([&] { distances(a, b, out); }, count);
+            worst = std::max(worst, maxUlps(out, pairwiseRef));
+
+            const double nearestNs = bestNs(
+                [&] {
+                    for (std::size_t q = 0; q < queryCount; ++q) {
+                        found[q] = nearest(queries[q], a);
+                    }
+                },
+                count * queryCount);
+            for (std::size_t q = 0; q < queryCount; ++q) {
+                worst = std::max(worst, ulps(found[q].distance, nearestRef[q].distance));
+                if (found[q].index != nearestRef[q].index) {
+                    std::fprintf(stderr, "FAILED: %s nearest() picked %zu instead of %zu\n", simdLevelName(level),
+                                 found[q].index, nearestRef[q].index);
+                    ok = false;
+                }
+            }
+
+            std::printf("%-10s %14.3f %14.3f %14.3f %8llu\n", simdLevelName(level), oneToManyNs, pairwiseNs, nearestNs,
+                        static_cast<unsigned long long>(worst));
+            if (worst > 2) {
+                std::fprintf(stderr, "FAILED: %s is %llu ULP away from distance()\n", simdLevelName(level),
+                             static_cast<unsigned long long>(worst));
+                ok = false;
+            }
+        }
+        setSimdLevel(supportedSimdLevel());
+        std::printf("\n");
+        return ok;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    // Odd by default, so every kernel also runs its scalar tail.
+    const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : (1 << 20) + 5;
+    const std::size_t queries = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16;
+
+    if (count == 0 || queries == 0) {
+        std::fprintf(stderr, "points and queries must be positive\n");
+        return 1;
+    }
+
+    std::printf("CPU supports: %s\n\n", Geometry::simdLevelName(Geometry::supportedSimdLevel()));
+    bool ok = run<Geometry::v1::Point>("v1 (2D)", count, queries);
+    ok = run<Geometry::v2::Point>("v2 (3D)", count, queries) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+// All-pairs distance matrix of N 3D points (v2), from a plain double loop to
+// the tiled, symmetric, multi-threaded distanceMatrix().
+//
+// Usage: level-4_8-inline-namespaces_distance_matrix [points] [file]
+//
+//   naive          out[i * N + j] = distance(p[i], p[j]), two loops
+//   rows           distances(p[i], p, row i): SIMD, one whole row at a time
+//   tiled N x M    distanceMatrix(p, p, out) on one thread: tiles, no symmetry
+//   tiled N x N    distanceMatrix(p, out) on one thread: upper tiles mirrored
+//   threads        the same on every hardware thread
+//   squared        the same with Metric::SquaredDistance
+//   file           writeDistanceMatrix(p, file) on every hardware thread, with
+//                  64 MiB windows (file defaults to one in the temp directory,
+//                  removed afterwards)
+//
+// Times are best of three, also given as matrix elements per nanosecond. The
+// run fails if any result differs from distance() (squaredDistance() for
+// squared), including the file read back.
+
+#include "distance_matrix.h"
+#include "geometry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    template <typename Fn>
+    double bestMs(Fn fn) {
+        double best = 0;
+        for (int run = 0; run < 3; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            best = run == 0 ? elapsed.count() : std::min(best, elapsed.count());
+        }
+        return best;
+    }
+
+    std::vector<double> readBack(const std::string& path, std::size_t elements) {
+        std::vector<double> values(elements);
+        std::ifstream file(path, std::ios::binary);
+        file.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(elements * sizeof(double)));
+        if (file.gcount() != static_cast<std::streamsize>(elements * sizeof(double))) {
+            values.clear();
+        }
+        return values;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace Geometry;
+
+    const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 3001;
+    const std::string path =
+        argc > 2 ? argv[2] : (std::filesystem::temp_directory_path() / "geometry_distance_matrix.bin").string();
+    if (count == 0) {
+        std::fprintf(stderr, "points must be positive\n");
+        return 1;
+    }
+
+    std::mt19937_64 rng(5);
+    std::uniform_real_distribution<double> coordinate(-1000.0, 1000.0);
+    std::vector<v2::Point> points(count);
+    for (v2::Point& p : points) {
+        p = {coordinate(rng), coordinate(rng), coordinate(rng)};
+    }
+
+    const std::size_t elements = count * count;
+    std::vector<double> expect(elements);
+    std::vector<double> expectSquared(elements);
+    for (std::size_t i = 0; i < count; ++i) {
+        for (std::size_t j = 0; j < count; ++j) {
+            expect[i * count + j] = distance(points[i], points[j]);
+            expectSquared[i * count + j] = squaredDistance(points[i], points[j]);
+        }
+    }
+
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("%zu points, %.1f MB matrix, %s, %u threads\n", count,
+                static_cast<double>(elements * sizeof(double)) / 1e6, simdLevelName(simdLevel()), threads);
+    std::printf("%-12s %10s %12s\n", "kernel", "ms", "elements/ns");
+
+    bool ok = true;
+    std::vector<double> out(elements);
+    auto report = [&](const char* name, double ms, const std::vector<double>& got, const std::vector<double>& want) {
+        std::printf("%-12s %10.2f %12.3f\n", name, ms, static_cast<double>(elements) / (ms * 1e6));
+        if (got != want) {
+            std::printf("  MISMATCH in %s\n", name);
+            ok = false;
+        }
+    };
+
+    MatrixOptions one;
+    one.threads = 1;
+    MatrixOptions all;
+    MatrixOptions squared;
+    squared.metric = MatrixOptions::Metric::SquaredDistance;
+    MatrixOptions file;
+    file.windowBytes = std::size_t{64} << 20;
+
+    std::fill(out.begin(), out.end(), 0.0);
+    report("naive",
+           bestMs([&] {
+               for (std::size_t i = 0; i < count; ++i) {
+                   for (std::size_t j = 0; j < count; ++j) {
+                       out[i * count + j] = distance(points[i], points[j]);
+                   }
+               }
+           }),
+           out, expect);
+
+    std::fill(out.begin(), out.end(), 0.0);
+    report("rows",
+           bestMs([&] {
+               for (std::size_t i = 0; i < count; ++i) {
+                   distances(points[i], points, std::span<double>(out).subspan(i * count, count));
+               }
+           }),
+           out, expect);
+
+    std::fill(out.begin(), out.end(), 0.0);
+    report("tiled N x M", bestMs([&] { distanceMatrix(points, points, out, one); }), out, expect);
+
+    std::fill(out.begin(), out.end(), 0.0);
+    report("tiled N x N", bestMs([&] { distanceMatrix(points, out, one); }), out, expect);
+
+    std::fill(out.begin(), out.end(), 0.0);
+    report("threads", bestMs([&] { distanceMatrix(points, out, all); }), out, expect);
+
+    std::fill(out.begin(), out.end(), 0.0);
+    report("squared", bestMs([&] { distanceMatrix(points, out, squared); }), out, expectSquared);
+
+    const double fileMs = bestMs([&] { writeDistanceMatrix(points, path, file); });
+    report("file", fileMs, readBack(path, elements), expect);
+    if (argc <= 2) {
+        std::filesystem::remove(path);
+    }
+    return ok ? 0 : 1;
+}
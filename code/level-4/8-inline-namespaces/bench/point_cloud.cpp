@@ -0,0 +1,138 @@
+// PointCloud (structure of arrays) against std::vector<Point> (array of
+// structures), for 2D (v1) and 3D (v2) points.
+//
+// Usage: level-4_8-inline-namespaces_point_cloud [points]
+//
+//   to SoA      PointCloud::append(points), at every SIMD level
+//   to AoS      PointCloud::toPoints(out), at every SIMD level
+//   x scan      count the points with -100 <= x < 100, reading x only:
+//               from the packed points (every coordinate comes along) and
+//               from the x column
+//
+// Times are per point, best of five runs. The run fails if a round trip
+// through the columns changes any coordinate or the two scans disagree.
+
+#include "geometry.h"
+#include "point_cloud.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+    template <typename Fn>
+    double bestNs(Fn fn, std::size_t points) {
+        fn(); // warm-up
+        double best = 0;
+        for (int run = 0; run < 5; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            best = run == 0 ? elapsed.count() : std::min(best, elapsed.count());
+        }
+        return best / static_cast<double>(points);
+    }
+
+    Geometry::v1::Point randomPoint(std::mt19937_64& rng, Geometry::v1::Point) {
+        std::uniform_real_distribution<double> coordinate(-1000.0, 1000.0);
+        return {coordinate(rng), coordinate(rng)};
+    }
+
+    Geometry::v2::Point randomPoint(std::mt19937_64& rng, Geometry::v2::Point) {
+        std::uniform_real_distribution<double> coordinate(-1000.0, 1000.0);
+        return {coordinate(rng), coordinate(rng), coordinate(rng)};
+    }
+
+    // Benchmarks one point version; returns false on a mismatch.
+    template <typename Point>
+    bool run(const char* label, std::size_t count) {
+        using namespace Geometry;
+
+        std::mt19937_64 rng(7);
+        std::vector<Point> points(count);
+        for (Point& p : points) {
+            p = randomPoint(rng, Point{});
+        }
+
+        std::printf("%s, %zu points\n", label, count);
+        std::printf("%-10s %12s %12s\n", "kernel", "to SoA ns", "to AoS ns");
+
+        bool ok = true;
+        PointCloud<Point> cloud;
+        cloud.reserve(count);
+        std::vector<Point> back(count);
+        for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512}) {
+            if (level > supportedSimdLevel()) {
+                std::printf("%-10s %12s\n", simdLevelName(level), "n/a");
+                continue;
+            }
+            setSimdLevel(level);
+            const double toSoa = bestNs(
+                [&] {
+                    cloud.clear();
+                    cloud.append(points);
+                },
+                count);
+            std::fill(back.begin(), back.end(), Point{});
+            const double toAos = bestNs([&] { cloud.toPoints(back); }, count);
+            std::printf("%-10s %12.3f %12.3f\n", simdLevelName(level), toSoa, toAos);
+
+            bool same = std::memcmp(back.data(), points.data(), count * sizeof(Point)) == 0;
+            for (std::size_t i = 0; i < count && same; ++i) {
+                same = cloud.x()[i] == points[i].x && cloud.y()[i] == points[i].y;
+            }
+            if (!same) {
+                std::fprintf(stderr, "FAILED: %s round trip changed the points\n", simdLevelName(level));
+                ok = false;
+            }
+        }
+        setSimdLevel(supportedSimdLevel());
+
+        std::size_t packedHits = 0;
+        std::size_t columnHits = 0;
+        const double packedNs = bestNs(
+            [&] {
+                std::size_t hits = 0;
+                for (const Point& p : points) {
+                    hits += (p.x >= -100.0) & (p.x < 100.0); // no branch to mispredict
+                }
+                packedHits = hits;
+            },
+            count);
+        const double columnNs = bestNs(
+            [&] {
+                std::size_t hits = 0;
+                for (double x : cloud.x()) {
+                    hits += (x >= -100.0) & (x < 100.0);
+                }
+                columnHits = hits;
+            },
+            count);
+        std::printf("\n%-10s %12s %12s %8s\n", "x scan", "ns/point", "bytes/point", "hits");
+        std::printf("%-10s %12.3f %12zu %8zu\n", "packed", packedNs, sizeof(Point), packedHits);
+        std::printf("%-10s %12.3f %12zu %8zu\n\n", "column", columnNs, sizeof(double), columnHits);
+        if (packedHits != columnHits) {
+            std::fprintf(stderr, "FAILED: the scans disagree\n");
+            ok = false;
+        }
+        return ok;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    // Odd by default, so every kernel also runs its scalar tail.
+    const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : (1 << 21) + 3;
+    if (count == 0) {
+        std::fprintf(stderr, "points must be positive\n");
+        return 1;
+    }
+
+    std::printf("CPU supports: %s\n\n", Geometry::simdLevelName(Geometry::supportedSimdLevel()));
+    bool ok = run<Geometry::v1::Point>("v1 (2D)", count);
+    ok = run<Geometry::v2::Point>("v2 (3D)", count) && ok;
+    return ok ? 0 : 1;
+}
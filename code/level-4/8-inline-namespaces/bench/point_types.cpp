@@ -0,0 +1,129 @@
+// v3::Point<T, 3> for T = double, float and int32_t (fixed point): a
+// brute-force nearest-point scan, ranking by squaredDistance() and by
+// distance().
+//
+// Usage: level-4_8-inline-namespaces_point_types [points]
+//
+//   squared     argmin of squaredDistance(q, p[i]): no square root
+//   distance    argmin of distance(q, p[i]): one square root per point
+//
+// Coordinates are whole numbers within ±2^20, exact in every type, so the
+// types differ only in size and arithmetic. Times are per point, best of
+// five scans over 8 queries. The run fails if double and int32_t disagree
+// on any nearest point (their squared distances are exact here), if the two
+// rankings pick different points, or if float's pick is more than a float
+// rounding farther away than the true nearest.
+
+#include "geometry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+    using Geometry::Point;
+
+    constexpr std::size_t kQueries = 8;
+
+    template <typename Fn>
+    double bestNs(Fn fn, std::size_t points) {
+        fn(); // warm-up
+        double best = 0;
+        for (int run = 0; run < 5; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            best = run == 0 ? elapsed.count() : std::min(best, elapsed.count());
+        }
+        return best / static_cast<double>(points);
+    }
+
+    template <typename T, typename Rank>
+    std::size_t nearest(Point<T, 3> q, const std::vector<Point<T, 3>>& points, Rank rank) {
+        std::size_t index = 0;
+        auto best = rank(q, points[0]);
+        for (std::size_t i = 1; i < points.size(); ++i) {
+            const auto d = rank(q, points[i]);
+            if (d < best) {
+                best = d;
+                index = i;
+            }
+        }
+        return index;
+    }
+
+    struct Picks {
+        std::vector<std::size_t> squared;
+        std::vector<std::size_t> distance;
+    };
+
+    template <typename T>
+    Picks run(const char* label, const std::vector<Point<std::int32_t, 3>>& source,
+              const std::vector<Point<std::int32_t, 3>>& querySource) {
+        auto convert = [](Point<std::int32_t, 3> p) {
+            return Point<T, 3>{static_cast<T>(p.x), static_cast<T>(p.y), static_cast<T>(p.z)};
+        };
+        std::vector<Point<T, 3>> points(source.size());
+        std::transform(source.begin(), source.end(), points.begin(), convert);
+        std::vector<Point<T, 3>> queries(querySource.size());
+        std::transform(querySource.begin(), querySource.end(), queries.begin(), convert);
+
+        Picks picks{std::vector<std::size_t>(kQueries), std::vector<std::size_t>(kQueries)};
+        const std::size_t scanned = points.size() * kQueries;
+        const double squaredNs = bestNs(
+            [&] {
+                for (std::size_t q = 0; q < kQueries; ++q) {
+                    picks.squared[q] = nearest(queries[q], points, [](auto a, auto b) { return squaredDistance(a, b); });
+                }
+            },
+            scanned);
+        const double distanceNs = bestNs(
+            [&] {
+                for (std::size_t q = 0; q < kQueries; ++q) {
+                    picks.distance[q] = nearest(queries[q], points, [](auto a, auto b) { return distance(a, b); });
+                }
+            },
+            scanned);
+        std::printf("%-8s %12zu %12.3f %12.3f\n", label, sizeof(Point<T, 3>), squaredNs, distanceNs);
+        return picks;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t{1} << 22;
+    if (count == 0) {
+        std::fprintf(stderr, "points must be positive\n");
+        return 1;
+    }
+
+    std::mt19937_64 rng(3);
+    std::uniform_int_distribution<std::int32_t> coordinate(-(1 << 20), 1 << 20);
+    auto randomPoint = [&] { return Point<std::int32_t, 3>{coordinate(rng), coordinate(rng), coordinate(rng)}; };
+    std::vector<Point<std::int32_t, 3>> points(count);
+    std::generate(points.begin(), points.end(), randomPoint);
+    std::vector<Point<std::int32_t, 3>> queries(kQueries);
+    std::generate(queries.begin(), queries.end(), randomPoint);
+
+    std::printf("%zu points, %zu queries\n", count, kQueries);
+    std::printf("%-8s %12s %12s %12s\n", "type", "bytes/point", "squared ns", "distance ns");
+    const Picks exact = run<double>("double", points, queries);
+    const Picks fixed = run<std::int32_t>("int32_t", points, queries);
+    const Picks single = run<float>("float", points, queries);
+
+    bool ok = true;
+    for (std::size_t q = 0; q < kQueries; ++q) {
+        const double best = Geometry::distance(points[exact.squared[q]], queries[q]);
+        const double floatPick = Geometry::distance(points[single.squared[q]], queries[q]);
+        if (exact.squared[q] != exact.distance[q] || fixed.squared[q] != fixed.distance[q] ||
+            exact.squared[q] != fixed.squared[q] || floatPick > best * (1 + 1e-6)) {
+            std::printf("MISMATCH at query %zu\n", q);
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
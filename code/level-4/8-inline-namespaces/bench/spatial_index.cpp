@@ -0,0 +1,216 @@
+// KdTree and HashGrid against a brute-force scan, for 2D (v1) and 3D (v2)
+// points spread uniformly over a cube.
+//
+// Usage: level-4_8-inline-namespaces_spatial_index [points...]
+//
+//   build       KdTree on one thread and on every hardware thread,
+//               HashGrid bulk load
+//   k-nearest   the 8 closest points to a random query
+//   radius      every point within the radius that holds 8 points on
+//               average (also the grid's cell size)
+//
+// The default sizes are 1e3 to 1e6 points. 1e7 and 1e8 work too given the
+// memory: the 3D case at 1e8 needs roughly 15 GB. Build times are best of
+// three; queries are the best of three passes over 2000 queries, except
+// brute force, which runs fewer queries on large inputs to keep the run
+// short. The run fails if either index disagrees with brute force on any
+// query (index or distance).
+
+#include "geometry.h"
+#include "hash_grid.h"
+#include "kd_tree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <numbers>
+#include <queue>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+    constexpr std::size_t kNeighbors = 8;
+    constexpr std::size_t kQueries = 2000;
+    constexpr double kSide = 1000.0;
+
+    template <typename Fn>
+    double bestSeconds(Fn fn, int runs) {
+        double best = 0;
+        for (int run = 0; run < runs; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best = run == 0 ? elapsed.count() : std::min(best, elapsed.count());
+        }
+        return best;
+    }
+
+    Geometry::v1::Point randomPoint(std::mt19937_64& rng, Geometry::v1::Point) {
+        std::uniform_real_distribution<double> coordinate(0.0, kSide);
+        return {coordinate(rng), coordinate(rng)};
+    }
+
+    Geometry::v2::Point randomPoint(std::mt19937_64& rng, Geometry::v2::Point) {
+        std::uniform_real_distribution<double> coordinate(0.0, kSide);
+        return {coordinate(rng), coordinate(rng), coordinate(rng)};
+    }
+
+    // Same order as the indexes: by distance, ties by index.
+    template <typename Point>
+    std::vector<Geometry::Nearest> bruteNearest(Point query, const std::vector<Point>& points, std::size_t k) {
+        std::priority_queue<std::pair<double, std::size_t>> best;
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            // Unqualified: v1::Point and v2::Point are v3::Point<double, N>,
+            // so ADL finds the v3 templates, the same squaredDistance() the
+            // indexes rank by (likewise distance() below).
+            std::pair<double, std::size_t> candidate{squaredDistance(query, points[i]), i};
+            if (best.size() < k) {
+                best.push(candidate);
+            } else if (candidate < best.top()) {
+                best.pop();
+                best.push(candidate);
+            }
+        }
+        std::vector<Geometry::Nearest> results(best.size());
+        for (std::size_t i = results.size(); i-- > 0; best.pop()) {
+            results[i] = Geometry::Nearest{best.top().second, std::sqrt(best.top().first)};
+        }
+        return results;
+    }
+
+    template <typename Point>
+    std::vector<Geometry::Nearest> bruteWithin(Point query, const std::vector<Point>& points, double radius) {
+        std::vector<Geometry::Nearest> results;
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            const double d = distance(query, points[i]);
+            if (d <= radius) {
+                results.push_back(Geometry::Nearest{i, d});
+            }
+        }
+        std::sort(results.begin(), results.end(), [](const Geometry::Nearest& a, const Geometry::Nearest& b) {
+            return a.distance < b.distance || (a.distance == b.distance && a.index < b.index);
+        });
+        return results;
+    }
+
+    bool same(const std::vector<Geometry::Nearest>& a, const std::vector<Geometry::Nearest>& b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                          [](const Geometry::Nearest& x, const Geometry::Nearest& y) {
+                              return x.index == y.index && x.distance == y.distance;
+                          });
+    }
+
+    // Benchmarks one point version at one size; returns false on a mismatch.
+    template <typename Point>
+    bool run(const char* label, std::size_t count) {
+        using namespace Geometry;
+        constexpr std::size_t dims = kDimensions<Point>;
+
+        std::mt19937_64 rng(11);
+        std::vector<Point> points(count);
+        for (Point& p : points) {
+            p = randomPoint(rng, Point{});
+        }
+        std::vector<Point> queries(kQueries);
+        for (Point& q : queries) {
+            q = randomPoint(rng, Point{});
+        }
+        // A ball of this radius holds kNeighbors points on average.
+        const double ballVolume = static_cast<double>(kNeighbors) * std::pow(kSide, dims) / static_cast<double>(count);
+        const double radius = dims == 2 ? std::sqrt(ballVolume / std::numbers::pi)
+                                        : std::cbrt(ballVolume * 3 / (4 * std::numbers::pi));
+
+        const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        std::printf("%s, %zu points, k = %zu, radius %.4g\n", label, count, kNeighbors, radius);
+
+        KdTree<Point> tree;
+        HashGrid<Point> grid(radius);
+        const double buildOne = bestSeconds([&] { tree = KdTree<Point>(points, 1); }, 3);
+        const double buildAll = bestSeconds([&] { tree = KdTree<Point>(points, threads); }, 3);
+        const double buildGrid = bestSeconds([&] { grid = HashGrid<Point>(radius, points); }, 3);
+        std::printf("  build ms    kd-tree %.3g (1 thread), %.3g (%u threads); hash grid %.3g\n", buildOne * 1e3,
+                    buildAll * 1e3, threads, buildGrid * 1e3);
+
+        // Brute force touches every point per query: cap it at about 1e8
+        // distances per pass.
+        const std::size_t bruteQueries = std::clamp<std::size_t>(100'000'000 / count, 10, kQueries);
+        std::vector<std::vector<Nearest>> expectNear(bruteQueries);
+        std::vector<std::vector<Nearest>> expectWithin(bruteQueries);
+        const double bruteNear = bestSeconds(
+            [&] {
+                for (std::size_t i = 0; i < bruteQueries; ++i) {
+                    expectNear[i] = bruteNearest(queries[i], points, kNeighbors);
+                }
+            },
+            1);
+        const double bruteRange = bestSeconds(
+            [&] {
+                for (std::size_t i = 0; i < bruteQueries; ++i) {
+                    expectWithin[i] = bruteWithin(queries[i], points, radius);
+                }
+            },
+            1);
+
+        std::vector<std::vector<Nearest>> treeNear(kQueries);
+        std::vector<std::vector<Nearest>> treeWithin(kQueries);
+        std::vector<std::vector<Nearest>> gridNear(kQueries);
+        std::vector<std::vector<Nearest>> gridWithin(kQueries);
+        auto timeQueries = [&](auto query, std::vector<std::vector<Nearest>>& out) {
+            return bestSeconds(
+                [&] {
+                    for (std::size_t i = 0; i < kQueries; ++i) {
+                        out[i] = query(queries[i]);
+                    }
+                },
+                3);
+        };
+        const double treeKnn = timeQueries([&](Point q) { return tree.nearest(q, kNeighbors); }, treeNear);
+        const double treeRange = timeQueries([&](Point q) { return tree.within(q, radius); }, treeWithin);
+        const double gridKnn = timeQueries([&](Point q) { return grid.nearest(q, kNeighbors); }, gridNear);
+        const double gridRange = timeQueries([&](Point q) { return grid.within(q, radius); }, gridWithin);
+
+        const double brute = static_cast<double>(bruteQueries);
+        const double indexed = static_cast<double>(kQueries);
+        std::printf("  %-11s %14s %14s\n", "queries/s", "k-nearest", "radius");
+        std::printf("  %-11s %14.4g %14.4g\n", "brute force", brute / bruteNear, brute / bruteRange);
+        std::printf("  %-11s %14.4g %14.4g\n", "kd-tree", indexed / treeKnn, indexed / treeRange);
+        std::printf("  %-11s %14.4g %14.4g\n", "hash grid", indexed / gridKnn, indexed / gridRange);
+
+        bool ok = true;
+        for (std::size_t i = 0; i < bruteQueries; ++i) {
+            if (!same(treeNear[i], expectNear[i]) || !same(gridNear[i], expectNear[i]) ||
+                !same(treeWithin[i], expectWithin[i]) || !same(gridWithin[i], expectWithin[i])) {
+                std::printf("  MISMATCH against brute force at query %zu\n", i);
+                ok = false;
+                break;
+            }
+        }
+        std::printf("\n");
+        return ok;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+        if (sizes.back() == 0) {
+            std::fprintf(stderr, "points must be positive\n");
+            return 1;
+        }
+    }
+    if (sizes.empty()) {
+        sizes = {1'000, 10'000, 100'000, 1'000'000};
+    }
+
+    bool ok = true;
+    for (std::size_t count : sizes) {
+        ok = run<Geometry::v1::Point>("v1 (2D)", count) && ok;
+        ok = run<Geometry::v2::Point>("v2 (3D)", count) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+// distance_matrix.h - All-pairs distance matrices over Geometry points, tiled and multi-threaded
+#ifndef DISTANCE_MATRIX_H
+#define DISTANCE_MATRIX_H
+
+#include "geometry.h"
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace Geometry {
+    // Every distance between two point sets, as a row-major matrix of
+    // doubles: element (i, j) is distance(rows[i], columns[j]).
+    //
+    //     std::vector<double> m(points.size() * points.size());
+    //     Geometry::distanceMatrix(points, m); // N x N, symmetric
+    //
+    // The matrix is cut into tiles of tile x tile elements, and threads
+    // take tiles from a shared counter. A tile reads 2 * tile points and
+    // writes tile² results, so both stay in cache while it is filled; each
+    // row of a tile is one batch call (distances() or squaredDistances()),
+    // at simdLevel(). For the N x N overloads only the tiles on and above
+    // the diagonal are computed; each one is then transposed into its mirror
+    // image below the diagonal while it is still in cache. distance(a, b)
+    // and distance(b, a) are the same bits, so the mirror is exact.
+    //
+    // Results are bit-identical to distance() (or squaredDistance()), as
+    // for the batch functions in geometry.h.
+    struct MatrixOptions {
+        enum class Metric {
+            Distance,
+            SquaredDistance, // no square root: enough to compare or rank
+        };
+
+        Metric metric = Metric::Distance;
+        unsigned threads = 0;                             // 0: std::thread::hardware_concurrency()
+        std::size_t tile = 128;                           // rows and columns per tile, at least 1
+        std::size_t windowBytes = std::size_t{256} << 20; // files only: how much to map at a time
+    };
+
+    // writeDistanceMatrix() is for matrices that do not fit in memory. The
+    // file at path is created (or truncated) to rows x columns doubles, raw,
+    // row-major, in native byte order, and filled one window of rows at a
+    // time: the window is mapped, computed tile by tile as above and
+    // unmapped, leaving the kernel to write it back, so memory use stays
+    // around windowBytes however large the matrix. For N x N only the part
+    // of the window that mirrors onto itself is computed once; the columns
+    // to its left would have to be read back from rows already written out,
+    // which costs more than computing them again.
+    //
+    // Where mmap is not available (Windows builds of this example) each
+    // window is computed into a buffer and written with std::ofstream.
+    //
+    // out.size() other than rows x columns, or tile == 0, throws
+    // std::invalid_argument. File errors throw std::system_error (or
+    // std::ios_base::failure on Windows).
+
+    namespace v1 {
+        void distanceMatrix(std::span<const Point> points, std::span<double> out, const MatrixOptions& options = {});
+        void distanceMatrix(std::span<const Point> rows, std::span<const Point> columns, std::span<double> out,
+                            const MatrixOptions& options = {});
+        void writeDistanceMatrix(std::span<const Point> points, const std::string& path, const MatrixOptions& options = {});
+        void writeDistanceMatrix(std::span<const Point> rows, std::span<const Point> columns, const std::string& path,
+                                 const MatrixOptions& options = {});
+    } // namespace v1
+
+    namespace v2 {
+        void distanceMatrix(std::span<const Point> points, std::span<double> out, const MatrixOptions& options = {});
+        void distanceMatrix(std::span<const Point> rows, std::span<const Point> columns, std::span<double> out,
+                            const MatrixOptions& options = {});
+        void writeDistanceMatrix(std::span<const Point> points, const std::string& path, const MatrixOptions& options = {});
+        void writeDistanceMatrix(std::span<const Point> rows, std::span<const Point> columns, const std::string& path,
+                                 const MatrixOptions& options = {});
+    } // namespace v2
+
+    // Found through Geometry:: and by argument-dependent lookup, like the
+    // batch functions (see the end of geometry.h).
+    inline namespace v3 {
+        using v1::distanceMatrix;
+        using v1::writeDistanceMatrix;
+        using v2::distanceMatrix;
+        using v2::writeDistanceMatrix;
+    } // namespace v3
+} // namespace Geometry
+
+#endif // DISTANCE_MATRIX_H
@@ -1,27 +1,293 @@
-// geometry.h - Version 2.0
+// geometry.h - Version 3.0
 #ifndef GEOMETRY_H
 #define GEOMETRY_H
 
+#include <bit>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
 
 namespace Geometry {
-    // Old version (kept for backward compatibility)
-    namespace v1 {
+    // Instruction sets the batch functions below can run on. Chosen once at
+    // startup from what the CPU (and OS) support; setSimdLevel() can lower
+    // it, e.g. to compare kernels.
+    enum class SimdLevel {
+        Scalar,
+        SSE2,
+        AVX2,
+        AVX512, // AVX-512F
+    };
+
+    SimdLevel supportedSimdLevel();
+    SimdLevel simdLevel();
+    void setSimdLevel(SimdLevel level); // clamped to supportedSimdLevel()
+    const char* simdLevelName(SimdLevel level);
+
+    struct Nearest {
+        std::size_t index; // first candidate at the minimum distance
+        double distance;
+    };
+
+    // Batch functions, for v1::Point and v2::Point (Point<double, 2> and
+    // Point<double, 3>), declared in v1 and v2 and also visible in v3:
+    //   distances(from, to, out)         out[i] = distance(from, to[i])
+    //   squaredDistances(from, to, out)  out[i] = squaredDistance(from, to[i])
+    //   distances(a, b, out)             out[i] = distance(a[i], b[i])
+    //   nearest(p, candidates)           the candidate closest to p
+    //
+    // Each call runs a SIMD kernel for simdLevel() over blocks of 2, 4 or 8
+    // points and the scalar formula for the rest. The kernels evaluate the
+    // same operations in the same order as distance(), never fuse them into
+    // FMAs, and SIMD square roots are correctly rounded like std::sqrt, so
+    // every result is bit-identical to distance() (0 ULP). The one exception
+    // is a build where distance() itself gets contracted into FMAs (GCC with
+    // -march=native or similar, since C++ defaults to -ffp-contract=fast):
+    // then the two may differ by up to 2 ULP. nearest() compares squared
+    // distances and takes a single square root at the end.
+    //
+    // Mismatched span sizes, or nearest() with no candidates, throw
+    // std::invalid_argument.
+
+    namespace detail {
+        // A correctly rounded square root for constant expressions, where
+        // std::sqrt is not allowed before C++26: the bit-by-bit integer
+        // method on the significand, rounded to nearest even. Gives the same
+        // bits as std::sqrt, so distance() does not depend on whether it ran
+        // at compile time.
+        constexpr double sqrt(double x) {
+            if (!(x > 0) || x == std::numeric_limits<double>::infinity()) {
+                return x == 0 || x != x || x > 0 ? x : std::numeric_limits<double>::quiet_NaN(); // ±0, NaN, inf, x < 0
+            }
+            constexpr std::uint64_t kFraction = (std::uint64_t{1} << 52) - 1;
+            const std::uint64_t bits = std::bit_cast<std::uint64_t>(x);
+            std::uint64_t significand = bits & kFraction;
+            int exponent = static_cast<int>(bits >> 52);
+            if (exponent == 0) { // subnormal: normalize
+                exponent = 1;
+                while (significand >> 52 == 0) {
+                    significand <<= 1;
+                    --exponent;
+                }
+            } else {
+                significand |= std::uint64_t{1} << 52;
+            }
+            exponent -= 1075; // x = significand * 2^exponent, 2^52 <= significand < 2^53
+            if (exponent % 2 != 0) {
+                significand <<= 1;
+                --exponent;
+            }
+            // root = floor(sqrt(significand * 2^56)), 55 bits: the 53 kept,
+            // a guard bit, and one more that joins the remainder as sticky.
+            std::uint64_t root = 0;
+            std::uint64_t remainder = 0;
+            for (int pair = 54; pair >= 0; --pair) {
+                const int shift = 2 * pair - 56;
+                remainder = (remainder << 2) | (shift >= 0 ? (significand >> shift) & 3 : 0);
+                const std::uint64_t trial = (root << 2) | 1;
+                if (remainder >= trial) {
+                    remainder -= trial;
+                    root = (root << 1) | 1;
+                } else {
+                    root <<= 1;
+                }
+            }
+            int scale = (exponent - 56) / 2 + 2; // of the 53-bit mantissa below
+            std::uint64_t mantissa = root >> 2;
+            const bool guard = (root & 2) != 0;
+            const bool sticky = (root & 1) != 0 || remainder != 0;
+            if (guard && (sticky || (mantissa & 1) != 0)) {
+                ++mantissa;
+            }
+            if (mantissa == std::uint64_t{1} << 53) {
+                mantissa >>= 1;
+                ++scale;
+            }
+            const std::uint64_t biased = static_cast<std::uint64_t>(scale + 52 + 1023);
+            return std::bit_cast<double>((biased << 52) | (mantissa & kFraction));
+        }
+
+        // Correctly rounded through double: 53 bits are enough that the
+        // second rounding never changes the float result.
+        constexpr float sqrt(float x) {
+            return static_cast<float>(sqrt(static_cast<double>(x)));
+        }
+    } // namespace detail
+
+    // New version (default): one Point template for every coordinate type
+    // and dimension, where v1 and v2 each hard-coded a struct.
+    //
+    //     Geometry::Point<double, 3> p{1, 2, 3};
+    //     Geometry::Point<float, 3> compact{1, 2, 3}; // 12 bytes instead of 24
+    //     static_assert(Geometry::distance(Geometry::Point<std::int32_t, 2>{0, 0}, {3, 4}) == 5);
+    //
+    // T is float, double or std::int32_t. int32_t coordinates are fixed
+    // point: whole multiples of a unit the caller picks (1/1024 mm, say),
+    // exact where floating point would round. Points of 2 or 3 coordinates
+    // name them x, y and z; every point also has p[i].
+    //
+    // squaredDistance() and distance() are constexpr, and unrolled over the
+    // coordinates at compile time. They evaluate what v1 and v2 always did,
+    // dx * dx + dy * dy (+ dz * dz) with dx = b.x - a.x, so for double they
+    // agree with v1::distance() and v2::distance() to the bit, at compile
+    // time as well (see detail::sqrt). The result types:
+    //
+    //     T         squaredDistance()   distance()
+    //     float     float               float
+    //     double    double              double
+    //     int32_t   uint64_t, exact     double
+    //
+    // The int32_t squared distance is exact while the sum of the squared
+    // differences stays below 2^64, and silently wraps past it. That holds
+    // up to N = 4 when every |coordinate| < 2^30, and up to N = 3 when
+    // coordinates may reach ±2^30 (a difference of 2^31 squares to 2^62).
+    // Comparisons only need squaredDistance(), which skips the square root.
+    inline namespace v3 {
+        template <typename T>
+        struct CoordinateTraits;
+
+        template <>
+        struct CoordinateTraits<float> {
+            using Squared = float;
+            using Distance = float;
+        };
+
+        template <>
+        struct CoordinateTraits<double> {
+            using Squared = double;
+            using Distance = double;
+        };
+
+        template <>
+        struct CoordinateTraits<std::int32_t> {
+            using Squared = std::uint64_t;
+            using Distance = double;
+        };
+
+        template <typename T>
+        concept Coordinate = requires { typename CoordinateTraits<T>::Squared; };
+
+        template <Coordinate T, std::size_t N>
         struct Point {
-            double x, y; // 2D
+            static_assert(N >= 1, "a point needs at least one coordinate");
+            static constexpr std::size_t dimensions = N;
+
+            T coordinates[N];
+
+            constexpr T& operator[](std::size_t i) {
+                return coordinates[i];
+            }
+
+            constexpr const T& operator[](std::size_t i) const {
+                return coordinates[i];
+            }
+        };
+
+        template <Coordinate T>
+        struct Point<T, 2> {
+            static constexpr std::size_t dimensions = 2;
+
+            T x, y;
+
+            constexpr T& operator[](std::size_t i) {
+                return i == 0 ? x : y;
+            }
+
+            constexpr const T& operator[](std::size_t i) const {
+                return i == 0 ? x : y;
+            }
+        };
+
+        template <Coordinate T>
+        struct Point<T, 3> {
+            static constexpr std::size_t dimensions = 3;
+
+            T x, y, z;
+
+            constexpr T& operator[](std::size_t i) {
+                return i == 0 ? x : i == 1 ? y : z;
+            }
+
+            constexpr const T& operator[](std::size_t i) const {
+                return i == 0 ? x : i == 1 ? y : z;
+            }
         };
 
+        // distance() before the square root, for comparisons.
+        template <Coordinate T, std::size_t N>
+        constexpr typename CoordinateTraits<T>::Squared squaredDistance(Point<T, N> a, Point<T, N> b) {
+            using Squared = typename CoordinateTraits<T>::Squared;
+            auto term = [&](std::size_t i) -> Squared {
+                if constexpr (std::is_integral_v<T>) {
+                    const std::int64_t d = std::int64_t{b[i]} - a[i];
+                    const std::uint64_t magnitude = static_cast<std::uint64_t>(d < 0 ? -d : d);
+                    return magnitude * magnitude;
+                } else {
+                    const T d = b[i] - a[i];
+                    return d * d;
+                }
+            };
+            // A left fold: ((term(0) + term(1)) + term(2)) + ...
+            return [&]<std::size_t... I>(std::index_sequence<I...>) {
+                return (... + term(I));
+            }(std::make_index_sequence<N>{});
+        }
+
+        template <Coordinate T, std::size_t N>
+        constexpr typename CoordinateTraits<T>::Distance distance(Point<T, N> a, Point<T, N> b) {
+            using Distance = typename CoordinateTraits<T>::Distance;
+            const Distance d2 = static_cast<Distance>(squaredDistance(a, b));
+            if (std::is_constant_evaluated()) {
+                return detail::sqrt(d2);
+            }
+            return std::sqrt(d2);
+        }
+    } // namespace v3
+
+    // Old version (kept for backward compatibility)
+    namespace v1 {
+        using Point = v3::Point<double, 2>; // 2D
+        using v3::squaredDistance;
+
         double distance(Point a, Point b);
+
+        void distances(Point from, std::span<const Point> to, std::span<double> out);
+        void squaredDistances(Point from, std::span<const Point> to, std::span<double> out);
+        void distances(std::span<const Point> a, std::span<const Point> b, std::span<double> out);
+        Nearest nearest(Point p, std::span<const Point> candidates);
     } // namespace v1
 
-    // New version (default)
-    inline namespace v2 {
-        struct Point {
-            double x, y, z; // 3D
-        };
+    // Previous version
+    namespace v2 {
+        using Point = v3::Point<double, 3>; // 3D
+        using v3::squaredDistance;
 
         double distance(Point a, Point b);
+
+        void distances(Point from, std::span<const Point> to, std::span<double> out);
+        void squaredDistances(Point from, std::span<const Point> to, std::span<double> out);
+        void distances(std::span<const Point> a, std::span<const Point> b, std::span<double> out);
+        Nearest nearest(Point p, std::span<const Point> candidates);
     } // namespace v2
+
+    // v1::Point and v2::Point are v3 types now, so argument-dependent
+    // lookup searches v3, not v1 or v2. Bringing the batch functions in
+    // here keeps Geometry::distances(...) and unqualified calls working.
+    inline namespace v3 {
+        using v1::distances;
+        using v1::nearest;
+        using v1::squaredDistances;
+        using v2::distances;
+        using v2::nearest;
+        using v2::squaredDistances;
+    } // namespace v3
+
+    // Coordinates per point: 2 for v1::Point, 3 for v2::Point.
+    template <typename Point>
+    inline constexpr std::size_t kDimensions = Point::dimensions;
 } // namespace Geometry
 
-#endif // GEOMETRY_H
\ No newline at end of file
+#endif // GEOMETRY_H
@@ -0,0 +1,213 @@
+// geometry_simd.h - Register-level building blocks shared by the Geometry SIMD kernels
+#ifndef GEOMETRY_SIMD_H
+#define GEOMETRY_SIMD_H
+
+#include "geometry.h"
+
+// Only the library's own .cpp files include this header; the public API is
+// in geometry.h and point_cloud.h.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GEOMETRY_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only accept an instruction set's intrinsics inside functions
+// compiled for it; everything else stays baseline, so the program still runs
+// on any CPU. MSVC accepts them anywhere.
+#if defined(__GNUC__) || defined(__clang__)
+#define GEOMETRY_TARGET(isa) __attribute__((target(isa)))
+#else
+#define GEOMETRY_TARGET(isa)
+#endif
+
+namespace Geometry {
+    namespace simd {
+        // The kernels read and write points as a plain array of doubles.
+        static_assert(sizeof(v1::Point) == 2 * sizeof(double));
+        static_assert(sizeof(v2::Point) == 3 * sizeof(double));
+
+        template <typename Point>
+        const double* coordinates(const Point* p) {
+            return reinterpret_cast<const double*>(p);
+        }
+
+        template <typename Point>
+        double* coordinates(Point* p) {
+            return reinterpret_cast<double*>(p);
+        }
+
+#if defined(GEOMETRY_X86)
+        // Every load turns a block of packed points (x y z x y z ...) into
+        // one register per coordinate, and every store does the reverse. For
+        // 2D points z is zero on load and ignored on store.
+
+        // --------------------------------------------------------------------
+        // SSE2: 2 points per block.
+        // --------------------------------------------------------------------
+        struct Sse2Lanes {
+            __m128d x, y, z;
+        };
+
+        GEOMETRY_TARGET("sse2") inline Sse2Lanes loadSse2(const v1::Point* p) {
+            const double* d = coordinates(p);
+            __m128d a = _mm_loadu_pd(d);     // x0 y0
+            __m128d b = _mm_loadu_pd(d + 2); // x1 y1
+            return {_mm_unpacklo_pd(a, b), _mm_unpackhi_pd(a, b), _mm_setzero_pd()};
+        }
+
+        GEOMETRY_TARGET("sse2") inline Sse2Lanes loadSse2(const v2::Point* p) {
+            const double* d = coordinates(p);
+            __m128d a = _mm_loadu_pd(d);     // x0 y0
+            __m128d b = _mm_loadu_pd(d + 2); // z0 x1
+            __m128d c = _mm_loadu_pd(d + 4); // y1 z1
+            return {_mm_shuffle_pd(a, b, 0b10), _mm_shuffle_pd(a, c, 0b01), _mm_shuffle_pd(b, c, 0b10)};
+        }
+
+        GEOMETRY_TARGET("sse2") inline void storeSse2(v1::Point* p, const Sse2Lanes& v) {
+            double* d = coordinates(p);
+            _mm_storeu_pd(d, _mm_unpacklo_pd(v.x, v.y));
+            _mm_storeu_pd(d + 2, _mm_unpackhi_pd(v.x, v.y));
+        }
+
+        GEOMETRY_TARGET("sse2") inline void storeSse2(v2::Point* p, const Sse2Lanes& v) {
+            double* d = coordinates(p);
+            _mm_storeu_pd(d, _mm_unpacklo_pd(v.x, v.y));         // x0 y0
+            _mm_storeu_pd(d + 2, _mm_shuffle_pd(v.z, v.x, 0b10)); // z0 x1
+            _mm_storeu_pd(d + 4, _mm_unpackhi_pd(v.y, v.z));     // y1 z1
+        }
+
+        template <typename Point>
+        GEOMETRY_TARGET("sse2") Sse2Lanes broadcastSse2(Point p) {
+            if constexpr (kDimensions<Point> == 3) {
+                return {_mm_set1_pd(p.x), _mm_set1_pd(p.y), _mm_set1_pd(p.z)};
+            } else {
+                return {_mm_set1_pd(p.x), _mm_set1_pd(p.y), _mm_setzero_pd()};
+            }
+        }
+
+        // --------------------------------------------------------------------
+        // AVX2: 4 points per block.
+        // --------------------------------------------------------------------
+        struct Avx2Lanes {
+            __m256d x, y, z;
+        };
+
+        GEOMETRY_TARGET("avx2") inline Avx2Lanes loadAvx2(const v1::Point* p) {
+            const double* d = coordinates(p);
+            __m256d a = _mm256_loadu_pd(d);                   // x0 y0 | x1 y1
+            __m256d b = _mm256_loadu_pd(d + 4);               // x2 y2 | x3 y3
+            __m256d lo = _mm256_permute2f128_pd(a, b, 0x20); // x0 y0 | x2 y2
+            __m256d hi = _mm256_permute2f128_pd(a, b, 0x31); // x1 y1 | x3 y3
+            return {_mm256_unpacklo_pd(lo, hi), _mm256_unpackhi_pd(lo, hi), _mm256_setzero_pd()};
+        }
+
+        GEOMETRY_TARGET("avx2") inline Avx2Lanes loadAvx2(const v2::Point* p) {
+            const double* d = coordinates(p);
+            __m256d a = _mm256_loadu_pd(d);                   // x0 y0 | z0 x1
+            __m256d b = _mm256_loadu_pd(d + 4);               // y1 z1 | x2 y2
+            __m256d c = _mm256_loadu_pd(d + 8);               // z2 x3 | y3 z3
+            __m256d ac = _mm256_permute2f128_pd(a, c, 0x30); // x0 y0 | y3 z3
+            __m256d ca = _mm256_permute2f128_pd(a, c, 0x21); // z0 x1 | z2 x3
+            __m256d xy = _mm256_blend_pd(ac, b, 0b1100);      // x0 y0 | x2 y2
+            __m256d yz = _mm256_blend_pd(b, ac, 0b1100);      // y1 z1 | y3 z3
+            return {_mm256_shuffle_pd(xy, ca, 0b1010), _mm256_shuffle_pd(xy, yz, 0b0101), _mm256_shuffle_pd(ca, yz, 0b1010)};
+        }
+
+        GEOMETRY_TARGET("avx2") inline void storeAvx2(v1::Point* p, const Avx2Lanes& v) {
+            double* d = coordinates(p);
+            __m256d lo = _mm256_unpacklo_pd(v.x, v.y); // x0 y0 | x2 y2
+            __m256d hi = _mm256_unpackhi_pd(v.x, v.y); // x1 y1 | x3 y3
+            _mm256_storeu_pd(d, _mm256_permute2f128_pd(lo, hi, 0x20));
+            _mm256_storeu_pd(d + 4, _mm256_permute2f128_pd(lo, hi, 0x31));
+        }
+
+        GEOMETRY_TARGET("avx2") inline void storeAvx2(v2::Point* p, const Avx2Lanes& v) {
+            double* d = coordinates(p);
+            __m256d xy = _mm256_unpacklo_pd(v.x, v.y);         // x0 y0 | x2 y2
+            __m256d yz = _mm256_unpackhi_pd(v.y, v.z);         // y1 z1 | y3 z3
+            __m256d zx = _mm256_shuffle_pd(v.z, v.x, 0b1010);  // z0 x1 | z2 x3
+            _mm256_storeu_pd(d, _mm256_permute2f128_pd(xy, zx, 0x20));     // x0 y0 | z0 x1
+            _mm256_storeu_pd(d + 4, _mm256_permute2f128_pd(yz, xy, 0x30)); // y1 z1 | x2 y2
+            _mm256_storeu_pd(d + 8, _mm256_permute2f128_pd(zx, yz, 0x31)); // z2 x3 | y3 z3
+        }
+
+        template <typename Point>
+        GEOMETRY_TARGET("avx2") Avx2Lanes broadcastAvx2(Point p) {
+            if constexpr (kDimensions<Point> == 3) {
+                return {_mm256_set1_pd(p.x), _mm256_set1_pd(p.y), _mm256_set1_pd(p.z)};
+            } else {
+                return {_mm256_set1_pd(p.x), _mm256_set1_pd(p.y), _mm256_setzero_pd()};
+            }
+        }
+
+        // --------------------------------------------------------------------
+        // AVX-512F: 8 points per block. Two-source permutes pick each
+        // coordinate out of (or back into) the block: first between two of
+        // the three registers, then the remaining lanes from the third.
+        // --------------------------------------------------------------------
+        struct Avx512Lanes {
+            __m512d x, y, z;
+        };
+
+        // Permute indices in lane order, lane 0 first (_mm512_set_epi64
+        // takes them the other way round).
+        GEOMETRY_TARGET("avx512f")
+        inline __m512i lanes(long long l0, long long l1, long long l2, long long l3, long long l4, long long l5,
+                             long long l6, long long l7) {
+            return _mm512_set_epi64(l7, l6, l5, l4, l3, l2, l1, l0);
+        }
+
+        GEOMETRY_TARGET("avx512f") inline Avx512Lanes loadAvx512(const v1::Point* p) {
+            const double* d = coordinates(p);
+            __m512d a = _mm512_loadu_pd(d);     // x0 y0 ... x3 y3
+            __m512d b = _mm512_loadu_pd(d + 8); // x4 y4 ... x7 y7
+            return {_mm512_permutex2var_pd(a, lanes(0, 2, 4, 6, 8, 10, 12, 14), b),
+                    _mm512_permutex2var_pd(a, lanes(1, 3, 5, 7, 9, 11, 13, 15), b), _mm512_setzero_pd()};
+        }
+
+        GEOMETRY_TARGET("avx512f") inline Avx512Lanes loadAvx512(const v2::Point* p) {
+            const double* d = coordinates(p);
+            __m512d a = _mm512_loadu_pd(d);      // x0 y0 z0 ... x2 y2
+            __m512d b = _mm512_loadu_pd(d + 8);  // z2 x3 y3 ... z4 x5
+            __m512d c = _mm512_loadu_pd(d + 16); // y5 z5 x6 ... y7 z7
+            __m512d x = _mm512_permutex2var_pd(a, lanes(0, 3, 6, 9, 12, 15, 0, 0), b);
+            __m512d y = _mm512_permutex2var_pd(a, lanes(1, 4, 7, 10, 13, 0, 0, 0), b);
+            __m512d z = _mm512_permutex2var_pd(a, lanes(2, 5, 8, 11, 14, 0, 0, 0), b);
+            return {_mm512_permutex2var_pd(x, lanes(0, 1, 2, 3, 4, 5, 10, 13), c),
+                    _mm512_permutex2var_pd(y, lanes(0, 1, 2, 3, 4, 8, 11, 14), c),
+                    _mm512_permutex2var_pd(z, lanes(0, 1, 2, 3, 4, 9, 12, 15), c)};
+        }
+
+        GEOMETRY_TARGET("avx512f") inline void storeAvx512(v1::Point* p, const Avx512Lanes& v) {
+            double* d = coordinates(p);
+            _mm512_storeu_pd(d, _mm512_permutex2var_pd(v.x, lanes(0, 8, 1, 9, 2, 10, 3, 11), v.y));
+            _mm512_storeu_pd(d + 8, _mm512_permutex2var_pd(v.x, lanes(4, 12, 5, 13, 6, 14, 7, 15), v.y));
+        }
+
+        GEOMETRY_TARGET("avx512f") inline void storeAvx512(v2::Point* p, const Avx512Lanes& v) {
+            double* d = coordinates(p);
+            __m512d a = _mm512_permutex2var_pd(v.x, lanes(0, 8, 0, 1, 9, 0, 2, 10), v.y);  // x0 y0 __ x1 y1 __ x2 y2
+            __m512d b = _mm512_permutex2var_pd(v.x, lanes(0, 3, 11, 0, 4, 12, 0, 5), v.y); // __ x3 y3 __ x4 y4 __ x5
+            __m512d c = _mm512_permutex2var_pd(v.x, lanes(13, 0, 6, 14, 0, 7, 15, 0), v.y); // y5 __ x6 y6 __ x7 y7 __
+            _mm512_storeu_pd(d, _mm512_permutex2var_pd(a, lanes(0, 1, 8, 3, 4, 9, 6, 7), v.z));
+            _mm512_storeu_pd(d + 8, _mm512_permutex2var_pd(b, lanes(10, 1, 2, 11, 4, 5, 12, 7), v.z));
+            _mm512_storeu_pd(d + 16, _mm512_permutex2var_pd(c, lanes(0, 13, 2, 3, 14, 5, 6, 15), v.z));
+        }
+
+        template <typename Point>
+        GEOMETRY_TARGET("avx512f") Avx512Lanes broadcastAvx512(Point p) {
+            if constexpr (kDimensions<Point> == 3) {
+                return {_mm512_set1_pd(p.x), _mm512_set1_pd(p.y), _mm512_set1_pd(p.z)};
+            } else {
+                return {_mm512_set1_pd(p.x), _mm512_set1_pd(p.y), _mm512_setzero_pd()};
+            }
+        }
+#endif // GEOMETRY_X86
+    } // namespace simd
+} // namespace Geometry
+
+#endif // GEOMETRY_SIMD_H
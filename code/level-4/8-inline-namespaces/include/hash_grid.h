@@ -0,0 +1,125 @@
+// hash_grid.h - Uniform grid over Geometry points, hashed by cell, with insert and remove
+#ifndef HASH_GRID_H
+#define HASH_GRID_H
+
+#include "geometry.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace Geometry {
+    // Nearest-neighbour and radius queries over a set of points that
+    // changes: where a KdTree would have to be rebuilt, a HashGrid takes
+    // insert() and remove() in O(1).
+    //
+    // Space is cut into cubes (squares for v1::Point) of cellSize. Only
+    // occupied cells exist, as buckets of points in a hash map keyed by
+    // the cell's integer coordinates, so memory follows the number of
+    // points, not the extent of the space. Queries scan the cells around
+    // the query point: a k-nearest search in growing rings of cells until
+    // no unvisited cell can beat the k-th best, a radius search over the
+    // cells the radius touches.
+    //
+    // Queries run in time proportional to the cells they touch, so pick a
+    // cellSize around the typical query radius, or about the distance that
+    // puts a few points in a cell for k-nearest queries. Far too small
+    // cells make large queries walk many empty cells; far too large ones
+    // degrade towards a brute-force scan.
+    //
+    // Ids come from insert() (or are the positions in the bulk span) and
+    // may be reused after remove(). Results carry ids and
+    // distance(query, point) exactly, ordered by distance, ties by id.
+    // Coordinates must be finite and within 2^61 cells of the origin,
+    // otherwise insert() and the queries throw std::invalid_argument.
+    // Not thread-safe for writes; concurrent queries are fine.
+    template <typename Point = v2::Point>
+    class HashGrid {
+    public:
+        static constexpr std::size_t kDimensions = Geometry::kDimensions<Point>;
+        using Cell = std::array<std::int64_t, kDimensions>;
+
+    private:
+        struct CellHash {
+            std::size_t operator()(const Cell& cell) const;
+        };
+
+        struct Entry {
+            Point point;
+            std::size_t id;
+        };
+
+        struct Slot {
+            Point point;
+            std::size_t position; // in its cell's bucket
+            bool live;
+        };
+
+        double side;
+        double inverseSide;
+        std::unordered_map<Cell, std::vector<Entry>, CellHash> cells;
+        std::vector<Slot> slots; // by id
+        std::vector<std::size_t> freeIds;
+        std::size_t count = 0;
+        Cell lowest; // box around every cell ever occupied
+        Cell highest;
+
+        Cell cellOf(Point p) const;
+
+    public:
+        // cellSize must be positive and finite, otherwise
+        // std::invalid_argument.
+        explicit HashGrid(double cellSize);
+
+        // Bulk load: point i gets id i.
+        HashGrid(double cellSize, std::span<const Point> points);
+
+        std::size_t insert(Point p);
+
+        // False if id is not in the grid.
+        bool remove(std::size_t id);
+
+        bool contains(std::size_t id) const {
+            return id < slots.size() && slots[id].live;
+        }
+
+        // The point with this id; undefined unless contains(id).
+        Point point(std::size_t id) const {
+            return slots[id].point;
+        }
+
+        std::size_t size() const {
+            return count;
+        }
+
+        bool empty() const {
+            return count == 0;
+        }
+
+        double cellSize() const {
+            return side;
+        }
+
+        std::size_t cellCount() const {
+            return cells.size();
+        }
+
+        // Throws std::invalid_argument on an empty grid.
+        Nearest nearest(Point query) const;
+
+        // The k closest points (all of them if there are fewer).
+        std::vector<Nearest> nearest(Point query, std::size_t k) const;
+
+        // Every point with distance(query, point) <= radius.
+        std::vector<Nearest> within(Point query, double radius) const;
+    };
+
+    // Defined in hash_grid.cpp for the two point versions.
+    extern template class HashGrid<v1::Point>;
+    extern template class HashGrid<v2::Point>;
+} // namespace Geometry
+
+#endif // HASH_GRID_H
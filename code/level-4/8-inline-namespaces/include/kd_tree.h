@@ -0,0 +1,80 @@
+// kd_tree.h - Static k-d tree over Geometry points, stored as one flat array
+#ifndef KD_TREE_H
+#define KD_TREE_H
+
+#include "geometry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Geometry {
+    // Nearest-neighbour and radius queries over a fixed set of points, for
+    // when brute force (one distance() per point per query) is too slow.
+    //
+    //     Geometry::KdTree<> tree(points);
+    //     std::vector<Geometry::Nearest> near = tree.nearest(q, 8);
+    //
+    // The tree is implicit: there are no node objects or child pointers,
+    // only the points, reordered. The range [lo, hi) at depth d keeps its
+    // split point at mid = lo + (hi - lo) / 2; on axis d % kDimensions,
+    // everything in [lo, mid) is <= the split point and everything in
+    // (mid, hi) is >= it. Ranges of kLeafSize points or fewer are scanned.
+    // Queries walk a contiguous array, and the tree costs no memory beyond
+    // the points and their original indices.
+    //
+    // Construction partitions with std::nth_element, O(n log n) in total;
+    // the two halves of each of the top splits are built on separate
+    // threads. The tree is immutable afterwards, so concurrent queries
+    // are safe.
+    //
+    // Results carry the index of the point in the span the tree was built
+    // from and distance(query, point) exactly. They are ordered by
+    // distance, ties by index, the same order a brute-force scan gives.
+    // Coordinates must be finite.
+    template <typename Point = v2::Point>
+    class KdTree {
+    public:
+        static constexpr std::size_t kDimensions = Geometry::kDimensions<Point>;
+        static constexpr std::size_t kLeafSize = 16;
+
+        struct Entry {
+            Point point;
+            std::uint32_t index; // position in the input
+        };
+
+    private:
+        std::vector<Entry> entries;
+
+    public:
+        KdTree() = default;
+
+        // threads = 0 uses std::thread::hardware_concurrency(). Throws
+        // std::length_error past 2^32 - 1 points.
+        explicit KdTree(std::span<const Point> points, unsigned threads = 0);
+
+        std::size_t size() const {
+            return entries.size();
+        }
+
+        bool empty() const {
+            return entries.empty();
+        }
+
+        // Throws std::invalid_argument on an empty tree.
+        Nearest nearest(Point query) const;
+
+        // The k closest points (all of them if there are fewer).
+        std::vector<Nearest> nearest(Point query, std::size_t k) const;
+
+        // Every point with distance(query, point) <= radius.
+        std::vector<Nearest> within(Point query, double radius) const;
+    };
+
+    // Defined in kd_tree.cpp for the two point versions.
+    extern template class KdTree<v1::Point>;
+    extern template class KdTree<v2::Point>;
+} // namespace Geometry
+
+#endif // KD_TREE_H
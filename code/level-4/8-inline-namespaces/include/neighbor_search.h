@@ -0,0 +1,124 @@
+// neighbor_search.h - Helpers shared by the Geometry spatial indexes
+#ifndef NEIGHBOR_SEARCH_H
+#define NEIGHBOR_SEARCH_H
+
+#include "geometry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+// Only the library's own .cpp files include this header; the public API is
+// in kd_tree.h and hash_grid.h.
+//
+// Every index compares squaredDistance(query, point), the value distance()
+// takes the square root of, and reports std::sqrt of it, so their distances
+// are bit-identical to distance(query, point) (unless the compiler contracts
+// the inline squaredDistance() into FMAs in one place and not the other, as
+// with -ffp-contract=fast on FMA targets). Pruning tests compare a
+// per-axis gap against the same squared values; rounding is monotonic, so a
+// gap never comes out larger than the distance of a point beyond it and a
+// pruned region never holds a better candidate.
+
+namespace Geometry {
+    namespace search {
+        template <typename Point>
+        double coordinate(const Point& p, std::size_t axis) {
+            if constexpr (kDimensions<Point> == 3) {
+                return axis == 0 ? p.x : axis == 1 ? p.y : p.z;
+            } else {
+                return axis == 0 ? p.x : p.y;
+            }
+        }
+
+        // Results are ordered by distance, then by index, so every index
+        // and the brute-force scan agree on ties.
+        struct Candidate {
+            double d2;
+            std::size_t index;
+
+            bool operator<(const Candidate& other) const {
+                return d2 < other.d2 || (d2 == other.d2 && index < other.index);
+            }
+        };
+
+        inline std::vector<Nearest> sortedResults(std::vector<Candidate>& candidates) {
+            std::sort(candidates.begin(), candidates.end());
+            std::vector<Nearest> results;
+            results.reserve(candidates.size());
+            for (const Candidate& c : candidates) {
+                results.push_back(Nearest{c.index, std::sqrt(c.d2)});
+            }
+            return results;
+        }
+
+        // Keeps exactly the points with distance() <= radius. Regions and
+        // points are first held against radius² with some headroom for
+        // rounding (a correctly rounded square root can come out <= radius
+        // for a value a hair above radius²); only the points that pass take
+        // a square root.
+        class RadiusTest {
+        private:
+            double radius;
+            double limit;
+
+        public:
+            explicit RadiusTest(double r)
+                : radius(r)
+                , limit(r * r * (1 + 0x1p-48)) {}
+
+            // Can anything at this squared gap or farther still be in range?
+            bool reaches(double gap2) const {
+                return gap2 <= limit;
+            }
+
+            bool accepts(double d2) const {
+                return d2 <= limit && std::sqrt(d2) <= radius;
+            }
+        };
+
+        // The k best candidates seen so far, in a max-heap with the worst
+        // one at the front. k must be at least 1.
+        class NeighborHeap {
+        private:
+            std::vector<Candidate> heap;
+            std::size_t k;
+
+        public:
+            explicit NeighborHeap(std::size_t wanted)
+                : k(wanted) {
+                heap.reserve(wanted);
+            }
+
+            bool full() const {
+                return heap.size() == k;
+            }
+
+            // Squared distance a region must be within to still matter
+            // (ties can win on index, so "within" includes equal).
+            double bound() const {
+                return full() ? heap.front().d2 : std::numeric_limits<double>::infinity();
+            }
+
+            void offer(double d2, std::size_t index) {
+                Candidate candidate{d2, index};
+                if (!full()) {
+                    heap.push_back(candidate);
+                    std::push_heap(heap.begin(), heap.end());
+                } else if (candidate < heap.front()) {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.back() = candidate;
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            }
+
+            std::vector<Nearest> results() {
+                return sortedResults(heap);
+            }
+        };
+    } // namespace search
+} // namespace Geometry
+
+#endif // NEIGHBOR_SEARCH_H
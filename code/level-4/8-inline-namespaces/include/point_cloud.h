@@ -0,0 +1,242 @@
+// point_cloud.h - Structure-of-arrays storage for Geometry points
+#ifndef POINT_CLOUD_H
+#define POINT_CLOUD_H
+
+#include "geometry.h"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace Geometry {
+    // AoS <-> SoA conversion, vectorized with the same kernels and the same
+    // simdLevel() as the batch distance functions. Every column needs room
+    // for points.size() doubles.
+    void toColumns(std::span<const v1::Point> points, double* x, double* y);
+    void toColumns(std::span<const v2::Point> points, double* x, double* y, double* z);
+    void fromColumns(const double* x, const double* y, std::span<v1::Point> points);
+    void fromColumns(const double* x, const double* y, const double* z, std::span<v2::Point> points);
+
+    // Non-owning, zero-copy access to kDimensions coordinate columns: all
+    // or part of a PointCloud, or SoA arrays that live somewhere else. Cheap
+    // to copy; valid as long as the columns are.
+    template <typename Point = v2::Point>
+    class PointCloudView {
+    public:
+        static constexpr std::size_t kDimensions = Geometry::kDimensions<Point>;
+
+    private:
+        std::array<const double*, kDimensions> columns{};
+        std::size_t count = 0;
+
+    public:
+        PointCloudView() = default;
+
+        PointCloudView(const std::array<const double*, kDimensions>& starts, std::size_t size)
+            : columns(starts)
+            , count(size) {}
+
+        std::size_t size() const {
+            return count;
+        }
+
+        bool empty() const {
+            return count == 0;
+        }
+
+        // Throws std::out_of_range for axis >= kDimensions.
+        std::span<const double> column(std::size_t axis) const {
+            return {columns.at(axis), count};
+        }
+
+        std::span<const double> x() const {
+            return column(0);
+        }
+
+        std::span<const double> y() const {
+            return column(1);
+        }
+
+        std::span<const double> z() const
+            requires(kDimensions == 3)
+        {
+            return column(2);
+        }
+
+        Point operator[](std::size_t i) const {
+            if constexpr (kDimensions == 3) {
+                return Point{columns[0][i], columns[1][i], columns[2][i]};
+            } else {
+                return Point{columns[0][i], columns[1][i]};
+            }
+        }
+
+        // Points [offset, offset + n), still without copying. Throws
+        // std::out_of_range if that runs past size().
+        PointCloudView subview(std::size_t offset, std::size_t n) const {
+            if (offset > count || n > count - offset) {
+                throw std::out_of_range("PointCloudView::subview: range past the end");
+            }
+            std::array<const double*, kDimensions> starts = columns;
+            for (const double*& start : starts) {
+                start += offset;
+            }
+            return PointCloudView(starts, n);
+        }
+
+        // Back to packed points; out.size() must equal size().
+        void toPoints(std::span<Point> out) const {
+            if (out.size() != count) {
+                throw std::invalid_argument("PointCloudView::toPoints: output size does not match");
+            }
+            if constexpr (kDimensions == 3) {
+                fromColumns(columns[0], columns[1], columns[2], out);
+            } else {
+                fromColumns(columns[0], columns[1], out);
+            }
+        }
+
+        std::vector<Point> toPoints() const {
+            std::vector<Point> points(count);
+            toPoints(points);
+            return points;
+        }
+    };
+
+    // Geometry points stored as structure-of-arrays: x, y and (for
+    // v2::Point) z each in an array of their own. A v2::Point array
+    // interleaves the coordinates, so a scan over x alone still pulls every
+    // y and z through the cache, and a SIMD register holds 2 2/3 points
+    // instead of 8 x values. PointCloud<v1::Point> has no z column at all.
+    //
+    // Every column starts on a kAlignment boundary and is padded to a
+    // multiple of kLanes doubles. Entries between size() and paddedSize()
+    // read as 0.0, so a loop may run whole aligned vectors up to
+    // paddedSize() with no scalar tail (and must ignore those extra lanes).
+    //
+    // All columns share one kAlignment-aligned allocation, column after
+    // column, a whole number of kLanes doubles apart. When capacity() runs
+    // out it doubles, and every column is copied into a new block.
+    template <typename Point = v2::Point>
+    class PointCloud {
+    public:
+        static constexpr std::size_t kDimensions = Geometry::kDimensions<Point>;
+        static constexpr std::size_t kAlignment = 64; // a cache line, one AVX-512 register
+        static constexpr std::size_t kLanes = kAlignment / sizeof(double);
+
+    private:
+        struct AlignedDelete {
+            void operator()(double* p) const noexcept {
+                ::operator delete[](p, std::align_val_t(kAlignment));
+            }
+        };
+
+        // kDimensions columns of `allocated` doubles each, back to back.
+        std::unique_ptr<double[], AlignedDelete> storage;
+        std::size_t count = 0;
+        std::size_t allocated = 0;
+
+        void regrow(std::size_t capacity);
+        void zeroPadding();
+
+    public:
+        PointCloud() = default;
+        explicit PointCloud(std::span<const Point> points);
+        explicit PointCloud(PointCloudView<Point> points);
+        ~PointCloud() = default;
+
+        PointCloud(const PointCloud& other);
+        PointCloud& operator=(const PointCloud& other);
+        PointCloud(PointCloud&& other) noexcept;
+        PointCloud& operator=(PointCloud&& other) noexcept;
+
+        // Makes room for at least `capacity` points without changing size().
+        void reserve(std::size_t capacity);
+
+        // New points sit at the origin.
+        void resize(std::size_t n);
+        void clear();
+
+        void push_back(Point p);
+
+        // Converts the whole span in one vectorized pass.
+        void append(std::span<const Point> points);
+
+        Point operator[](std::size_t i) const;
+        void set(std::size_t i, Point p);
+
+        // Aligned, paddedSize() entries long. Throws std::out_of_range for
+        // axis >= kDimensions.
+        double* column(std::size_t axis);
+        const double* column(std::size_t axis) const;
+
+        std::span<double> x() {
+            return {column(0), count};
+        }
+
+        std::span<double> y() {
+            return {column(1), count};
+        }
+
+        std::span<double> z()
+            requires(kDimensions == 3)
+        {
+            return {column(2), count};
+        }
+
+        std::span<const double> x() const {
+            return {column(0), count};
+        }
+
+        std::span<const double> y() const {
+            return {column(1), count};
+        }
+
+        std::span<const double> z() const
+            requires(kDimensions == 3)
+        {
+            return {column(2), count};
+        }
+
+        std::size_t size() const {
+            return count;
+        }
+
+        bool empty() const {
+            return count == 0;
+        }
+
+        std::size_t capacity() const {
+            return allocated;
+        }
+
+        // size() rounded up to a multiple of kLanes.
+        std::size_t paddedSize() const {
+            return (count + kLanes - 1) / kLanes * kLanes;
+        }
+
+        PointCloudView<Point> view() const;
+
+        operator PointCloudView<Point>() const {
+            return view();
+        }
+
+        void toPoints(std::span<Point> out) const {
+            view().toPoints(out);
+        }
+
+        std::vector<Point> toPoints() const {
+            return view().toPoints();
+        }
+    };
+
+    // Defined in point_cloud.cpp for the two point versions.
+    extern template class PointCloud<v1::Point>;
+    extern template class PointCloud<v2::Point>;
+} // namespace Geometry
+
+#endif // POINT_CLOUD_H
@@ -0,0 +1,298 @@
+#include "distance_matrix.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Geometry {
+    namespace {
+        using Metric = MatrixOptions::Metric;
+
+        // One rectangle of the output: element (i, j) is out[i * stride + j].
+        // Mirrored: rows and columns are the same points, so only the tiles
+        // on and above the diagonal are computed, then transposed.
+        template <typename Point>
+        struct Block {
+            std::span<const Point> rows;
+            std::span<const Point> columns;
+            double* out;
+            std::size_t stride;
+            bool mirrored;
+        };
+
+        struct Tile {
+            std::size_t block;
+            std::size_t row; // first row and column, within the block
+            std::size_t column;
+        };
+
+        template <typename Point>
+        void fillTile(const Block<Point>& block, std::size_t row, std::size_t column, const MatrixOptions& options) {
+            const std::size_t rowEnd = std::min(row + options.tile, block.rows.size());
+            const std::size_t width = std::min(options.tile, block.columns.size() - column);
+            const std::span<const Point> columns = block.columns.subspan(column, width);
+            for (std::size_t i = row; i < rowEnd; ++i) {
+                const std::span<double> out(block.out + i * block.stride + column, width);
+                if (options.metric == Metric::Distance) {
+                    distances(block.rows[i], columns, out);
+                } else {
+                    squaredDistances(block.rows[i], columns, out);
+                }
+            }
+            if (block.mirrored && row != column) {
+                // Reads a column of the tile just written (still in cache),
+                // writes a contiguous row of its mirror image.
+                for (std::size_t j = column; j < column + width; ++j) {
+                    double* mirror = block.out + j * block.stride;
+                    for (std::size_t i = row; i < rowEnd; ++i) {
+                        mirror[i] = block.out[i * block.stride + j];
+                    }
+                }
+            }
+        }
+
+        template <typename Point>
+        void computeBlocks(std::span<const Block<Point>> blocks, const MatrixOptions& options) {
+            std::vector<Tile> tiles;
+            for (std::size_t b = 0; b < blocks.size(); ++b) {
+                for (std::size_t row = 0; row < blocks[b].rows.size(); row += options.tile) {
+                    const std::size_t first = blocks[b].mirrored ? row : 0;
+                    for (std::size_t column = first; column < blocks[b].columns.size(); column += options.tile) {
+                        tiles.push_back(Tile{b, row, column});
+                    }
+                }
+            }
+
+            unsigned threads = options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+            threads = static_cast<unsigned>(std::min<std::size_t>(threads, tiles.size()));
+            std::atomic<std::size_t> next{0};
+            auto work = [&] {
+                for (std::size_t t; (t = next.fetch_add(1, std::memory_order_relaxed)) < tiles.size();) {
+                    fillTile(blocks[tiles[t].block], tiles[t].row, tiles[t].column, options);
+                }
+            };
+
+            std::vector<std::thread> pool;
+            try {
+                for (unsigned t = 1; t < threads; ++t) {
+                    pool.emplace_back(work);
+                }
+            } catch (...) {
+                next = tiles.size(); // stop the threads already running
+                for (std::thread& thread : pool) {
+                    thread.join();
+                }
+                throw;
+            }
+            work();
+            for (std::thread& thread : pool) {
+                thread.join();
+            }
+        }
+
+        void checkOptions(const MatrixOptions& options) {
+            if (options.tile == 0) {
+                throw std::invalid_argument("Geometry::distanceMatrix: tile must be at least 1");
+            }
+        }
+
+        // rows * columns, or std::length_error if that overflows.
+        std::size_t elements(std::size_t rows, std::size_t columns) {
+            if (columns != 0 && rows > std::numeric_limits<std::size_t>::max() / sizeof(double) / columns) {
+                throw std::length_error("Geometry::distanceMatrix: matrix too large");
+            }
+            return rows * columns;
+        }
+
+        template <typename Point>
+        void matrix(std::span<const Point> rows, std::span<const Point> columns, std::span<double> out,
+                    const MatrixOptions& options, bool mirrored) {
+            checkOptions(options);
+            if (out.size() != elements(rows.size(), columns.size())) {
+                throw std::invalid_argument("Geometry::distanceMatrix: output size is not rows x columns");
+            }
+            const Block<Point> block{rows, columns, out.data(), columns.size(), mirrored};
+            computeBlocks(std::span<const Block<Point>>(&block, 1), options);
+        }
+
+#if defined(_WIN32)
+        // No mmap: each window is a buffer, appended to the file when done.
+        class MatrixFile {
+        private:
+            std::ofstream file;
+            std::vector<double> buffer;
+
+        public:
+            MatrixFile(const std::string& path, std::size_t)
+                : file(path, std::ios::binary | std::ios::trunc) {
+                if (!file) {
+                    throw std::system_error(std::make_error_code(std::errc::io_error), "writeDistanceMatrix: cannot create " + path);
+                }
+                file.exceptions(std::ios::failbit | std::ios::badbit);
+            }
+
+            // Windows come in file order.
+            double* window(std::size_t, std::size_t bytes) {
+                buffer.assign(bytes / sizeof(double), 0.0);
+                return buffer.data();
+            }
+
+            void release() {
+                file.write(reinterpret_cast<const char*>(buffer.data()),
+                           static_cast<std::streamsize>(buffer.size() * sizeof(double)));
+            }
+        };
+#else
+        [[noreturn]] void throwErrno(const std::string& what) {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+
+        // The output file, sized up front and mapped one window at a time.
+        class MatrixFile {
+        private:
+            int fd = -1;
+            void* mapping = nullptr;
+            std::size_t mappedBytes = 0;
+
+            void unmap() noexcept {
+                if (mapping != nullptr) {
+                    ::munmap(mapping, mappedBytes);
+                    mapping = nullptr;
+                }
+            }
+
+        public:
+            MatrixFile(const std::string& path, std::size_t bytes) {
+                fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                if (fd < 0) {
+                    throwErrno("writeDistanceMatrix: cannot create " + path);
+                }
+                // Reserving the blocks now makes a full disk fail here, with
+                // ENOSPC, instead of as SIGBUS while writing to the mapping.
+#if defined(__linux__)
+                const int error = bytes == 0 ? 0 : ::posix_fallocate(fd, 0, static_cast<off_t>(bytes));
+#else
+                const int error = ::ftruncate(fd, static_cast<off_t>(bytes)) == 0 ? 0 : errno;
+#endif
+                if (error != 0) {
+                    ::close(fd);
+                    errno = error;
+                    throwErrno("writeDistanceMatrix: cannot size " + path);
+                }
+            }
+
+            ~MatrixFile() {
+                unmap();
+                ::close(fd);
+            }
+
+            MatrixFile(const MatrixFile&) = delete;
+            MatrixFile& operator=(const MatrixFile&) = delete;
+
+            // Maps bytes at offset, widened down to a page boundary as mmap
+            // requires.
+            double* window(std::size_t offset, std::size_t bytes) {
+                static const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+                const std::size_t start = offset / page * page;
+                mappedBytes = bytes + (offset - start);
+                mapping = ::mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, static_cast<off_t>(start));
+                if (mapping == MAP_FAILED) {
+                    mapping = nullptr;
+                    throwErrno("writeDistanceMatrix: cannot map the output");
+                }
+                return reinterpret_cast<double*>(static_cast<char*>(mapping) + (offset - start));
+            }
+
+            // The dirty pages stay in the page cache until the kernel writes
+            // them back; unmapping only lets it drop them afterwards.
+            void release() {
+                unmap();
+            }
+        };
+#endif
+
+        template <typename Point>
+        void writeMatrix(std::span<const Point> rows, std::span<const Point> columns, const std::string& path,
+                         const MatrixOptions& options, bool mirrored) {
+            checkOptions(options);
+            const std::size_t rowBytes = columns.size() * sizeof(double);
+            MatrixFile file(path, elements(rows.size(), columns.size()) * sizeof(double));
+            if (rowBytes == 0) {
+                return;
+            }
+            const std::size_t windowRows = std::max<std::size_t>(1, options.windowBytes / rowBytes);
+            for (std::size_t first = 0; first < rows.size(); first += windowRows) {
+                const std::size_t count = std::min(windowRows, rows.size() - first);
+                double* out = file.window(first * rowBytes, count * rowBytes);
+                const std::span<const Point> windowPoints = rows.subspan(first, count);
+                std::vector<Block<Point>> blocks;
+                if (mirrored) {
+                    // Left of the window's diagonal square, the square itself,
+                    // and right of it.
+                    blocks.push_back(Block<Point>{windowPoints, columns.first(first), out, columns.size(), false});
+                    blocks.push_back(
+                        Block<Point>{windowPoints, columns.subspan(first, count), out + first, columns.size(), true});
+                    blocks.push_back(Block<Point>{windowPoints, columns.subspan(first + count), out + first + count,
+                                                  columns.size(), false});
+                } else {
+                    blocks.push_back(Block<Point>{windowPoints, columns, out, columns.size(), false});
+                }
+                computeBlocks(std::span<const Block<Point>>(blocks), options);
+                file.release();
+            }
+        }
+    } // namespace
+
+    namespace v1 {
+        void distanceMatrix(std::span<const Point> points, std::span<double> out, const MatrixOptions& options) {
+            matrix(points, points, out, options, true);
+        }
+
+        void distanceMatrix(std::span<const Point> rows, std::span<const Point> columns, std::span<double> out,
+                            const MatrixOptions& options) {
+            matrix(rows, columns, out, options, false);
+        }
+
+        void writeDistanceMatrix(std::span<const Point> points, const std::string& path, const MatrixOptions& options) {
+            writeMatrix(points, points, path, options, true);
+        }
+
+        void writeDistanceMatrix(std::span<const Point> rows, std::span<const Point> columns, const std::string& path,
+                                 const MatrixOptions& options) {
+            writeMatrix(rows, columns, path, options, false);
+        }
+    } // namespace v1
+
+    namespace v2 {
+        void distanceMatrix(std::span<const Point> points, std::span<double> out, const MatrixOptions& options) {
+            matrix(points, points, out, options, true);
+        }
+
+        void distanceMatrix(std::span<const Point> rows, std::span<const Point> columns, std::span<double> out,
+                            const MatrixOptions& options) {
+            matrix(rows, columns, out, options, false);
+        }
+
+        void writeDistanceMatrix(std::span<const Point> points, const std::string& path, const MatrixOptions& options) {
+            writeMatrix(points, points, path, options, true);
+        }
+
+        void writeDistanceMatrix(std::span<const Point> rows, std::span<const Point> columns, const std::string& path,
+                                 const MatrixOptions& options) {
+            writeMatrix(rows, columns, path, options, false);
+        }
+    } // namespace v2
+} // namespace Geometry
@@ -0,0 +1,433 @@
+// geometry_batch.cpp - Batched distance kernels (scalar, SSE2, AVX2, AVX-512) and their CPU dispatch
+#include "geometry_simd.h"
+
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+
+// The kernels must round exactly where distance() does. AVX-512F brings FMA
+// along, and GCC (C++ defaults to -ffp-contract=fast) would otherwise fuse
+// the multiplies and adds below, up to 2 ULP away from distance().
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize("fp-contract=off")
+#elif defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#endif
+
+namespace Geometry {
+    namespace {
+        using namespace simd;
+
+        // ------------------------------------------------------------------
+        // Scalar: the fallback, and the tail after the last full SIMD block.
+        // ------------------------------------------------------------------
+        // Root = false leaves out the square root: squaredDistances().
+        template <bool Root, typename Point>
+        void oneToManyScalar(Point from, const Point* to, double* out, std::size_t begin, std::size_t n) {
+            for (std::size_t i = begin; i < n; ++i) {
+                const double d2 = squaredDistance(from, to[i]);
+                out[i] = Root ? std::sqrt(d2) : d2;
+            }
+        }
+
+        template <typename Point>
+        void pairwiseScalar(const Point* a, const Point* b, double* out, std::size_t begin, std::size_t n) {
+            for (std::size_t i = begin; i < n; ++i) {
+                out[i] = std::sqrt(squaredDistance(a[i], b[i]));
+            }
+        }
+
+        // Continues a search at candidates[begin]; index and best (a squared
+        // distance) hold the closest candidate found so far.
+        template <typename Point>
+        void nearestScalar(Point p, const Point* candidates, std::size_t begin, std::size_t n, std::size_t& index, double& best) {
+            for (std::size_t i = begin; i < n; ++i) {
+                double d2 = squaredDistance(p, candidates[i]);
+                if (d2 < best) {
+                    best = d2;
+                    index = i;
+                }
+            }
+        }
+
+        // Folds the per-lane winners of a SIMD search into index/best. Each
+        // lane kept the first minimum it saw, so ties go to the lower index.
+        void mergeLanes(const double* d2, const double* at, int lanes, std::size_t& index, double& best) {
+            for (int lane = 0; lane < lanes; ++lane) {
+                std::size_t i = static_cast<std::size_t>(at[lane]);
+                if (d2[lane] < best || (d2[lane] == best && i < index)) {
+                    best = d2[lane];
+                    index = i;
+                }
+            }
+        }
+
+#if defined(GEOMETRY_X86)
+        // ------------------------------------------------------------------
+        // SSE2: 2 points per block.
+        // ------------------------------------------------------------------
+        template <typename Point>
+        GEOMETRY_TARGET("sse2") __m128d squaredSse2(const Sse2Lanes& a, const Sse2Lanes& b) {
+            __m128d dx = _mm_sub_pd(b.x, a.x);
+            __m128d dy = _mm_sub_pd(b.y, a.y);
+            __m128d sum = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+            if constexpr (kDimensions<Point> == 3) {
+                __m128d dz = _mm_sub_pd(b.z, a.z);
+                sum = _mm_add_pd(sum, _mm_mul_pd(dz, dz));
+            }
+            return sum;
+        }
+
+        template <bool Root, typename Point>
+        GEOMETRY_TARGET("sse2") void oneToManySse2(Point from, const Point* to, double* out, std::size_t n) {
+            const Sse2Lanes f = broadcastSse2(from);
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                const __m128d d2 = squaredSse2<Point>(f, loadSse2(to + i));
+                if constexpr (Root) {
+                    _mm_storeu_pd(out + i, _mm_sqrt_pd(d2));
+                } else {
+                    _mm_storeu_pd(out + i, d2);
+                }
+            }
+            oneToManyScalar<Root>(from, to, out, i, n);
+        }
+
+        template <typename Point>
+        GEOMETRY_TARGET("sse2") void pairwiseSse2(const Point* a, const Point* b, double* out, std::size_t n) {
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                _mm_storeu_pd(out + i, _mm_sqrt_pd(squaredSse2<Point>(loadSse2(a + i), loadSse2(b + i))));
+            }
+            pairwiseScalar(a, b, out, i, n);
+        }
+
+        template <typename Point>
+        GEOMETRY_TARGET("sse2") void nearestSse2(Point p, const Point* candidates, std::size_t n, std::size_t& index, double& best) {
+            const Sse2Lanes q = broadcastSse2(p);
+            const __m128d step = _mm_set1_pd(2);
+            __m128d at = _mm_setr_pd(0, 1);
+            __m128d bestD2 = _mm_set1_pd(best);
+            __m128d bestAt = _mm_setzero_pd();
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                __m128d d2 = squaredSse2<Point>(q, loadSse2(candidates + i));
+                __m128d closer = _mm_cmplt_pd(d2, bestD2); // SSE2 has no blend
+                bestD2 = _mm_or_pd(_mm_and_pd(closer, d2), _mm_andnot_pd(closer, bestD2));
+                bestAt = _mm_or_pd(_mm_and_pd(closer, at), _mm_andnot_pd(closer, bestAt));
+                at = _mm_add_pd(at, step);
+            }
+            alignas(16) double laneD2[2];
+            alignas(16) double laneAt[2];
+            _mm_store_pd(laneD2, bestD2);
+            _mm_store_pd(laneAt, bestAt);
+            mergeLanes(laneD2, laneAt, 2, index, best);
+            nearestScalar(p, candidates, i, n, index, best);
+        }
+
+        // ------------------------------------------------------------------
+        // AVX2: 4 points per block.
+        // ------------------------------------------------------------------
+        template <typename Point>
+        GEOMETRY_TARGET("avx2") __m256d squaredAvx2(const Avx2Lanes& a, const Avx2Lanes& b) {
+            __m256d dx = _mm256_sub_pd(b.x, a.x);
+            __m256d dy = _mm256_sub_pd(b.y, a.y);
+            __m256d sum = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+            if constexpr (kDimensions<Point> == 3) {
+                __m256d dz = _mm256_sub_pd(b.z, a.z);
+                sum = _mm256_add_pd(sum, _mm256_mul_pd(dz, dz));
+            }
+            return sum;
+        }
+
+        template <bool Root, typename Point>
+        GEOMETRY_TARGET("avx2") void oneToManyAvx2(Point from, const Point* to, double* out, std::size_t n) {
+            const Avx2Lanes f = broadcastAvx2(from);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                const __m256d d2 = squaredAvx2<Point>(f, loadAvx2(to + i));
+                if constexpr (Root) {
+                    _mm256_storeu_pd(out + i, _mm256_sqrt_pd(d2));
+                } else {
+                    _mm256_storeu_pd(out + i, d2);
+                }
+            }
+            oneToManyScalar<Root>(from, to, out, i, n);
+        }
+
+        template <typename Point>
+        GEOMETRY_TARGET("avx2") void pairwiseAvx2(const Point* a, const Point* b, double* out, std::size_t n) {
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                _mm256_storeu_pd(out + i, _mm256_sqrt_pd(squaredAvx2<Point>(loadAvx2(a + i), loadAvx2(b + i))));
+            }
+            pairwiseScalar(a, b, out, i, n);
+        }
+
+        template <typename Point>
+        GEOMETRY_TARGET("avx2") void nearestAvx2(Point p, const Point* candidates, std::size_t n, std::size_t& index, double& best) {
+            const Avx2Lanes q = broadcastAvx2(p);
+            const __m256d step = _mm256_set1_pd(4);
+            __m256d at = _mm256_setr_pd(0, 1, 2, 3);
+            __m256d bestD2 = _mm256_set1_pd(best);
+            __m256d bestAt = _mm256_setzero_pd();
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                __m256d d2 = squaredAvx2<Point>(q, loadAvx2(candidates + i));
+                __m256d closer = _mm256_cmp_pd(d2, bestD2, _CMP_LT_OQ);
+                bestD2 = _mm256_blendv_pd(bestD2, d2, closer);
+                bestAt = _mm256_blendv_pd(bestAt, at, closer);
+                at = _mm256_add_pd(at, step);
+            }
+            alignas(32) double laneD2[4];
+            alignas(32) double laneAt[4];
+            _mm256_store_pd(laneD2, bestD2);
+            _mm256_store_pd(laneAt, bestAt);
+            mergeLanes(laneD2, laneAt, 4, index, best);
+            nearestScalar(p, candidates, i, n, index, best);
+        }
+
+        // ------------------------------------------------------------------
+        // AVX-512F: 8 points per block.
+        // ------------------------------------------------------------------
+        template <typename Point>
+        GEOMETRY_TARGET("avx512f") __m512d squaredAvx512(const Avx512Lanes& a, const Avx512Lanes& b) {
+            __m512d dx = _mm512_sub_pd(b.x, a.x);
+            __m512d dy = _mm512_sub_pd(b.y, a.y);
+            __m512d sum = _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy));
+            if constexpr (kDimensions<Point> == 3) {
+                __m512d dz = _mm512_sub_pd(b.z, a.z);
+                sum = _mm512_add_pd(sum, _mm512_mul_pd(dz, dz));
+            }
+            return sum;
+        }
+
+        // _mm512_sqrt_pd, without the undefined pass-through operand GCC 12
+        // warns about at -O3.
+        GEOMETRY_TARGET("avx512f") __m512d sqrtAvx512(__m512d v) {
+            return _mm512_maskz_sqrt_pd(0xFF, v);
+        }
+
+        template <bool Root, typename Point>
+        GEOMETRY_TARGET("avx512f") void oneToManyAvx512(Point from, const Point* to, double* out, std::size_t n) {
+            const Avx512Lanes f = broadcastAvx512(from);
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                const __m512d d2 = squaredAvx512<Point>(f, loadAvx512(to + i));
+                if constexpr (Root) {
+                    _mm512_storeu_pd(out + i, sqrtAvx512(d2));
+                } else {
+                    _mm512_storeu_pd(out + i, d2);
+                }
+            }
+            oneToManyScalar<Root>(from, to, out, i, n);
+        }
+
+        template <typename Point>
+        GEOMETRY_TARGET("avx512f") void pairwiseAvx512(const Point* a, const Point* b, double* out, std::size_t n) {
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                _mm512_storeu_pd(out + i, sqrtAvx512(squaredAvx512<Point>(loadAvx512(a + i), loadAvx512(b + i))));
+            }
+            pairwiseScalar(a, b, out, i, n);
+        }
+
+        template <typename Point>
+        GEOMETRY_TARGET("avx512f") void nearestAvx512(Point p, const Point* candidates, std::size_t n, std::size_t& index, double& best) {
+            const Avx512Lanes q = broadcastAvx512(p);
+            const __m512d step = _mm512_set1_pd(8);
+            __m512d at = _mm512_set_pd(7, 6, 5, 4, 3, 2, 1, 0);
+            __m512d bestD2 = _mm512_set1_pd(best);
+            __m512d bestAt = _mm512_setzero_pd();
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                __m512d d2 = squaredAvx512<Point>(q, loadAvx512(candidates + i));
+                __mmask8 closer = _mm512_cmp_pd_mask(d2, bestD2, _CMP_LT_OQ);
+                bestD2 = _mm512_mask_mov_pd(bestD2, closer, d2);
+                bestAt = _mm512_mask_mov_pd(bestAt, closer, at);
+                at = _mm512_add_pd(at, step);
+            }
+            alignas(64) double laneD2[8];
+            alignas(64) double laneAt[8];
+            _mm512_store_pd(laneD2, bestD2);
+            _mm512_store_pd(laneAt, bestAt);
+            mergeLanes(laneD2, laneAt, 8, index, best);
+            nearestScalar(p, candidates, i, n, index, best);
+        }
+#endif // GEOMETRY_X86
+
+        // ------------------------------------------------------------------
+        // Dispatch
+        // ------------------------------------------------------------------
+        SimdLevel detectSimdLevel() {
+#if defined(GEOMETRY_X86) && defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            const int maxLeaf = info[0];
+            __cpuid(info, 1);
+            const bool sse2 = (info[3] & (1 << 26)) != 0;
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            int leaf7[4] = {};
+            if (maxLeaf >= 7) {
+                __cpuidex(leaf7, 7, 0);
+            }
+            // The OS has to save the wider registers on a context switch:
+            // XMM+YMM for AVX2, plus the opmask and ZMM state for AVX-512.
+            const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+            if ((leaf7[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6) {
+                return SimdLevel::AVX512;
+            }
+            if ((leaf7[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6) {
+                return SimdLevel::AVX2;
+            }
+            return sse2 ? SimdLevel::SSE2 : SimdLevel::Scalar;
+#elif defined(GEOMETRY_X86)
+            // Checks the OS register state as well.
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) {
+                return SimdLevel::AVX512;
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                return SimdLevel::AVX2;
+            }
+            return __builtin_cpu_supports("sse2") ? SimdLevel::SSE2 : SimdLevel::Scalar;
+#else
+            return SimdLevel::Scalar;
+#endif
+        }
+
+        std::atomic<SimdLevel>& activeLevel() {
+            static std::atomic<SimdLevel> level{supportedSimdLevel()};
+            return level;
+        }
+
+        void checkSizes(std::size_t points, std::size_t out) {
+            if (points != out) {
+                throw std::invalid_argument("Geometry::distances: output size does not match the input");
+            }
+        }
+
+        template <bool Root, typename Point>
+        void batchDistances(Point from, std::span<const Point> to, std::span<double> out) {
+            checkSizes(to.size(), out.size());
+            switch (simdLevel()) {
+#if defined(GEOMETRY_X86)
+            case SimdLevel::AVX512:
+                return oneToManyAvx512<Root>(from, to.data(), out.data(), to.size());
+            case SimdLevel::AVX2:
+                return oneToManyAvx2<Root>(from, to.data(), out.data(), to.size());
+            case SimdLevel::SSE2:
+                return oneToManySse2<Root>(from, to.data(), out.data(), to.size());
+#endif
+            default:
+                return oneToManyScalar<Root>(from, to.data(), out.data(), 0, to.size());
+            }
+        }
+
+        template <typename Point>
+        void batchDistances(std::span<const Point> a, std::span<const Point> b, std::span<double> out) {
+            checkSizes(a.size(), b.size());
+            checkSizes(a.size(), out.size());
+            switch (simdLevel()) {
+#if defined(GEOMETRY_X86)
+            case SimdLevel::AVX512:
+                return pairwiseAvx512(a.data(), b.data(), out.data(), a.size());
+            case SimdLevel::AVX2:
+                return pairwiseAvx2(a.data(), b.data(), out.data(), a.size());
+            case SimdLevel::SSE2:
+                return pairwiseSse2(a.data(), b.data(), out.data(), a.size());
+#endif
+            default:
+                return pairwiseScalar(a.data(), b.data(), out.data(), 0, a.size());
+            }
+        }
+
+        template <typename Point>
+        Nearest batchNearest(Point p, std::span<const Point> candidates) {
+            if (candidates.empty()) {
+                throw std::invalid_argument("Geometry::nearest: no candidates");
+            }
+            std::size_t index = 0;
+            double best = std::numeric_limits<double>::infinity();
+            switch (simdLevel()) {
+#if defined(GEOMETRY_X86)
+            case SimdLevel::AVX512:
+                nearestAvx512(p, candidates.data(), candidates.size(), index, best);
+                break;
+            case SimdLevel::AVX2:
+                nearestAvx2(p, candidates.data(), candidates.size(), index, best);
+                break;
+            case SimdLevel::SSE2:
+                nearestSse2(p, candidates.data(), candidates.size(), index, best);
+                break;
+#endif
+            default:
+                nearestScalar(p, candidates.data(), 0, candidates.size(), index, best);
+                break;
+            }
+            return Nearest{index, std::sqrt(best)};
+        }
+    } // namespace
+
+    SimdLevel supportedSimdLevel() {
+        static const SimdLevel level = detectSimdLevel();
+        return level;
+    }
+
+    SimdLevel simdLevel() {
+        return activeLevel().load(std::memory_order_relaxed);
+    }
+
+    void setSimdLevel(SimdLevel level) {
+        activeLevel().store(level < supportedSimdLevel() ? level : supportedSimdLevel(), std::memory_order_relaxed);
+    }
+
+    const char* simdLevelName(SimdLevel level) {
+        switch (level) {
+        case SimdLevel::SSE2:
+            return "SSE2";
+        case SimdLevel::AVX2:
+            return "AVX2";
+        case SimdLevel::AVX512:
+            return "AVX-512";
+        default:
+            return "scalar";
+        }
+    }
+
+    namespace v1 {
+        void distances(Point from, std::span<const Point> to, std::span<double> out) {
+            batchDistances<true>(from, to, out);
+        }
+
+        void squaredDistances(Point from, std::span<const Point> to, std::span<double> out) {
+            batchDistances<false>(from, to, out);
+        }
+
+        void distances(std::span<const Point> a, std::span<const Point> b, std::span<double> out) {
+            batchDistances(a, b, out);
+        }
+
+        Nearest nearest(Point p, std::span<const Point> candidates) {
+            return batchNearest(p, candidates);
+        }
+    } // namespace v1
+
+    namespace v2 {
+        void distances(Point from, std::span<const Point> to, std::span<double> out) {
+            batchDistances<true>(from, to, out);
+        }
+
+        void squaredDistances(Point from, std::span<const Point> to, std::span<double> out) {
+            batchDistances<false>(from, to, out);
+        }
+
+        void distances(std::span<const Point> a, std::span<const Point> b, std::span<double> out) {
+            batchDistances(a, b, out);
+        }
+
+        Nearest nearest(Point p, std::span<const Point> candidates) {
+            return batchNearest(p, candidates);
+        }
+    } // namespace v2
+} // namespace Geometry
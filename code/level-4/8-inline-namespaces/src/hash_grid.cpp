@@ -0,0 +1,271 @@
+#include "hash_grid.h"
+#include "neighbor_search.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace Geometry {
+    namespace {
+        using search::coordinate;
+
+        // Cell coordinates stay below 2^61 so that differences and offsets
+        // between two cells still fit in an int64_t.
+        constexpr double kCellLimit = 0x1p61;
+
+        // Calls visit(cell) for every cell at Chebyshev distance exactly
+        // `ring` from center: the shell of a (2 ring + 1)-wide cube.
+        template <typename Cell, typename Visit>
+        void forEachInRing(const Cell& center, std::int64_t ring, Visit visit) {
+            Cell cell = center;
+            if (ring == 0) {
+                visit(cell);
+                return;
+            }
+            for (std::int64_t dx = -ring; dx <= ring; ++dx) {
+                cell[0] = center[0] + dx;
+                if constexpr (std::tuple_size_v<Cell> == 3) {
+                    for (std::int64_t dy = -ring; dy <= ring; ++dy) {
+                        cell[1] = center[1] + dy;
+                        const bool onShell = dx == -ring || dx == ring || dy == -ring || dy == ring;
+                        const std::int64_t step = onShell ? 1 : 2 * ring;
+                        for (std::int64_t dz = -ring; dz <= ring; dz += step) {
+                            cell[2] = center[2] + dz;
+                            visit(cell);
+                        }
+                    }
+                } else {
+                    const bool onShell = dx == -ring || dx == ring;
+                    const std::int64_t step = onShell ? 1 : 2 * ring;
+                    for (std::int64_t dy = -ring; dy <= ring; dy += step) {
+                        cell[1] = center[1] + dy;
+                        visit(cell);
+                    }
+                }
+            }
+        }
+
+        template <typename Cell>
+        std::int64_t chebyshev(const Cell& a, const Cell& b) {
+            std::int64_t most = 0;
+            for (std::size_t axis = 0; axis < a.size(); ++axis) {
+                most = std::max(most, a[axis] > b[axis] ? a[axis] - b[axis] : b[axis] - a[axis]);
+            }
+            return most;
+        }
+    } // namespace
+
+    template <typename Point>
+    std::size_t HashGrid<Point>::CellHash::operator()(const Cell& cell) const {
+        std::uint64_t h = 0;
+        for (std::int64_t c : cell) {
+            h = (h ^ static_cast<std::uint64_t>(c)) * 0x9E3779B97F4A7C15ull;
+            h ^= h >> 29;
+        }
+        return static_cast<std::size_t>(h);
+    }
+
+    template <typename Point>
+    HashGrid<Point>::HashGrid(double cellSize)
+        : side(cellSize)
+        , inverseSide(1 / cellSize) {
+        if (!(cellSize > 0) || !std::isfinite(cellSize)) {
+            throw std::invalid_argument("HashGrid: cell size must be positive and finite");
+        }
+        lowest.fill(std::numeric_limits<std::int64_t>::max());
+        highest.fill(std::numeric_limits<std::int64_t>::min());
+    }
+
+    template <typename Point>
+    HashGrid<Point>::HashGrid(double cellSize, std::span<const Point> points)
+        : HashGrid(cellSize) {
+        slots.reserve(points.size());
+        for (const Point& p : points) {
+            insert(p);
+        }
+    }
+
+    template <typename Point>
+    typename HashGrid<Point>::Cell HashGrid<Point>::cellOf(Point p) const {
+        Cell cell;
+        for (std::size_t axis = 0; axis < kDimensions; ++axis) {
+            const double c = std::floor(coordinate(p, axis) * inverseSide);
+            if (!(std::abs(c) < kCellLimit)) { // also catches NaN
+                throw std::invalid_argument("HashGrid: coordinate not finite or too far from the origin");
+            }
+            cell[axis] = static_cast<std::int64_t>(c);
+        }
+        return cell;
+    }
+
+    template <typename Point>
+    std::size_t HashGrid<Point>::insert(Point p) {
+        const Cell cell = cellOf(p);
+        const std::size_t id = freeIds.empty() ? slots.size() : freeIds.back();
+        std::vector<Entry>& bucket = cells[cell];
+        bucket.push_back(Entry{p, id});
+        const Slot slot{p, bucket.size() - 1, true};
+        if (id == slots.size()) {
+            try {
+                slots.push_back(slot);
+            } catch (...) {
+                bucket.pop_back();
+                throw;
+            }
+        } else {
+            slots[id] = slot;
+            freeIds.pop_back();
+        }
+        ++count;
+        for (std::size_t axis = 0; axis < kDimensions; ++axis) {
+            lowest[axis] = std::min(lowest[axis], cell[axis]);
+            highest[axis] = std::max(highest[axis], cell[axis]);
+        }
+        return id;
+    }
+
+    template <typename Point>
+    bool HashGrid<Point>::remove(std::size_t id) {
+        if (!contains(id)) {
+            return false;
+        }
+        freeIds.push_back(id); // first: the only step that can throw
+        Slot& slot = slots[id];
+        auto it = cells.find(cellOf(slot.point));
+        std::vector<Entry>& bucket = it->second;
+        bucket[slot.position] = bucket.back();
+        slots[bucket[slot.position].id].position = slot.position;
+        bucket.pop_back();
+        if (bucket.empty()) {
+            cells.erase(it);
+        }
+        slot.live = false;
+        --count;
+        return true;
+    }
+
+    template <typename Point>
+    Nearest HashGrid<Point>::nearest(Point query) const {
+        if (count == 0) {
+            throw std::invalid_argument("HashGrid::nearest: empty grid");
+        }
+        return nearest(query, 1).front();
+    }
+
+    template <typename Point>
+    std::vector<Nearest> HashGrid<Point>::nearest(Point query, std::size_t k) const {
+        if (k == 0 || count == 0) {
+            return {};
+        }
+        search::NeighborHeap best(std::min(k, count));
+        auto scan = [&](const std::vector<Entry>& bucket) {
+            for (const Entry& e : bucket) {
+                best.offer(squaredDistance(query, e.point), e.id);
+            }
+        };
+
+        const Cell center = cellOf(query);
+        // Rings past `reach` hold no occupied cell.
+        std::int64_t reach = 0;
+        double magnitude = 0;
+        for (std::size_t axis = 0; axis < kDimensions; ++axis) {
+            reach = std::max({reach, center[axis] - lowest[axis], highest[axis] - center[axis]});
+            magnitude = std::max({magnitude, std::abs(static_cast<double>(lowest[axis])),
+                                  std::abs(static_cast<double>(highest[axis])), std::abs(static_cast<double>(center[axis]))});
+        }
+        // cellOf() rounds x * (1 / side), which can put a point a few ulps
+        // of its cell coordinate across a boundary; this many cells of slack
+        // cover that.
+        const double slack = 1e-15 * (magnitude + 2);
+
+        for (std::int64_t ring = 0; ring <= reach; ++ring) {
+            // Once a ring has more cells than the grid has occupied ones,
+            // probing empty cells costs more than scanning what is left.
+            const double side2 = 2.0 * static_cast<double>(ring) + 1;
+            const double ringCells = std::pow(side2, kDimensions) - std::pow(side2 - 2, kDimensions);
+            if (ring > 0 && ringCells > static_cast<double>(cells.size())) {
+                for (const auto& [cell, bucket] : cells) {
+                    if (chebyshev(cell, center) >= ring) {
+                        scan(bucket);
+                    }
+                }
+                break;
+            }
+            forEachInRing(center, ring, [&](const Cell& cell) {
+                if (auto it = cells.find(cell); it != cells.end()) {
+                    scan(it->second);
+                }
+            });
+            // Every unvisited point is at least `ring` whole cells away on
+            // some axis.
+            const double gap = (static_cast<double>(ring) - slack) * side;
+            if (best.full() && gap > 0 && gap * gap > best.bound()) {
+                break;
+            }
+        }
+        return best.results();
+    }
+
+    template <typename Point>
+    std::vector<Nearest> HashGrid<Point>::within(Point query, double radius) const {
+        std::vector<search::Candidate> found;
+        if (count == 0 || !(radius >= 0)) {
+            return {};
+        }
+        const search::RadiusTest range(radius);
+        auto scan = [&](const std::vector<Entry>& bucket) {
+            for (const Entry& e : bucket) {
+                const double d2 = squaredDistance(query, e.point);
+                if (range.accepts(d2)) {
+                    found.push_back(search::Candidate{d2, e.id});
+                }
+            }
+        };
+
+        // The cells the radius covers, clipped to the occupied box. As in
+        // nearest(), a sliver of slack covers rounding in cellOf(), and the
+        // headroom RadiusTest allows past radius.
+        Cell from;
+        Cell to;
+        double boxCells = 1;
+        for (std::size_t axis = 0; axis < kDimensions; ++axis) {
+            const double q = coordinate(query, axis);
+            const double slack = 1e-14 * (1 + (std::abs(q) + radius) * inverseSide);
+            const double lo = std::floor((q - radius) * inverseSide - slack);
+            const double hi = std::floor((q + radius) * inverseSide + slack);
+            from[axis] = static_cast<std::int64_t>(std::max(lo, static_cast<double>(lowest[axis])));
+            to[axis] = static_cast<std::int64_t>(std::min(hi, static_cast<double>(highest[axis])));
+            if (from[axis] > to[axis]) {
+                return {};
+            }
+            boxCells *= static_cast<double>(to[axis] - from[axis]) + 1;
+        }
+
+        if (boxCells > static_cast<double>(cells.size())) {
+            for (const auto& [cell, bucket] : cells) {
+                scan(bucket);
+            }
+        } else {
+            Cell cell = from;
+            for (;;) {
+                if (auto it = cells.find(cell); it != cells.end()) {
+                    scan(it->second);
+                }
+                std::size_t axis = 0;
+                while (axis < kDimensions && cell[axis] == to[axis]) {
+                    cell[axis] = from[axis];
+                    ++axis;
+                }
+                if (axis == kDimensions) {
+                    break;
+                }
+                ++cell[axis];
+            }
+        }
+        return search::sortedResults(found);
+    }
+
+    template class HashGrid<v1::Point>;
+    template class HashGrid<v2::Point>;
+} // namespace Geometry
@@ -0,0 +1,139 @@
+#include "kd_tree.h"
+#include "neighbor_search.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+namespace Geometry {
+    namespace {
+        using search::coordinate;
+
+        template <typename Entry>
+        void build(Entry* first, std::size_t n, std::size_t depth, unsigned threads, std::size_t leafSize) {
+            if (n <= leafSize) {
+                return;
+            }
+            const std::size_t mid = n / 2;
+            const std::size_t axis = depth % kDimensions<decltype(first->point)>;
+            std::nth_element(first, first + mid, first + n, [axis](const Entry& a, const Entry& b) {
+                return coordinate(a.point, axis) < coordinate(b.point, axis);
+            });
+            // The split point stays at mid; only the ranges on either side
+            // are partitioned further.
+            if (threads > 1) {
+                std::thread left(build<Entry>, first, mid, depth + 1, threads / 2, leafSize);
+                build(first + mid + 1, n - mid - 1, depth + 1, threads - threads / 2, leafSize);
+                left.join();
+            } else {
+                build(first, mid, depth + 1, 1, leafSize);
+                build(first + mid + 1, n - mid - 1, depth + 1, 1, leafSize);
+            }
+        }
+
+        // Visits the query's side of the split first, so the heap's bound
+        // has usually tightened enough by the time the far side comes up.
+        template <typename Entry, typename Point>
+        void searchNearest(const Entry* first, std::size_t n, std::size_t depth, Point query, std::size_t leafSize,
+                           search::NeighborHeap& best) {
+            if (n <= leafSize) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    best.offer(squaredDistance(query, first[i].point), first[i].index);
+                }
+                return;
+            }
+            const std::size_t mid = n / 2;
+            const std::size_t axis = depth % kDimensions<Point>;
+            const Entry& split = first[mid];
+            const double gap = coordinate(query, axis) - coordinate(split.point, axis);
+            const Entry* left = first;
+            const Entry* right = first + mid + 1;
+            const std::size_t rightCount = n - mid - 1;
+            best.offer(squaredDistance(query, split.point), split.index);
+            if (gap < 0) {
+                searchNearest(left, mid, depth + 1, query, leafSize, best);
+                if (gap * gap <= best.bound()) {
+                    searchNearest(right, rightCount, depth + 1, query, leafSize, best);
+                }
+            } else {
+                searchNearest(right, rightCount, depth + 1, query, leafSize, best);
+                if (gap * gap <= best.bound()) {
+                    searchNearest(left, mid, depth + 1, query, leafSize, best);
+                }
+            }
+        }
+
+        template <typename Entry, typename Point>
+        void searchWithin(const Entry* first, std::size_t n, std::size_t depth, Point query, std::size_t leafSize,
+                          const search::RadiusTest& range, std::vector<search::Candidate>& found) {
+            if (n <= leafSize) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    const double d2 = squaredDistance(query, first[i].point);
+                    if (range.accepts(d2)) {
+                        found.push_back(search::Candidate{d2, first[i].index});
+                    }
+                }
+                return;
+            }
+            const std::size_t mid = n / 2;
+            const std::size_t axis = depth % kDimensions<Point>;
+            const Entry& split = first[mid];
+            const double gap = coordinate(query, axis) - coordinate(split.point, axis);
+            if (const double d2 = squaredDistance(query, split.point); range.accepts(d2)) {
+                found.push_back(search::Candidate{d2, split.index});
+            }
+            // The query's own side always has to be searched; the other one
+            // only if the splitting plane is in range.
+            if (gap < 0 || range.reaches(gap * gap)) {
+                searchWithin(first, mid, depth + 1, query, leafSize, range, found);
+            }
+            if (gap >= 0 || range.reaches(gap * gap)) {
+                searchWithin(first + mid + 1, n - mid - 1, depth + 1, query, leafSize, range, found);
+            }
+        }
+    } // namespace
+
+    template <typename Point>
+    KdTree<Point>::KdTree(std::span<const Point> points, unsigned threads) {
+        if (points.size() > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::length_error("KdTree: too many points");
+        }
+        entries.resize(points.size());
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            entries[i] = Entry{points[i], static_cast<std::uint32_t>(i)};
+        }
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        build(entries.data(), entries.size(), 0, threads, kLeafSize);
+    }
+
+    template <typename Point>
+    Nearest KdTree<Point>::nearest(Point query) const {
+        if (entries.empty()) {
+            throw std::invalid_argument("KdTree::nearest: empty tree");
+        }
+        return nearest(query, 1).front();
+    }
+
+    template <typename Point>
+    std::vector<Nearest> KdTree<Point>::nearest(Point query, std::size_t k) const {
+        if (k == 0 || entries.empty()) {
+            return {};
+        }
+        search::NeighborHeap best(std::min(k, entries.size()));
+        searchNearest(entries.data(), entries.size(), 0, query, kLeafSize, best);
+        return best.results();
+    }
+
+    template <typename Point>
+    std::vector<Nearest> KdTree<Point>::within(Point query, double radius) const {
+        std::vector<search::Candidate> found;
+        searchWithin(entries.data(), entries.size(), 0, query, kLeafSize, search::RadiusTest(radius), found);
+        return search::sortedResults(found);
+    }
+
+    template class KdTree<v1::Point>;
+    template class KdTree<v2::Point>;
+} // namespace Geometry
@@ -1,13 +1,33 @@
+#include "distance_matrix.h"
 #include "geometry.h"
+#include "hash_grid.h"
+#include "kd_tree.h"
+#include "point_cloud.h"
+#include <cstdint>
 #include <iostream>
+#include <vector>
 
 int main() {
-    // Modern code (uses v2 by default)
-    Geometry::Point p1{0, 0, 0}; // 3D point
-    Geometry::Point p2{3, 4, 5}; // 3D point
+    // Modern code (uses v3 by default)
+    Geometry::Point<double, 3> p1{0, 0, 0}; // 3D point
+    Geometry::Point<double, 3> p2{3, 4, 5}; // 3D point
     double d = Geometry::distance(p1, p2);
     std::cout << "3D distance: " << d << "\n";
 
+    // Any coordinate type and dimension, computed at compile time if asked
+    constexpr Geometry::Point<std::int32_t, 2> fixed1{0, 0}; // fixed point, say in mm
+    constexpr Geometry::Point<std::int32_t, 2> fixed2{3000, 4000};
+    static_assert(Geometry::squaredDistance(fixed1, fixed2) == 25'000'000);
+    static_assert(Geometry::distance(fixed1, fixed2) == 5000.0);
+    Geometry::Point<float, 3> small{3, 4, 5}; // half the size of a double point
+    Geometry::Point<double, 4> p4{1, 1, 1, 1};
+    std::cout << "float distance: " << Geometry::distance(Geometry::Point<float, 3>{}, small) << " (" << sizeof(small)
+              << " bytes), 4D: " << Geometry::distance(Geometry::Point<double, 4>{}, p4) << "\n";
+
+    // v2 is now just a name for the v3 point it used to define
+    Geometry::v2::Point same = p2;
+    std::cout << "v2 distance: " << Geometry::v2::distance(p1, same) << "\n";
+
     // Legacy code (explicitly use v1)
     Geometry::v1::Point old_p1{0, 0}; // 2D point
     Geometry::v1::Point old_p2{3, 4}; // 2D point
@@ -17,5 +37,84 @@ int main() {
     // This would NOT compile (type mismatch):
     // Geometry::distance(p1, old_p1);  // Error!
 
+    // Batch versions of distance(): many points per call, computed with the
+    // widest SIMD instructions the CPU has
+    std::cout << "\nBatch distances (" << Geometry::simdLevelName(Geometry::simdLevel()) << "):\n";
+    using Point3 = Geometry::Point<double, 3>; // = Geometry::v2::Point
+    std::vector<Point3> cloud{{3, 4, 5}, {1, 1, 1}, {-2, 0, 1}, {0, 6, 8}, {2, 2, 1}};
+    std::vector<double> out(cloud.size());
+    Geometry::distances(p1, cloud, out);
+    for (std::size_t i = 0; i < cloud.size(); ++i) {
+        std::cout << "  origin -> cloud[" << i << "]: " << out[i] << "\n";
+    }
+
+    std::vector<Point3> shifted(cloud);
+    for (Point3& p : shifted) {
+        p.x += 1;
+    }
+    Geometry::distances(cloud, shifted, out);
+    std::cout << "  cloud[i] -> shifted[i]: " << out[0] << " (all " << out.size() << ")\n";
+
+    Geometry::Nearest near = Geometry::nearest(Point3{2, 2, 2}, cloud);
+    std::cout << "  nearest to (2, 2, 2): cloud[" << near.index << "] at " << near.distance << "\n";
+
+    std::vector<Geometry::v1::Point> map{{3, 4}, {1, 1}, {6, 8}};
+    Geometry::Nearest oldNear = Geometry::v1::nearest(old_p1, map);
+    std::cout << "  2D nearest to origin: map[" << oldNear.index << "] at " << oldNear.distance << "\n";
+
+    // Structure-of-arrays storage: one aligned array per coordinate
+    Geometry::PointCloud<> columns(cloud);
+    std::cout << "\nPointCloud of " << columns.size() << " points, " << columns.paddedSize() << " slots per column\n";
+    std::cout << "  x:";
+    for (double x : columns.x()) {
+        std::cout << " " << x;
+    }
+    std::cout << "\n  z:";
+    for (double z : columns.z()) {
+        std::cout << " " << z;
+    }
+    Geometry::PointCloudView<> middle = columns.view().subview(1, 3); // no copy
+    std::cout << "\n  view of points 1..3 starts at (" << middle[0].x << ", " << middle[0].y << ", " << middle[0].z
+              << ")\n";
+    std::vector<Point3> packed = columns.toPoints();
+    std::cout << "  back to " << packed.size() << " packed points, last is (" << packed.back().x << ", "
+              << packed.back().y << ", " << packed.back().z << ")\n";
+
+    Geometry::PointCloud<Geometry::v1::Point> flat(map); // x and y columns only
+    std::cout << "  2D cloud: " << flat.kDimensions << " columns, " << flat.size() << " points\n";
+
+    // Spatial indexes: answer nearest-neighbour and radius queries without
+    // measuring the distance to every point
+    Geometry::KdTree<> tree(cloud);
+    std::cout << "\nKdTree of " << tree.size() << " points, 2 nearest to (2, 2, 2):";
+    for (const Geometry::Nearest& n : tree.nearest(Point3{2, 2, 2}, 2)) {
+        std::cout << " cloud[" << n.index << "] at " << n.distance << ";";
+    }
+    std::cout << "\n  within 3 of the origin:";
+    for (const Geometry::Nearest& n : tree.within(p1, 3)) {
+        std::cout << " cloud[" << n.index << "]";
+    }
+
+    Geometry::HashGrid<> grid(2.0, cloud); // 2x2x2 cells, ids 0..4
+    std::size_t added = grid.insert(Point3{2, 2, 2});
+    grid.remove(0);
+    Geometry::Nearest closest = grid.nearest(Point3{2, 2, 2});
+    std::cout << "\nHashGrid of " << grid.size() << " points in " << grid.cellCount() << " cells: nearest to (2, 2, 2) is id "
+              << closest.index << (closest.index == added ? " (just inserted)" : "") << " at " << closest.distance
+              << "\n";
+
+    // All pairwise distances at once, tiled across every core
+    std::vector<double> matrix(cloud.size() * cloud.size());
+    Geometry::distanceMatrix(cloud, matrix);
+    std::cout << "\nDistance matrix, " << cloud.size() << "x" << cloud.size() << ", row 0:";
+    for (std::size_t j = 0; j < cloud.size(); ++j) {
+        std::cout << " " << matrix[j];
+    }
+    Geometry::MatrixOptions squared;
+    squared.metric = Geometry::MatrixOptions::Metric::SquaredDistance;
+    std::vector<double> mapSquared(map.size() * map.size());
+    Geometry::v1::distanceMatrix(map, map, mapSquared, squared); // rows x columns form
+    std::cout << "\n  2D squared, map[0] -> map[2]: " << mapSquared[2] << "\n";
+
     return 0;
 }
\ No newline at end of file
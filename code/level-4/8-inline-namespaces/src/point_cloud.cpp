@@ -0,0 +1,350 @@
+#include "point_cloud.h"
+#include "geometry_simd.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+namespace Geometry {
+    namespace {
+        using namespace simd;
+
+        // ------------------------------------------------------------------
+        // Conversion kernels. z is unused (and may be null) for 2D points.
+        // ------------------------------------------------------------------
+        template <typename Point>
+        void toColumnsScalar(const Point* points, std::size_t begin, std::size_t n, double* x, double* y, double* z) {
+            for (std::size_t i = begin; i < n; ++i) {
+                x[i] = points[i].x;
+                y[i] = points[i].y;
+                if constexpr (kDimensions<Point> == 3) {
+                    z[i] = points[i].z;
+                }
+            }
+        }
+
+        template <typename Point>
+        void fromColumnsScalar(const double* x, const double* y, const double* z, Point* points, std::size_t begin, std::size_t n) {
+            for (std::size_t i = begin; i < n; ++i) {
+                if constexpr (kDimensions<Point> == 3) {
+                    points[i] = Point{x[i], y[i], z[i]};
+                } else {
+                    points[i] = Point{x[i], y[i]};
+                }
+            }
+        }
+
+#if defined(GEOMETRY_X86)
+        // How many leading elements to convert one by one so that stores
+        // to `to` start on a `bytes` boundary. std::vector<Point> is only
+        // 16-byte aligned, and there every 32- or 64-byte store would split
+        // a cache line: that alone made the AVX-512 v2 path twice as slow
+        // as the scalar loop.
+        template <typename T>
+        std::size_t peelToAlignment(const T* to, std::size_t bytes, std::size_t n) {
+            std::size_t i = 0;
+            while (i < n && i < bytes / sizeof(double) && reinterpret_cast<std::uintptr_t>(to + i) % bytes != 0) {
+                ++i;
+            }
+            return i;
+        }
+
+        template <typename Point>
+        GEOMETRY_TARGET("sse2") void toColumnsSse2(const Point* points, std::size_t n, double* x, double* y, double* z) {
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                Sse2Lanes v = loadSse2(points + i);
+                _mm_storeu_pd(x + i, v.x);
+                _mm_storeu_pd(y + i, v.y);
+                if constexpr (kDimensions<Point> == 3) {
+                    _mm_storeu_pd(z + i, v.z);
+                }
+            }
+            toColumnsScalar(points, i, n, x, y, z);
+        }
+
+        template <typename Point>
+        GEOMETRY_TARGET("sse2") void fromColumnsSse2(const double* x, const double* y, const double* z, Point* points, std::size_t n) {
+            std::size_t i = 0;
+            for (; i + 2 <= n; i += 2) {
+                Sse2Lanes v{_mm_loadu_pd(x + i), _mm_loadu_pd(y + i), _mm_setzero_pd()};
+                if constexpr (kDimensions<Point> == 3) {
+                    v.z = _mm_loadu_pd(z + i);
+                }
+                storeSse2(points + i, v);
+            }
+            fromColumnsScalar(x, y, z, points, i, n);
+        }
+
+        template <typename Point>
+        GEOMETRY_TARGET("avx2") void toColumnsAvx2(const Point* points, std::size_t n, double* x, double* y, double* z) {
+            std::size_t i = peelToAlignment(x, 32, n);
+            toColumnsScalar(points, 0, i, x, y, z);
+            for (; i + 4 <= n; i += 4) {
+                Avx2Lanes v = loadAvx2(points + i);
+                _mm256_storeu_pd(x + i, v.x);
+                _mm256_storeu_pd(y + i, v.y);
+                if constexpr (kDimensions<Point> == 3) {
+                    _mm256_storeu_pd(z + i, v.z);
+                }
+            }
+            toColumnsScalar(points, i, n, x, y, z);
+        }
+
+        template <typename Point>
+        GEOMETRY_TARGET("avx2") void fromColumnsAvx2(const double* x, const double* y, const double* z, Point* points, std::size_t n) {
+            std::size_t i = peelToAlignment(points, 32, n);
+            fromColumnsScalar(x, y, z, points, 0, i);
+            for (; i + 4 <= n; i += 4) {
+                Avx2Lanes v{_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), _mm256_setzero_pd()};
+                if constexpr (kDimensions<Point> == 3) {
+                    v.z = _mm256_loadu_pd(z + i);
+                }
+                storeAvx2(points + i, v);
+            }
+            fromColumnsScalar(x, y, z, points, i, n);
+        }
+
+        template <typename Point>
+        GEOMETRY_TARGET("avx512f") void toColumnsAvx512(const Point* points, std::size_t n, double* x, double* y, double* z) {
+            std::size_t i = peelToAlignment(x, 64, n);
+            toColumnsScalar(points, 0, i, x, y, z);
+            for (; i + 8 <= n; i += 8) {
+                Avx512Lanes v = loadAvx512(points + i);
+                _mm512_storeu_pd(x + i, v.x);
+                _mm512_storeu_pd(y + i, v.y);
+                if constexpr (kDimensions<Point> == 3) {
+                    _mm512_storeu_pd(z + i, v.z);
+                }
+            }
+            toColumnsScalar(points, i, n, x, y, z);
+        }
+
+        template <typename Point>
+        GEOMETRY_TARGET("avx512f") void fromColumnsAvx512(const double* x, const double* y, const double* z, Point* points, std::size_t n) {
+            std::size_t i = peelToAlignment(points, 64, n);
+            fromColumnsScalar(x, y, z, points, 0, i);
+            for (; i + 8 <= n; i += 8) {
+                Avx512Lanes v{_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), _mm512_setzero_pd()};
+                if constexpr (kDimensions<Point> == 3) {
+                    v.z = _mm512_loadu_pd(z + i);
+                }
+                storeAvx512(points + i, v);
+            }
+            fromColumnsScalar(x, y, z, points, i, n);
+        }
+#endif // GEOMETRY_X86
+
+        template <typename Point>
+        void splitColumns(std::span<const Point> points, double* x, double* y, double* z) {
+            switch (simdLevel()) {
+#if defined(GEOMETRY_X86)
+            case SimdLevel::AVX512:
+                return toColumnsAvx512(points.data(), points.size(), x, y, z);
+            case SimdLevel::AVX2:
+                return toColumnsAvx2(points.data(), points.size(), x, y, z);
+            case SimdLevel::SSE2:
+                return toColumnsSse2(points.data(), points.size(), x, y, z);
+#endif
+            default:
+                return toColumnsScalar(points.data(), 0, points.size(), x, y, z);
+            }
+        }
+
+        template <typename Point>
+        void joinColumns(const double* x, const double* y, const double* z, std::span<Point> points) {
+            switch (simdLevel()) {
+#if defined(GEOMETRY_X86)
+            case SimdLevel::AVX512:
+                return fromColumnsAvx512(x, y, z, points.data(), points.size());
+            case SimdLevel::AVX2:
+                return fromColumnsAvx2(x, y, z, points.data(), points.size());
+            case SimdLevel::SSE2:
+                return fromColumnsSse2(x, y, z, points.data(), points.size());
+#endif
+            default:
+                return fromColumnsScalar(x, y, z, points.data(), 0, points.size());
+            }
+        }
+    } // namespace
+
+    void toColumns(std::span<const v1::Point> points, double* x, double* y) {
+        splitColumns(points, x, y, nullptr);
+    }
+
+    void toColumns(std::span<const v2::Point> points, double* x, double* y, double* z) {
+        splitColumns(points, x, y, z);
+    }
+
+    void fromColumns(const double* x, const double* y, std::span<v1::Point> points) {
+        joinColumns(x, y, nullptr, points);
+    }
+
+    void fromColumns(const double* x, const double* y, const double* z, std::span<v2::Point> points) {
+        joinColumns(x, y, z, points);
+    }
+
+    // ----------------------------------------------------------------------
+    // PointCloud
+    // ----------------------------------------------------------------------
+    template <typename Point>
+    PointCloud<Point>::PointCloud(std::span<const Point> points) {
+        append(points);
+    }
+
+    template <typename Point>
+    PointCloud<Point>::PointCloud(PointCloudView<Point> points) {
+        reserve(points.size());
+        for (std::size_t axis = 0; axis < kDimensions; ++axis) {
+            std::copy(points.column(axis).begin(), points.column(axis).end(), column(axis));
+        }
+        count = points.size();
+        zeroPadding();
+    }
+
+    template <typename Point>
+    PointCloud<Point>::PointCloud(const PointCloud& other)
+        : PointCloud(other.view()) {}
+
+    template <typename Point>
+    PointCloud<Point>& PointCloud<Point>::operator=(const PointCloud& other) {
+        if (this != &other) {
+            PointCloud copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    template <typename Point>
+    PointCloud<Point>::PointCloud(PointCloud&& other) noexcept
+        : storage(std::move(other.storage))
+        , count(std::exchange(other.count, 0))
+        , allocated(std::exchange(other.allocated, 0)) {}
+
+    template <typename Point>
+    PointCloud<Point>& PointCloud<Point>::operator=(PointCloud&& other) noexcept {
+        storage = std::move(other.storage);
+        count = std::exchange(other.count, 0);
+        allocated = std::exchange(other.allocated, 0);
+        return *this;
+    }
+
+    template <typename Point>
+    void PointCloud<Point>::regrow(std::size_t capacity) {
+        capacity = (capacity + kLanes - 1) / kLanes * kLanes;
+        std::unique_ptr<double[], AlignedDelete> grown(
+            static_cast<double*>(::operator new[](kDimensions * capacity * sizeof(double), std::align_val_t(kAlignment))));
+        for (std::size_t axis = 0; axis < kDimensions; ++axis) {
+            std::copy_n(column(axis), count, grown.get() + axis * capacity);
+        }
+        storage = std::move(grown);
+        allocated = capacity;
+        zeroPadding();
+    }
+
+    // Only [size(), paddedSize()) is kept at zero; slots past that may hold
+    // stale coordinates until the cloud grows over them.
+    template <typename Point>
+    void PointCloud<Point>::zeroPadding() {
+        for (std::size_t axis = 0; axis < kDimensions; ++axis) {
+            std::fill(column(axis) + count, column(axis) + paddedSize(), 0.0);
+        }
+    }
+
+    template <typename Point>
+    void PointCloud<Point>::reserve(std::size_t capacity) {
+        if (capacity > allocated) {
+            regrow(capacity);
+        }
+    }
+
+    template <typename Point>
+    void PointCloud<Point>::resize(std::size_t n) {
+        if (n > allocated) {
+            regrow(std::max(n, 2 * allocated));
+        }
+        for (std::size_t axis = 0; axis < kDimensions && n > count; ++axis) {
+            std::fill(column(axis) + count, column(axis) + n, 0.0);
+        }
+        count = n;
+        zeroPadding();
+    }
+
+    template <typename Point>
+    void PointCloud<Point>::clear() {
+        resize(0);
+    }
+
+    template <typename Point>
+    void PointCloud<Point>::push_back(Point p) {
+        if (count == allocated) {
+            regrow(std::max(kLanes, 2 * allocated));
+        }
+        set(count++, p);
+        if (count % kLanes == 1) { // started a new block of lanes
+            zeroPadding();
+        }
+    }
+
+    template <typename Point>
+    void PointCloud<Point>::append(std::span<const Point> points) {
+        if (count + points.size() > allocated) {
+            regrow(std::max(count + points.size(), 2 * allocated));
+        }
+        if constexpr (kDimensions == 3) {
+            toColumns(points, column(0) + count, column(1) + count, column(2) + count);
+        } else {
+            toColumns(points, column(0) + count, column(1) + count);
+        }
+        count += points.size();
+        zeroPadding();
+    }
+
+    template <typename Point>
+    Point PointCloud<Point>::operator[](std::size_t i) const {
+        const double* base = storage.get();
+        if constexpr (kDimensions == 3) {
+            return Point{base[i], base[allocated + i], base[2 * allocated + i]};
+        } else {
+            return Point{base[i], base[allocated + i]};
+        }
+    }
+
+    template <typename Point>
+    void PointCloud<Point>::set(std::size_t i, Point p) {
+        double* base = storage.get();
+        base[i] = p.x;
+        base[allocated + i] = p.y;
+        if constexpr (kDimensions == 3) {
+            base[2 * allocated + i] = p.z;
+        }
+    }
+
+    template <typename Point>
+    double* PointCloud<Point>::column(std::size_t axis) {
+        if (axis >= kDimensions) {
+            throw std::out_of_range("PointCloud::column: no such axis");
+        }
+        return storage.get() + axis * allocated;
+    }
+
+    template <typename Point>
+    const double* PointCloud<Point>::column(std::size_t axis) const {
+        if (axis >= kDimensions) {
+            throw std::out_of_range("PointCloud::column: no such axis");
+        }
+        return storage.get() + axis * allocated;
+    }
+
+    template <typename Point>
+    PointCloudView<Point> PointCloud<Point>::view() const {
+        std::array<const double*, kDimensions> starts{};
+        for (std::size_t axis = 0; axis < kDimensions; ++axis) {
+            starts[axis] = column(axis);
+        }
+        return PointCloudView<Point>(starts, count);
+    }
+
+    template class PointCloud<v1::Point>;
+    template class PointCloud<v2::Point>;
+} // namespace Geometry